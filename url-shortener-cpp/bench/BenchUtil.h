@@ -0,0 +1,154 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+
+// Shared helpers for the standalone benchmarks in bench/
+
+namespace bench {
+
+// Print a section header (same look as main.cpp)
+inline void section(const std::string& title) {
+    std::cout << "\n";
+    std::cout << "══════════════════════════════════════════════\n";
+    std::cout << "  " << title << "\n";
+    std::cout << "══════════════════════════════════════════════\n";
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Zipf(s) sampler over [0, n) using a precomputed CDF + binary search
+class Zipf {
+private:
+    std::vector<double> cdf;
+
+public:
+    Zipf(size_t n, double s) : cdf(n) {
+        double sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow((double)(i + 1), s);
+            cdf[i] = sum;
+        }
+        for (auto& c : cdf) c /= sum;
+    }
+
+    template <class Rng>
+    size_t operator()(Rng& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    }
+};
+
+// Run fn(threadIndex) on `threads` threads, all released at once.
+// Returns wall-clock seconds from release to the last thread finishing.
+inline double runThreads(int threads, const std::function<void(int)>& fn) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            fn(t);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : pool) th.join();
+    return secondsSince(start);
+}
+
+// Thread counts 1, 2, 4, ... up to (and including) maxThreads,
+// which defaults to the core count
+inline std::vector<int> threadCounts(int maxThreads = 0) {
+    int hw = maxThreads > 0 ? maxThreads
+                            : (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> counts;
+    for (int t = 1; t < hw; t <<= 1) counts.push_back(t);
+    counts.push_back(hw);
+    return counts;
+}
+
+// Optional "--threads N" style override: first positional argument
+inline int maxThreadsArg(int argc, char** argv) {
+    return argc > 1 ? std::atoi(argv[1]) : 0;
+}
+
+// Latency histogram: 16 linear sub-buckets per power of two (<= 6.25%
+// error), so recording is a few instructions and merging is addition
+class Histogram {
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB = 1 << SUB_BITS;
+    std::vector<uint64_t> counts = std::vector<uint64_t>(64 * SUB, 0);
+    uint64_t total = 0;
+    uint64_t maxValue = 0;
+
+    static size_t indexOf(uint64_t v) {
+        if (v < SUB) return (size_t)v;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        return (size_t)(shift + 1) * SUB + (size_t)((v >> shift) - SUB);
+    }
+
+public:
+    // Largest value that falls in bucket i
+    static uint64_t upperBound(size_t i) {
+        if (i < SUB) return i;
+        int shift = (int)(i / SUB) - 1;
+        return ((SUB + i % SUB + 1) << shift) - 1;
+    }
+
+    void record(uint64_t v) {
+        counts[indexOf(v)]++;
+        total++;
+        maxValue = std::max(maxValue, v);
+    }
+
+    void merge(const Histogram& other) {
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+        total += other.total;
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+
+    // Value at quantile q in [0, 1] (bucket upper bound, capped at the max)
+    uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = (uint64_t)std::ceil(q * (double)total);
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(upperBound(i), maxValue);
+        }
+        return maxValue;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+    const std::vector<uint64_t>& buckets() const { return counts; }
+};
+
+// Keep the optimizer from discarding a computed value
+template <class T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace bench
+
+#endif
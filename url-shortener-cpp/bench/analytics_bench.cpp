@@ -0,0 +1,195 @@
+// Analytics benchmarks: hit recording cost and its share of a redirect
+//   g++ -std=c++17 -O2 -pthread bench/analytics_bench.cpp core/*.cpp -o analytics_bench
+//   ./analytics_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include <cstring>
+#include <iomanip>
+
+// The original tracker: every hit takes one global mutex
+class LegacyTracker {
+    std::unordered_map<std::string, long long> hitCounts;
+    std::mutex mtx;
+
+public:
+    void recordHit(const std::string& shortCode) {
+        std::lock_guard<std::mutex> lock(mtx);
+        hitCounts[shortCode]++;
+    }
+};
+
+// Per-thread Zipf(0.99) streams of short codes
+static std::vector<std::vector<std::string>> zipfStreams(const std::vector<std::string>& codes,
+                                                         int threads, size_t perThread) {
+    bench::Zipf zipf(codes.size(), 0.99);
+    std::vector<std::vector<std::string>> streams(threads);
+    for (int t = 0; t < threads; t++) {
+        std::mt19937_64 rng(t + 1);
+        streams[t].reserve(perThread);
+        for (size_t i = 0; i < perThread; i++) streams[t].push_back(codes[zipf(rng)]);
+    }
+    return streams;
+}
+
+// Top-K over many distinct codes: old full-map sort vs. summaries, and how
+// well HeavyHitters mode recovers the exact top 10
+static void topKSection(int threads) {
+    const size_t distinct = 2000000;
+    const size_t perThread = 2000000;
+    std::vector<std::string> codes;
+    codes.reserve(distinct);
+    for (size_t i = 0; i < distinct; i++) codes.push_back("c" + std::to_string(i));
+    auto streams = zipfStreams(codes, threads, perThread);
+
+    AnalyticsTracker exact(AnalyticsMode::Exact);
+    AnalyticsTracker approx(AnalyticsMode::HeavyHitters);
+    double exactSecs = bench::runThreads(threads, [&](int t) {
+        for (const std::string& code : streams[t]) exact.recordHit(code);
+    });
+    double approxSecs = bench::runThreads(threads, [&](int t) {
+        for (const std::string& code : streams[t]) approx.recordHit(code);
+    });
+
+    // What printReport used to do: copy the whole map and sort it
+    std::unordered_map<std::string, long long> all;
+    for (int t = 0; t < threads; t++) {
+        for (const std::string& code : streams[t]) all[code]++;
+    }
+    auto sortStart = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, long long>> sorted(all.begin(), all.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    double sortMs = bench::secondsSince(sortStart) * 1e3;
+
+    exact.topK(10);   // first call merges the pending shards
+    auto exactStart = std::chrono::steady_clock::now();
+    std::vector<HitCount> exactTop = exact.topK(10);
+    double exactMs = bench::secondsSince(exactStart) * 1e3;
+    auto approxStart = std::chrono::steady_clock::now();
+    std::vector<HitCount> approxTop = approx.topK(10);
+    double approxMs = bench::secondsSince(approxStart) * 1e3;
+
+    size_t recall = 0;
+    for (const HitCount& a : approxTop) {
+        for (size_t i = 0; i < 10 && i < sorted.size(); i++) recall += a.shortCode == sorted[i].first;
+    }
+    long long worstError = 0;
+    for (const HitCount& a : approxTop) worstError = std::max(worstError, a.hits - all[a.shortCode]);
+
+    double hits = threads * (double)perThread / 1e6;
+    std::cout << "  " << threads * perThread / 1000000 << "M hits over " << all.size() << " distinct codes\n"
+              << std::fixed << std::setprecision(2)
+              << "  recordHit M/s          exact " << hits / exactSecs << "   heavy-hitters " << hits / approxSecs << "\n"
+              << "  top 10                 full sort " << sortMs << " ms   exact topK " << exactMs
+              << " ms   heavy-hitters topK " << approxMs << " ms\n"
+              << "  heavy-hitters top 10   " << recall << "/10 match exact, worst overcount " << worstError
+              << " (bound " << (approxTop.empty() ? 0 : approxTop.back().error) << ")\n";
+}
+
+// Columnar export of every code's last hour, and a check that the exported
+// minute buckets add up to the hits recorded
+static bool exportSection(const std::vector<std::vector<std::string>>& streams, int threads) {
+    AnalyticsTracker tracker;
+    bench::runThreads(threads, [&](int t) {
+        for (const std::string& code : streams[t]) tracker.recordHit(code);
+    });
+
+    tracker.exportSeries({}, SeriesResolution::Minute, 1);   // merge first
+    auto start = std::chrono::steady_clock::now();
+    std::string blob = tracker.exportSeries({}, SeriesResolution::Minute, 60);
+    double ms = bench::secondsSince(start) * 1e3;
+
+    uint32_t codes, buckets;
+    std::memcpy(&buckets, blob.data() + 12, 4);
+    std::memcpy(&codes, blob.data() + 24, 4);
+    const char* counts = blob.data() + blob.size() - (size_t)codes * buckets * 4;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < (size_t)codes * buckets; i++) {
+        uint32_t c;
+        std::memcpy(&c, counts + i * 4, 4);
+        sum += c;
+    }
+    uint64_t expected = 0;
+    for (int t = 0; t < threads; t++) expected += streams[t].size();
+
+    std::cout << "  " << codes << " codes x " << buckets << " minutes: " << blob.size() / 1024 << " KiB in "
+              << std::fixed << std::setprecision(2) << ms << " ms\n";
+    bool ok = sum == expected;
+    std::cout << (ok ? "  ✅ minute buckets sum to the recorded hits\n"
+                     : "  ❌ minute buckets sum to " + std::to_string(sum) + ", expected " +
+                           std::to_string(expected) + "\n");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+    std::vector<int> threadCounts = bench::threadCounts(maxThreads);
+    const size_t perThread = 1000000;
+    const size_t links = 100000;
+
+    ServiceConfig config;
+    config.cacheCapacity = (int)links;
+    config.reaperIntervalMs = 0;
+    UrlShortenerService withAnalytics(config);
+    config.analytics = false;
+    UrlShortenerService withoutAnalytics(config);
+
+    std::vector<std::string> codes;
+    for (size_t i = 0; i < links; i++) {
+        std::string url = "https://example.com/article/" + std::to_string(i);
+        codes.push_back(withAnalytics.shortenUrl(url));
+        withoutAnalytics.shortenUrl(url);
+    }
+    auto streams = zipfStreams(codes, threadCounts.back(), perThread);
+
+    bench::section("recordHit — M hits/s, Zipfian codes");
+    std::cout << "  threads   global mutex   per-thread shards\n";
+    for (int threads : threadCounts) {
+        LegacyTracker legacy;
+        AnalyticsTracker tracker;
+        double a = bench::runThreads(threads, [&](int t) {
+            for (const std::string& code : streams[t]) legacy.recordHit(code);
+        });
+        double b = bench::runThreads(threads, [&](int t) {
+            for (const std::string& code : streams[t]) tracker.recordHit(code);
+        });
+        double total = threads * (double)perThread / 1e6;
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(12) << total / a << "   " << std::setw(17) << total / b << "\n";
+    }
+
+    bench::section("redirect — M/s with analytics on vs. off (cache hits)");
+    std::cout << "  threads   analytics on   analytics off\n";
+    for (int threads : threadCounts) {
+        auto redirects = [&](UrlShortenerService& service) {
+            double secs = bench::runThreads(threads, [&](int t) {
+                size_t found = 0;
+                for (const std::string& code : streams[t]) found += !service.redirect(code).empty();
+                bench::doNotOptimize(found);
+            });
+            return threads * (double)perThread / secs / 1e6;
+        };
+        double on = redirects(withAnalytics);
+        double off = redirects(withoutAnalytics);
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(12) << on << "   " << std::setw(13) << off << "\n";
+    }
+
+    bench::section("Top-K — Zipfian hits over a 2M-code space");
+    topKSection(threadCounts.back());
+
+    bench::section("Click series — columnar export");
+    bool exportOk = exportSection(streams, threadCounts.back());
+
+    bench::section("Merged counts");
+    int threads = threadCounts.back();
+    AnalyticsTracker tracker;
+    bench::runThreads(threads, [&](int t) {
+        for (const std::string& code : streams[t]) tracker.recordHit(code);
+    });
+    long long total = 0;
+    for (const std::string& code : codes) total += tracker.getHitCount(code);
+    bool ok = total == (long long)(threads * perThread);
+    std::cout << "  recorded " << threads * perThread << " hits on " << threads << " thread(s), merged total "
+              << total << "\n" << (ok ? "  ✅ no hits lost\n" : "  ❌ merged total mismatch\n");
+    return ok && exportOk ? 0 : 1;
+}
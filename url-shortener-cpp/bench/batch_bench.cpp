@@ -0,0 +1,148 @@
+// Batched redirects: lookups/s for batch sizes 1-64 over a store larger
+// than the last-level cache, one code at a time vs findMany / redirectMany
+//   g++ -std=c++17 -O2 -pthread bench/batch_bench.cpp core/*.cpp -o batch_bench
+//   ./batch_bench [links]    (default 4M; pick enough to outgrow the LLC)
+//
+// Codes are drawn uniformly, so nearly every lookup misses the CPU caches
+// (and the service's small redirect cache): the time is memory latency,
+// which a batch overlaps by prefetching each stage a pass ahead.
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include "../core/Base62Encoder.h"
+#include <iomanip>
+
+namespace {
+
+std::string makeUrl(size_t i) {
+    return "https://www.example.com/articles/" + std::to_string(i * 7919 % 1000003)
+         + "?utm_source=newsletter&campaign=spring&id=" + std::to_string(i);
+}
+
+const size_t BATCH_SIZES[] = {1, 2, 4, 8, 16, 32, 64};
+
+// Lookups/s of lookupBatch over `probes`, `batch` codes per call
+template <class Fn>
+double lookupsPerSecond(const std::vector<std::string_view>& probes, size_t batch, Fn lookupBatch) {
+    std::vector<std::string_view> codes;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < probes.size(); i += batch) {
+        codes.assign(probes.begin() + i, probes.begin() + std::min(probes.size(), i + batch));
+        found += lookupBatch(codes);
+    }
+    double seconds = bench::secondsSince(start);
+    bench::doNotOptimize(found);
+    return probes.size() / seconds;
+}
+
+void printRow(const std::string& label, double rate, double baseline) {
+    std::cout << "  " << std::left << std::setw(16) << label << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << rate / 1e6
+              << std::setw(10) << std::setprecision(2) << rate / baseline << "x\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t links = argc > 1 ? std::stoull(argv[1]) : 4000000;
+    const size_t probeCount = 1000000;
+
+    // The same links in a bare repository and behind the service
+    std::vector<std::string> codes(links);
+    for (size_t i = 0; i < links; i++) codes[i] = Base62Encoder::encode(1000000 + i * 7);
+    UrlRepository repo;
+    {
+        std::vector<std::string> urls;
+        std::vector<RepositoryWrite> writes;
+        for (size_t start = 0; start < links; start += 10000) {
+            size_t n = std::min<size_t>(10000, links - start);
+            urls.resize(n);
+            writes.resize(n);
+            for (size_t k = 0; k < n; k++) {
+                urls[k] = makeUrl(start + k);
+                writes[k] = RepositoryWrite();
+                writes[k].shortCode = codes[start + k];
+                writes[k].longUrl = urls[k];
+            }
+            repo.saveBatch(writes);
+        }
+    }
+    ServiceConfig config;
+    config.cacheCapacity = 10000;
+    config.reaperIntervalMs = 0;
+    config.analytics = false;           // measure lookups, not click counters
+    UrlShortenerService service(config);
+    {
+        std::vector<ShortenRequest> batch(1000);
+        for (size_t start = 0; start < links; start += batch.size()) {
+            size_t n = std::min(batch.size(), links - start);
+            batch.resize(n);
+            for (size_t k = 0; k < n; k++) {
+                batch[k].longUrl = makeUrl(start + k);
+                batch[k].customAlias = codes[start + k];
+            }
+            service.shortenBatch(batch);
+        }
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<std::string_view> probes(probeCount);
+    for (std::string_view& p : probes) p = codes[rng() % links];
+
+    std::vector<UrlHandle> out;
+    std::vector<int64_t> expiresAt;
+    auto oneAtATime = [&](const std::vector<std::string_view>& batch) {
+        size_t found = 0;
+        int64_t expiry = 0;
+        for (std::string_view code : batch) found += !repo.findHandle(code, expiry).empty();
+        return found;
+    };
+    auto findMany = [&](const std::vector<std::string_view>& batch) {
+        repo.findMany(batch, out, expiresAt);
+        return out.size();
+    };
+    auto resolveEach = [&](const std::vector<std::string_view>& batch) {
+        size_t found = 0;
+        for (std::string_view code : batch) found += !service.resolve(code).empty();
+        return found;
+    };
+    auto redirectMany = [&](const std::vector<std::string_view>& batch) {
+        return service.redirectMany(batch).size();
+    };
+
+    bench::section("UrlRepository, " + std::to_string(links) + " links (M lookups/s)");
+    std::cout << "  batch              M/s   vs single\n";
+    double single = lookupsPerSecond(probes, 1, oneAtATime);
+    printRow("findHandle", single, single);
+    for (size_t b : BATCH_SIZES) printRow("findMany x" + std::to_string(b), lookupsPerSecond(probes, b, findMany), single);
+
+    bench::section("UrlShortenerService, 10K-entry cache (M redirects/s)");
+    std::cout << "  batch              M/s   vs single\n";
+    single = lookupsPerSecond(probes, 1, resolveEach);
+    printRow("resolve", single, single);
+    for (size_t b : BATCH_SIZES) printRow("redirectMany x" + std::to_string(b), lookupsPerSecond(probes, b, redirectMany), single);
+
+    // Batches mixing stored, unknown and malformed codes resolve exactly as
+    // one-at-a-time lookups do, and to the stored URL
+    bench::section("Correctness");
+    std::vector<std::string> extra = {"zzzzzzzzz", "bad!code", "", "0"};
+    bool ok = true;
+    for (int round = 0; round < 200 && ok; round++) {
+        std::vector<std::string_view> batch;
+        size_t n = 1 + rng() % 64;
+        for (size_t k = 0; k < n; k++) {
+            batch.push_back(rng() % 8 == 0 ? std::string_view(extra[rng() % extra.size()]) : probes[rng() % probes.size()]);
+        }
+        repo.findMany(batch, out, expiresAt);
+        std::vector<UrlHandle> redirected = service.redirectMany(batch);
+        for (size_t k = 0; k < n && ok; k++) {
+            int64_t expiry = 0;
+            ok = out[k].view() == repo.findHandle(batch[k], expiry).view()
+              && redirected[k].view() == service.resolve(batch[k]).view()
+              && redirected[k].view() == out[k].view();   // both hold the same links
+        }
+    }
+    std::cout << (ok ? "  ✅ findMany and redirectMany match one-at-a-time lookups\n"
+                     : "  ❌ a batched lookup disagreed with a single one\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Cache benchmarks
+//   g++ -std=c++17 -O2 -pthread bench/cache_bench.cpp core/*.cpp -o cache_bench
+//   ./cache_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/LRUCache.h"
+#include <iomanip>
+
+static const char* policyName(CachePolicy p) {
+    return p == CachePolicy::CLOCK ? "CLOCK" : p == CachePolicy::TINYLFU ? "TINYLFU" : "LRU";
+}
+
+// Hit throughput of a warm cache as the thread count grows
+static void hitScaling(int shards, CachePolicy policy, int maxThreads) {
+    const int keys = 10000;
+    LRUCache cache(keys, shards, policy);
+
+    std::vector<std::string> codes;
+    for (int i = 0; i < keys; i++) {
+        codes.push_back("c" + std::to_string(i));
+        cache.put(codes.back(), "https://example.com/" + std::to_string(i));
+    }
+
+    std::cout << "  policy=" << policyName(policy) << " shards=" << cache.shardCount() << "\n";
+    for (int threads : bench::threadCounts(maxThreads)) {
+        const int opsPerThread = 400000;
+        double secs = bench::runThreads(threads, [&](int t) {
+            std::mt19937 rng(t + 1);
+            std::string value;
+            for (int i = 0; i < opsPerThread; i++) {
+                cache.get(codes[rng() % keys], value);
+            }
+            bench::doNotOptimize(value);
+        });
+        double mops = threads * (double)opsPerThread / secs / 1e6;
+        std::cout << "    threads=" << std::setw(3) << threads
+                  << "  " << std::fixed << std::setprecision(2) << mops << " M hits/s\n";
+    }
+}
+
+// Replay a Zipfian redirect trace (miss -> put, like redirect()) and
+// return the hit ratio
+static double zipfHitRatio(CachePolicy policy, int capacity, size_t keys,
+                           double skew, int requests) {
+    LRUCache cache(capacity, 0, policy);
+    bench::Zipf zipf(keys, skew);
+    std::mt19937_64 rng(42);
+    std::string value;
+    int hits = 0;
+    for (int i = 0; i < requests; i++) {
+        std::string code = std::to_string(zipf(rng));
+        if (cache.get(code, value)) hits++;
+        else cache.put(code, code);
+    }
+    return (double)hits / requests;
+}
+
+static void hitRatioComparison() {
+    const size_t keys = 100000;
+    const int requests = 1000000;
+    std::cout << "  keys=" << keys << " requests=" << requests << "\n";
+    std::cout << "  skew   cache%   LRU      CLOCK    TINYLFU\n";
+    for (double skew : {0.8, 0.99, 1.2}) {
+        for (double pct : {0.01, 0.05, 0.10}) {
+            int capacity = (int)(keys * pct);
+            double lru = zipfHitRatio(CachePolicy::LRU, capacity, keys, skew, requests);
+            double clk = zipfHitRatio(CachePolicy::CLOCK, capacity, keys, skew, requests);
+            double lfu = zipfHitRatio(CachePolicy::TINYLFU, capacity, keys, skew, requests);
+            std::cout << "  " << std::fixed << std::setprecision(2) << skew
+                      << "   " << std::setw(4) << (int)(pct * 100) << "%   "
+                      << std::setprecision(4) << lru << "   " << clk << "   " << lfu << "\n";
+        }
+    }
+}
+
+// Zipfian traffic, then the same traffic interleaved 1:1 with a crawler
+// requesting `scanKeys` distinct never-repeated codes, then Zipfian traffic
+// alone again. Prints the hit ratio of the Zipfian requests in each phase
+// (scan requests always miss) and the hit ratio right after the scan.
+static void scanResistance() {
+    const size_t keys = 100000;
+    const int capacity = 5000;
+    const int phaseRequests = 1000000;
+    const int scanKeys = 1000000;
+    std::cout << "  keys=" << keys << " skew=0.99 cache=" << capacity
+              << " scan=" << scanKeys << " one-off codes\n";
+    std::cout << "  policy     before    during     after   first 50K after\n";
+    for (CachePolicy policy : {CachePolicy::LRU, CachePolicy::CLOCK, CachePolicy::TINYLFU}) {
+        LRUCache cache(capacity, 0, policy);
+        bench::Zipf zipf(keys, 0.99);
+        std::mt19937_64 rng(42);
+        std::string value;
+        auto request = [&](const std::string& code) {
+            if (cache.get(code, value)) return 1;
+            cache.put(code, code);
+            return 0;
+        };
+
+        int before = 0, during = 0, after = 0, justAfter = 0;
+        for (int i = 0; i < phaseRequests; i++) before += request(std::to_string(zipf(rng)));
+        for (int i = 0; i < scanKeys; i++) {
+            request("scan-" + std::to_string(i));
+            during += request(std::to_string(zipf(rng)));
+        }
+        for (int i = 0; i < phaseRequests; i++) {
+            int hit = request(std::to_string(zipf(rng)));
+            after += hit;
+            if (i < 50000) justAfter += hit;
+        }
+        std::cout << "  " << std::left << std::setw(8) << policyName(policy) << std::right
+                  << std::fixed << std::setprecision(4)
+                  << std::setw(10) << (double)before / phaseRequests
+                  << std::setw(10) << (double)during / scanKeys
+                  << std::setw(10) << (double)after / phaseRequests
+                  << std::setw(14) << justAfter / 50000.0 << "\n";
+    }
+}
+
+// The service's default 100-entry cache: the default shard count against
+// 64 shards (what hardware-based sharding alone picks on 32+ cores)
+static bool defaultCapacity() {
+    const int capacity = 100;
+    const size_t keys = 10000;
+    const int requests = 1000000;
+    std::cout << "  keys=" << keys << " skew=0.99 cache=" << capacity << "\n";
+    std::cout << "  policy     shards   hit ratio   64 shards\n";
+    bool ok = true;
+    for (CachePolicy policy : {CachePolicy::LRU, CachePolicy::CLOCK, CachePolicy::TINYLFU}) {
+        double ratio[2];
+        int shards = 0;
+        for (int k = 0; k < 2; k++) {
+            LRUCache cache(capacity, k == 0 ? 0 : 64, policy);
+            if (k == 0) shards = (int)cache.shardCount();
+            bench::Zipf zipf(keys, 0.99);
+            std::mt19937_64 rng(42);
+            std::string value;
+            int hits = 0;
+            for (int i = 0; i < requests; i++) {
+                std::string code = std::to_string(zipf(rng));
+                if (cache.get(code, value)) hits++;
+                else cache.put(code, code);
+            }
+            ratio[k] = (double)hits / requests;
+        }
+        ok = ok && ratio[0] >= ratio[1];
+        std::cout << "  " << std::left << std::setw(8) << policyName(policy) << std::right
+                  << std::setw(9) << shards << std::fixed << std::setprecision(4)
+                  << std::setw(12) << ratio[0] << std::setw(12) << ratio[1] << "\n";
+    }
+    std::cout << (ok ? "  ✅ default sharding keeps the small cache's hit ratio\n"
+                     : "  ❌ default sharding lost hits at capacity 100\n");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+
+    bench::section("LRUCache hit throughput — single lock (1 shard)");
+    hitScaling(1, CachePolicy::LRU, maxThreads);
+
+    bench::section("LRUCache hit throughput — sharded (default)");
+    hitScaling(0, CachePolicy::LRU, maxThreads);
+
+    bench::section("CLOCK hit throughput — sharded, shared lock on hits");
+    hitScaling(0, CachePolicy::CLOCK, maxThreads);
+
+    bench::section("TINYLFU hit throughput — sharded, sketch update on every lookup");
+    hitScaling(0, CachePolicy::TINYLFU, maxThreads);
+
+    bench::section("Hit ratio — Zipfian redirect trace, LRU vs CLOCK vs TINYLFU");
+    hitRatioComparison();
+
+    bench::section("Hit ratio — Zipfian traffic through a one-off scan");
+    scanResistance();
+
+    bench::section("Hit ratio — default capacity (100 entries)");
+    return defaultCapacity() ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// URL codec: bytes per stored URL and encode/decode cost on a synthetic
+// corpus shaped like real shortener traffic (marketing links with UTM tags,
+// video and shop links, docs, CDN assets, long opaque tokens)
+//   g++ -std=c++17 -O2 -pthread bench/codec_bench.cpp core/*.cpp -o codec_bench
+//   ./codec_bench [urls]
+#include "BenchUtil.h"
+#include "../core/UrlCodec.h"
+#include "../core/FlatUrlStore.h"
+#include <iomanip>
+
+namespace {
+
+const char* const DOMAINS[] = {
+    "www.example.com", "blog.acme.io", "shop.contoso.com", "news.ycombinator.com",
+    "medium.com", "www.nytimes.com", "github.com", "docs.google.com",
+    "www.linkedin.com", "twitter.com", "www.reddit.com", "en.wikipedia.org",
+    "store.steampowered.com", "www.bbc.co.uk", "cdn.shopify.com", "substack.com",
+};
+const char* const WORDS[] = {
+    "how", "to", "build", "a", "fast", "url", "shortener", "guide", "2024", "review",
+    "best", "new", "product", "launch", "spring", "sale", "release", "notes", "api",
+    "design", "cloud", "data", "team", "update", "report", "free", "shipping", "women",
+    "men", "shoes", "summer", "deal", "video", "podcast", "episode", "interview",
+};
+const char* const SOURCES[] = {"newsletter", "twitter", "facebook", "linkedin", "google", "email"};
+const char* const MEDIUMS[] = {"email", "social", "cpc", "referral", "organic"};
+
+class Corpus {
+public:
+    explicit Corpus(uint64_t seed) : rng(seed) {}
+
+    std::string next() {
+        switch (rng() % 8) {
+        case 0:  return "https://www.youtube.com/watch?v=" + token(11) + (coin(3) ? "&t=" + number(600) + "s" : "");
+        case 1:  return "https://www.amazon.com/" + slug(3) + "/dp/B0" + upper(8) + "?ref=" + word() + "_" + number(99)
+                      + "&tag=" + word() + "-20";
+        case 2:  return "https://docs.google.com/document/d/" + token(44) + "/edit?usp=sharing";
+        case 3:  return "https://cdn.example.net/assets/" + number(2024) + "/" + number(12) + "/" + token(16) + ".jpg";
+        default: {
+            std::string url = std::string(coin(10) ? "http://" : "https://") + pick(DOMAINS);
+            int segments = 1 + (int)(rng() % 3);
+            for (int i = 0; i < segments; i++) url += "/" + (i + 1 == segments ? slug(2 + rng() % 5) : word());
+            if (coin(2)) url += ".html";
+            if (coin(2)) {
+                url += std::string("?utm_source=") + pick(SOURCES) + "&utm_medium=" + pick(MEDIUMS)
+                     + "&utm_campaign=" + slug(2);
+                if (coin(3)) url += "&fbclid=" + token(24);
+            } else if (coin(3)) {
+                url += "?id=" + number(1000000) + "&page=" + number(20);
+            }
+            return url;
+        }
+        }
+    }
+
+private:
+    std::mt19937_64 rng;
+
+    template <size_t N>
+    const char* pick(const char* const (&list)[N]) { return list[rng() % N]; }
+    bool coin(int oneIn) { return rng() % oneIn == 0; }
+    std::string word() { return pick(WORDS); }
+    std::string number(uint64_t below) { return std::to_string(rng() % below); }
+    std::string slug(size_t words) {
+        std::string s = word();
+        for (size_t i = 1; i < words; i++) s += "-" + word();
+        return s;
+    }
+    std::string token(size_t len) {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        std::string s(len, ' ');
+        for (char& c : s) c = alphabet[rng() % 64];
+        return s;
+    }
+    std::string upper(size_t len) {
+        std::string s(len, ' ');
+        for (char& c : s) c = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"[rng() % 36];
+        return s;
+    }
+};
+
+size_t totalBytes(const std::vector<std::string>& values) {
+    size_t sum = 0;
+    for (const std::string& v : values) sum += v.size();
+    return sum;
+}
+
+template <class Fn>
+double nsPerUrl(size_t urls, int rounds, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) fn();
+    return bench::secondsSince(start) * 1e9 / ((double)urls * rounds);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::stoull(argv[1]) : 200000;
+    Corpus corpus(2024);
+    std::vector<std::string> urls(n);
+    for (std::string& url : urls) url = corpus.next();
+
+    // A model trained on the first half, measured on the second
+    std::vector<std::string> trainSet(urls.begin(), urls.begin() + n / 2);
+    std::vector<std::string> testSet(urls.begin() + n / 2, urls.end());
+    const UrlCodec& standard = UrlCodec::standard();
+    auto trainStart = std::chrono::steady_clock::now();
+    UrlCodec trained = UrlCodec::train(trainSet);
+    double trainSeconds = bench::secondsSince(trainStart);
+
+    std::vector<std::string> byStandard, byTrained;
+    for (const std::string& url : testSet) {
+        byStandard.push_back(standard.encode(url));
+        byTrained.push_back(trained.encode(url));
+    }
+
+    bench::section("Bytes per URL (" + std::to_string(testSet.size()) + " held-out URLs)");
+    double raw = (double)totalBytes(testSet) / testSet.size();
+    auto row = [&](const char* name, size_t tokens, const std::vector<std::string>& encoded) {
+        double bytes = (double)totalBytes(encoded) / encoded.size();
+        std::cout << "  " << std::left << std::setw(30) << name << std::right
+                  << std::setw(6) << tokens << std::setw(10) << std::fixed << std::setprecision(1) << bytes
+                  << std::setw(9) << std::setprecision(0) << 100.0 * bytes / raw << "%\n";
+    };
+    std::cout << "  model                         tokens   B / URL   of raw\n";
+    row("raw", 0, testSet);
+    row("standard (built in)", standard.tokenCount(), byStandard);
+    row("trained on the other half", trained.tokenCount(), byTrained);
+    std::cout << "  (training on " << trainSet.size() << " URLs took "
+              << std::setprecision(0) << trainSeconds * 1000 << " ms)\n";
+
+    bench::section("Encode / decode, ns per URL (standard model)");
+    const int rounds = 5;
+    std::string scratch;
+    size_t sink = 0;
+    double encodeNs = nsPerUrl(testSet.size(), rounds, [&] {
+        for (const std::string& url : testSet) {
+            standard.encode(url, scratch);
+            sink += scratch.size();
+        }
+    });
+    std::vector<char> buffer(1 << 16);
+    double decodeNs = nsPerUrl(byStandard.size(), rounds, [&] {
+        for (const std::string& stored : byStandard) {
+            sink += standard.decode(stored, buffer.data());
+        }
+    });
+    double decodeStringNs = nsPerUrl(byStandard.size(), rounds, [&] {
+        for (const std::string& stored : byStandard) sink += standard.decode(stored).size();
+    });
+    bench::doNotOptimize(sink);
+    std::cout << "  encode                      " << std::setw(8) << std::setprecision(1) << encodeNs << "\n"
+              << "  decode into a buffer        " << std::setw(8) << decodeNs << "\n"
+              << "  decode into a std::string   " << std::setw(8) << decodeStringNs << "\n";
+
+    bench::section("FlatUrlStore memory, every URL stored");
+    FlatUrlStore plain, encoded;
+    for (size_t i = 0; i < n; i++) {
+        std::string code = std::to_string(i);
+        plain.put(code, urls[i], 0);
+        encoded.put(code, standard.encode(urls[i]), 0);
+    }
+    std::cout << "  plain URLs     " << std::setw(8) << std::setprecision(1) << plain.memoryBytes() / 1048576.0 << " MB\n"
+              << "  encoded URLs   " << std::setw(8) << encoded.memoryBytes() / 1048576.0 << " MB\n";
+
+    // Every URL round-trips through both models; plain values pass through
+    bool ok = true;
+    for (size_t i = 0; i < testSet.size() && ok; i++) {
+        ok = standard.decode(byStandard[i]) == testSet[i] && trained.decode(byTrained[i]) == testSet[i]
+          && standard.decode(testSet[i]) == testSet[i];
+    }
+    std::cout << (ok ? "\n  ✅ every URL decodes to itself\n" : "\n  ❌ a URL did not round-trip\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+// Negative-lookup filter benchmarks: a scan where 90% of codes are unknown
+//   g++ -std=c++17 -O2 -pthread bench/filter_bench.cpp core/*.cpp -o filter_bench
+//   ./filter_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/urlrespository.h"
+#include "../core/CuckooFilter.h"
+#include "../core/urlshortenerservice.h"
+#include "../core/Base62Encoder.h"
+#include <iomanip>
+
+// Lookups per second over `streams` (one per thread)
+template <typename Lookup>
+static double lookupRate(int threads, const std::vector<std::vector<std::string>>& streams, Lookup lookup) {
+    double secs = bench::runThreads(threads, [&](int t) {
+        size_t found = 0;
+        for (const std::string& code : streams[t]) found += lookup(code);
+        bench::doNotOptimize(found);
+    });
+    return threads * (double)streams[0].size() / secs / 1e6;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+    std::vector<int> threadCounts = bench::threadCounts(maxThreads);
+    const size_t links = 1000000;
+    const size_t perThread = 1000000;
+
+    UrlRepository unfiltered(100, false);
+    UrlRepository filtered(100, true);
+    ServiceConfig config;
+    config.reaperIntervalMs = 0;
+    UrlShortenerService service(config);
+
+    std::vector<ShortenRequest> batch;
+    for (size_t i = 1; i <= links; i++) {
+        std::string code = Base62Encoder::encode((long long)i);
+        std::string url = "https://example.com/article/" + std::to_string(i);
+        unfiltered.save(code, url);
+        filtered.save(code, url);
+        batch.push_back({url, 0, ""});
+        if (batch.size() == 1024 || i == links) {
+            service.shortenBatch(batch);
+            batch.clear();
+        }
+    }
+
+    // 90% random codes from a space 1000x larger than the stored one
+    std::vector<std::vector<std::string>> streams(threadCounts.back());
+    for (size_t t = 0; t < streams.size(); t++) {
+        std::mt19937_64 rng(t + 1);
+        streams[t].reserve(perThread);
+        for (size_t i = 0; i < perThread; i++) {
+            long long id = rng() % 10 == 0 ? (long long)(1 + rng() % links)
+                                           : (long long)(links + 1 + rng() % (links * 1000));
+            streams[t].push_back(Base62Encoder::encode(id));
+        }
+    }
+
+    bench::section("Unknown-code scan — M lookups/s (90% misses, 1M stored)");
+    std::cout << "  threads   repo, no filter   repo + filter   service redirect\n";
+    for (int threads : threadCounts) {
+        double a = lookupRate(threads, streams, [&](const std::string& c) { return !unfiltered.find(c).empty(); });
+        double b = lookupRate(threads, streams, [&](const std::string& c) { return !filtered.find(c).empty(); });
+        double s = lookupRate(threads, streams, [&](const std::string& c) { return !service.redirect(c).empty(); });
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(15) << a << "   " << std::setw(13) << b << "   " << std::setw(16) << s << "\n";
+    }
+
+    bench::section("Filter accuracy and size");
+    // The repository re-checks the table after a filter hit, so measure the
+    // filter itself on the same codes
+    CuckooFilter filter(links);
+    for (size_t i = 1; i <= links; i++) filter.insert(Base62Encoder::encode((long long)i));
+    size_t falsePositives = 0, misses = 0, lost = 0;
+    for (const std::string& code : streams[0]) {
+        long long id = 0;
+        Base62Encoder::decode(code, id);
+        if (id > (long long)links) {
+            misses++;
+            falsePositives += filter.mayContain(code);
+        } else {
+            lost += !filter.mayContain(code) + !filtered.exists(code);
+        }
+    }
+    std::cout << "  false positives " << falsePositives << " / " << misses << " ("
+              << std::setprecision(4) << 100.0 * falsePositives / misses << "%)\n"
+              << "  filter sized for 1M: " << std::setprecision(2) << (double)filter.memoryBytes() / links
+              << " bytes per link; grown in place: " << (double)filtered.filterBytes() / links
+              << " (retired tables included)\n";
+
+    // Deletions: removed codes stop passing the filter (up to false positives)
+    for (size_t i = 1; i <= links / 2; i++) {
+        std::string code = Base62Encoder::encode((long long)i);
+        filter.remove(code);
+        filtered.remove(code);
+    }
+    size_t stale = 0, sampled = 0;
+    for (size_t i = 1; i <= links / 2; i += 97, sampled++) {
+        std::string code = Base62Encoder::encode((long long)i);
+        stale += filter.mayContain(code) + filtered.exists(code);
+    }
+    for (size_t i = links / 2 + 1; i <= links; i += 97) {
+        std::string code = Base62Encoder::encode((long long)i);
+        lost += !filter.mayContain(code) + !filtered.exists(code);
+    }
+
+    bool ok = lost == 0 && stale * 100 <= sampled;
+    std::cout << (ok ? "  ✅ no stored code filtered out, removed codes no longer match\n"
+                     : "  ❌ " + std::to_string(lost) + " stored codes filtered out, " +
+                           std::to_string(stale) + " removed codes still present\n");
+    return ok ? 0 : 1;
+}
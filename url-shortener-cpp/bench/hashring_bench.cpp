@@ -0,0 +1,97 @@
+// Consistent hashing benchmarks: lookup cost, load balance and key movement
+//   g++ -std=c++17 -O2 -pthread bench/hashring_bench.cpp core/*.cpp -o hashring_bench
+//   ./hashring_bench [nodes]
+#include "BenchUtil.h"
+#include "../core/consistenthashing.h"
+#include "../core/Base62Encoder.h"
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+
+// The original ring: std::hash into a std::map, 3 virtual nodes per node
+class LegacyRing {
+    std::map<size_t, int> ring;
+
+public:
+    void addNode(int nodeId) {
+        for (int i = 0; i < 3; i++) {
+            ring[std::hash<std::string>{}("NODE_" + std::to_string(nodeId) + "_" + std::to_string(i))] = nodeId;
+        }
+    }
+
+    int getNode(const std::string& key) const {
+        if (ring.empty()) return -1;
+        auto it = ring.lower_bound(std::hash<std::string>{}(key));
+        return it == ring.end() ? ring.begin()->second : it->second;
+    }
+};
+
+struct RingStats {
+    double nsPerLookup;
+    double maxOverMean;
+    double moved;        // fraction of keys that change node when one node is added
+};
+
+// `make()` returns a lookup over a ring with the first n nodes
+template <typename Make>
+static RingStats measure(Make make, int nodes, const std::vector<std::string>& keys) {
+    auto lookup = make(nodes);
+    std::vector<int> before(keys.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i++) before[i] = lookup(keys[i]);
+    double ns = bench::secondsSince(start) * 1e9 / keys.size();
+
+    std::vector<size_t> load(nodes + 1, 0);
+    for (int node : before) load[node]++;
+    size_t most = *std::max_element(load.begin(), load.end());
+    double mean = (double)keys.size() / nodes;
+
+    auto grown = make(nodes + 1);
+    size_t moved = 0;
+    for (size_t i = 0; i < keys.size(); i++) moved += grown(keys[i]) != before[i];
+    return {ns, most / mean, (double)moved / keys.size()};
+}
+
+static void printRow(const std::string& name, const RingStats& s) {
+    std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(8) << s.nsPerLookup << "   "
+              << std::setprecision(3) << std::setw(8) << s.maxOverMean << "   "
+              << std::setprecision(1) << std::setw(7) << s.moved * 100 << "%\n";
+}
+
+int main(int argc, char** argv) {
+    int nodes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+    const size_t keyCount = 1000000;
+
+    // Short codes as the service issues them
+    std::vector<std::string> keys;
+    keys.reserve(keyCount);
+    for (size_t i = 1; i <= keyCount; i++) keys.push_back(Base62Encoder::encode((long long)i));
+
+    bench::section("Hash ring — " + std::to_string(nodes) + " nodes, 1M short codes");
+    std::cout << "  algorithm              ns/op    max/mean   moved on +1 node (ideal "
+              << std::setprecision(1) << std::fixed << 100.0 / (nodes + 1) << "%)\n";
+
+    using Lookup = std::function<int(const std::string&)>;
+    printRow("legacy map, 3 vnodes", measure([](int n) -> Lookup {
+        auto ring = std::make_shared<LegacyRing>();
+        for (int i = 1; i <= n; i++) ring->addNode(i);
+        return [ring](const std::string& key) { return ring->getNode(key); };
+    }, nodes, keys));
+
+    auto row = [&](const std::string& name, HashAlgorithm algorithm, int vnodes) {
+        printRow(name, measure([&](int n) -> Lookup {
+            auto ring = std::make_shared<ConsistentHashRing>(vnodes, algorithm);
+            for (int i = 1; i <= n; i++) ring->addNode(i);
+            return [ring](const std::string& key) { return ring->getNode(key); };
+        }, nodes, keys));
+    };
+    for (int vnodes : {3, 16, 64, 160, 512}) {
+        row("ring, " + std::to_string(vnodes) + " vnodes", HashAlgorithm::Ring, vnodes);
+    }
+    row("jump", HashAlgorithm::Jump, 0);
+    row("maglev", HashAlgorithm::Maglev, 0);
+    row("rendezvous", HashAlgorithm::Rendezvous, 0);
+    return 0;
+}
@@ -0,0 +1,166 @@
+// ID generation benchmarks
+//   g++ -std=c++17 -O2 -pthread bench/id_bench.cpp core/*.cpp -o id_bench
+//   ./id_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/Idgenerator.h"
+#include "../core/Base62Encoder.h"
+#include <iomanip>
+#include <memory>
+#include <climits>
+
+// IDs/s from `threads` threads hammering one generator
+static double idThroughput(IdMode mode, int threads) {
+    Idgenerator gen(mode, 1);
+    const int perThread = 2000000;
+    double secs = bench::runThreads(threads, [&](int) {
+        uint64_t sum = 0;   // unsigned: Snowflake IDs overflow a signed sum
+        for (int i = 0; i < perThread; i++) sum += (uint64_t)gen.getNextId();
+        bench::doNotOptimize(sum);
+    });
+    return threads * (double)perThread / secs / 1e6;
+}
+
+// The original prepend-a-char encoder, kept as the baseline
+static std::string legacyEncode(long long number) {
+    static const std::string chars = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    if (number == 0) return "0";
+    std::string result = "";
+    while (number > 0) {
+        result = chars[number % 62] + result;
+        number /= 62;
+    }
+    return result;
+}
+
+// ns per code for fn(ids) over a block of Snowflake-sized IDs
+template <typename Fn>
+static double nsPerCode(const std::vector<long long>& ids, int rounds, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) fn();
+    return bench::secondsSince(start) * 1e9 / ((double)rounds * ids.size());
+}
+
+// Encode/decode round trip over edge values and random IDs; returns mismatches
+static size_t base62RoundTrip(const std::vector<long long>& ids) {
+    std::vector<long long> values = {0, 1, 61, 62, 3843, 3844, 3845, 238327, 238328, LLONG_MAX};
+    values.insert(values.end(), ids.begin(), ids.end());
+    std::vector<Base62Encoder::Code> batch(values.size());
+    Base62Encoder::encodeBatch(values.data(), values.size(), batch.data());
+    size_t bad = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        std::string legacy = legacyEncode(values[i]);
+        long long back = -1;
+        char fixed[Base62Encoder::MAX_LEN];
+        bool ok = Base62Encoder::encode(values[i]) == legacy
+               && batch[i].view() == legacy
+               && Base62Encoder::decode(legacy, back) && back == values[i]
+               && Base62Encoder::encodeFixed(values[i], fixed, Base62Encoder::MAX_LEN)
+               && Base62Encoder::decode(std::string_view(fixed, Base62Encoder::MAX_LEN), back) && back == values[i];
+        bad += !ok;
+    }
+    long long dummy;
+    for (const char* badCode : {"", "ab-c", "abc/", "zzzzzzzzzzzz", "aZl8N0y58M8" /* LLONG_MAX + 1 */}) {
+        bad += Base62Encoder::decode(badCode, dummy);
+    }
+    return bad;
+}
+
+// Uniqueness across simulated nodes x threads, mixing single IDs and
+// reserveRange blocks. Returns the number of duplicates found.
+static size_t uniquenessCheck(int nodes, int threadsPerNode, int perThread) {
+    std::vector<std::unique_ptr<Idgenerator>> gens;
+    for (int n = 0; n < nodes; n++) gens.push_back(std::make_unique<Idgenerator>(IdMode::Snowflake, n, 16));
+
+    int threads = nodes * threadsPerNode;
+    std::vector<std::vector<long long>> issued(threads);
+    bench::runThreads(threads, [&](int t) {
+        Idgenerator& gen = *gens[t / threadsPerNode];
+        std::vector<long long>& out = issued[t];
+        out.reserve(perThread);
+        std::mt19937 rng(t);
+        while ((int)out.size() < perThread) {
+            if (rng() % 8 == 0) {
+                long long first;
+                int got = gen.reserveRange(1 + rng() % 200, first);
+                for (int i = 0; i < got && (int)out.size() < perThread; i++) out.push_back(first + i);
+            } else {
+                out.push_back(gen.getNextId());
+            }
+        }
+    });
+
+    std::vector<long long> all;
+    for (auto& v : issued) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    size_t dups = 0;
+    for (size_t i = 1; i < all.size(); i++) dups += all[i] == all[i - 1];
+    bool positive = all.empty() || all.front() > 0;
+    std::cout << "  nodes=" << nodes << " threads/node=" << threadsPerNode
+              << " ids=" << all.size() << " duplicates=" << dups
+              << (positive ? "" : " (non-positive IDs!)") << "\n";
+    return dups + (positive ? 0 : 1);
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+
+    bench::section("ID generation — shared counter vs. Snowflake leases");
+    std::cout << "  threads   counter M/s   snowflake M/s\n";
+    for (int threads : bench::threadCounts(maxThreads)) {
+        double counter = idThroughput(IdMode::Counter, threads);
+        double snow = idThroughput(IdMode::Snowflake, threads);
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(1)
+                  << std::setw(11) << counter << "   " << std::setw(13) << snow << "\n";
+    }
+
+    bench::section("Base62 — ns per code (Snowflake-sized IDs)");
+    std::vector<long long> ids(4096);
+    {
+        Idgenerator gen(IdMode::Snowflake, 1);
+        for (long long& id : ids) id = gen.getNextId();
+    }
+    std::vector<std::string> strings(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) strings[i] = Base62Encoder::encode(ids[i]);
+    std::vector<Base62Encoder::Code> codes(ids.size());
+    const int rounds = 500;
+    double legacyNs = nsPerCode(ids, rounds, [&] {
+        size_t n = 0;
+        for (long long id : ids) n += legacyEncode(id).size();
+        bench::doNotOptimize(n);
+    });
+    double stringNs = nsPerCode(ids, rounds, [&] {
+        size_t n = 0;
+        for (long long id : ids) n += Base62Encoder::encode(id).size();
+        bench::doNotOptimize(n);
+    });
+    double bufferNs = nsPerCode(ids, rounds, [&] {
+        char buf[Base62Encoder::MAX_LEN];
+        size_t n = 0;
+        for (long long id : ids) n += Base62Encoder::encode(id, buf) + buf[0];
+        bench::doNotOptimize(n);
+    });
+    double batchNs = nsPerCode(ids, rounds, [&] {
+        Base62Encoder::encodeBatch(ids.data(), ids.size(), codes.data());
+        bench::doNotOptimize(codes[ids.size() - 1].len);
+    });
+    double decodeNs = nsPerCode(ids, rounds, [&] {
+        uint64_t sum = 0;
+        long long v = 0;
+        for (const std::string& s : strings) sum += Base62Encoder::decode(s, v) ? (uint64_t)v : 0;
+        bench::doNotOptimize(sum);
+    });
+    std::cout << std::fixed << std::setprecision(1)
+              << "  legacy encode (string prepend)  " << std::setw(7) << legacyNs << " ns\n"
+              << "  encode -> std::string           " << std::setw(7) << stringNs << " ns\n"
+              << "  encode -> char buffer           " << std::setw(7) << bufferNs << " ns\n"
+              << "  encodeBatch                     " << std::setw(7) << batchNs << " ns\n"
+              << "  decode                          " << std::setw(7) << decodeNs << " ns\n";
+    size_t codecErrors = base62RoundTrip(ids);
+    std::cout << (codecErrors == 0 ? "  ✅ round trip matches the legacy encoder\n"
+                                   : "  ❌ Base62 round-trip mismatches\n");
+
+    bench::section("Snowflake uniqueness — simulated nodes and threads");
+    size_t failures = codecErrors + uniquenessCheck(4, 4, 200000) + uniquenessCheck(32, 2, 50000);
+    std::cout << (failures == 0 ? "  ✅ all IDs unique\n" : "  ❌ duplicate IDs found\n");
+    return failures == 0 ? 0 : 1;
+}
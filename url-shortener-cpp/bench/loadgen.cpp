@@ -0,0 +1,215 @@
+// Loopback load generator for the native HTTP server (Linux)
+//   g++ -std=c++17 -O2 -pthread bench/loadgen.cpp net/*.cpp core/*.cpp -o loadgen
+//   ./loadgen [--port P] [--host 127.0.0.1] [--conns 8] [--depth 16]
+//             [--seconds 5] [--links 10000] [--server-threads N]
+//
+// Without --port it starts an in-process HttpServer on a free loopback port
+// (rate limiting off), so one binary measures the whole stack. Each
+// connection keeps `depth` pipelined GET /{code} requests in flight, with
+// codes drawn from a Zipf(0.99) distribution over the created links.
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include "../net/HttpServer.h"
+#include <iomanip>
+#include <memory>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+int connectTo(const std::string& host, int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+struct Response {
+    int status = 0;
+    std::string body;
+};
+
+// Read exactly `count` responses (Content-Length framed) from fd
+bool readResponses(int fd, std::string& buf, size_t count, std::vector<Response>& out) {
+    out.clear();
+    char chunk[16 * 1024];
+    while (out.size() < count) {
+        size_t headerEnd = buf.find("\r\n\r\n");
+        if (headerEnd != std::string::npos) {
+            size_t cl = buf.find("Content-Length: ");
+            size_t length = cl < headerEnd ? std::strtoul(buf.c_str() + cl + 16, nullptr, 10) : 0;
+            if (buf.size() >= headerEnd + 4 + length) {
+                Response r;
+                r.status = std::atoi(buf.c_str() + 9);   // "HTTP/1.1 302"
+                r.body = buf.substr(headerEnd + 4, length);
+                out.push_back(std::move(r));
+                buf.erase(0, headerEnd + 4 + length);
+                continue;
+            }
+        }
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    return true;
+}
+
+std::string jsonStringField(const std::string& body, const std::string& key) {
+    std::string needle = "\"" + key + "\":\"";
+    size_t start = body.find(needle);
+    if (start == std::string::npos) return "";
+    start += needle.size();
+    return body.substr(start, body.find('"', start) - start);
+}
+
+// POST `links` URLs over one pipelined connection; returns their codes
+std::vector<std::string> createLinks(const std::string& host, int port, size_t links) {
+    std::vector<std::string> codes;
+    int fd = connectTo(host, port);
+    if (fd < 0) return codes;
+    std::string buf;
+    std::vector<Response> responses;
+    const size_t batch = 64;
+    for (size_t done = 0; done < links; done += batch) {
+        size_t n = std::min(batch, links - done);
+        std::string req;
+        for (size_t i = 0; i < n; i++) {
+            std::string body = "{\"longUrl\":\"https://example.com/page/" + std::to_string(done + i) + "\"}";
+            req += "POST /shorten HTTP/1.1\r\nHost: " + host + "\r\nContent-Type: application/json\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        }
+        if (!sendAll(fd, req) || !readResponses(fd, buf, n, responses)) break;
+        for (const Response& r : responses) {
+            if (r.status == 201) codes.push_back(jsonStringField(r.body, "shortCode"));
+        }
+    }
+    close(fd);
+    return codes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string host = "127.0.0.1";
+    int port = 0, conns = 8, depth = 16, serverThreads = 0;
+    double seconds = 5;
+    size_t links = 10000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--host") host = argv[i + 1];
+        else if (arg == "--port") port = std::atoi(argv[i + 1]);
+        else if (arg == "--conns") conns = std::atoi(argv[i + 1]);
+        else if (arg == "--depth") depth = std::atoi(argv[i + 1]);
+        else if (arg == "--seconds") seconds = std::atof(argv[i + 1]);
+        else if (arg == "--links") links = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--server-threads") serverThreads = std::atoi(argv[i + 1]);
+    }
+
+    std::unique_ptr<UrlShortenerService> service;
+    std::unique_ptr<HttpServer> server;
+    if (port == 0) {
+        ServiceConfig serviceConfig;
+        serviceConfig.cacheCapacity = (int)links;
+        service = std::make_unique<UrlShortenerService>(serviceConfig);
+        HttpServerConfig serverConfig;
+        serverConfig.bindAddress = host;
+        serverConfig.port = 0;
+        serverConfig.threads = serverThreads;
+        serverConfig.rateLimit = false;
+        server = std::make_unique<HttpServer>(*service, serverConfig);
+        if (!server->start()) return 1;
+        port = server->port();
+        std::cout << "  in-process server on " << host << ":" << port
+                  << " (" << server->threadCount() << " worker(s))\n";
+    }
+
+    bench::section("HTTP loopback — POST /shorten");
+    auto createStart = std::chrono::steady_clock::now();
+    std::vector<std::string> codes = createLinks(host, port, links);
+    double createSecs = bench::secondsSince(createStart);
+    std::cout << "  created " << codes.size() << "/" << links << " links in "
+              << std::fixed << std::setprecision(2) << createSecs << " s ("
+              << std::setprecision(0) << codes.size() / createSecs << " req/s)\n";
+    if (codes.empty()) return 1;
+
+    bench::section("HTTP loopback — pipelined GET /{code}");
+    bench::Zipf zipf(codes.size(), 0.99);
+    std::vector<size_t> completed(conns, 0), failures(conns, 0);
+    std::vector<std::vector<double>> latencies(conns);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+
+    double secs = bench::runThreads(conns, [&](int t) {
+        int fd = connectTo(host, port);
+        if (fd < 0) {
+            failures[t]++;
+            return;
+        }
+        std::mt19937_64 rng(t + 1);
+        std::string buf, req;
+        std::vector<Response> responses;
+        while (std::chrono::steady_clock::now() < deadline) {
+            req.clear();
+            for (int i = 0; i < depth; i++) {
+                req += "GET /";
+                req += codes[zipf(rng)];
+                req += " HTTP/1.1\r\nHost: ";
+                req += host;
+                req += "\r\n\r\n";
+            }
+            auto start = std::chrono::steady_clock::now();
+            if (!sendAll(fd, req) || !readResponses(fd, buf, depth, responses)) {
+                failures[t]++;
+                break;
+            }
+            latencies[t].push_back(bench::secondsSince(start) * 1e6);
+            for (const Response& r : responses) {
+                if (r.status == 301 || r.status == 302) completed[t]++;
+                else failures[t]++;
+            }
+        }
+        close(fd);
+    });
+
+    size_t total = 0, failed = 0;
+    std::vector<double> all;
+    for (int t = 0; t < conns; t++) {
+        total += completed[t];
+        failed += failures[t];
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+    }
+    std::sort(all.begin(), all.end());
+    auto pct = [&](double p) { return all.empty() ? 0.0 : all[(size_t)(p * (all.size() - 1))]; };
+
+    std::cout << "  conns=" << conns << " depth=" << depth << "\n";
+    std::cout << "  redirects/s        " << std::setprecision(0) << total / secs << "\n";
+    std::cout << "  batch RTT p50/p99  " << std::setprecision(1) << pct(0.50) << " / " << pct(0.99)
+              << " µs (" << depth << " requests per batch)\n";
+    std::cout << (failed == 0 ? "  ✅ every response was a redirect\n"
+                              : "  ❌ " + std::to_string(failed) + " failed requests\n");
+
+    if (server) server->stop();
+    return failed == 0 ? 0 : 1;
+}
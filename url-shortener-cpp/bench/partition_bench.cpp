@@ -0,0 +1,128 @@
+// Partitioned repository benchmarks: throughput vs. node count, and an
+// online rebalance (addNode while readers run) that counts moved keys
+//   g++ -std=c++17 -O2 -pthread bench/partition_bench.cpp core/*.cpp -o partition_bench
+//   ./partition_bench [maxThreads] [maxNodes]
+#include "BenchUtil.h"
+#include "../core/PartitionedRepository.h"
+#include "../core/Base62Encoder.h"
+#include <iomanip>
+
+static std::unique_ptr<PartitionedRepository> makeRepository(int nodes, const std::vector<std::string>& codes) {
+    auto repo = std::make_unique<PartitionedRepository>();
+    for (int n = 1; n <= nodes; n++) repo->addNode(n);
+    repo->waitForMigration();
+
+    const size_t batch = 1024;
+    std::vector<std::string> urls(batch);
+    std::vector<RepositoryWrite> writes;
+    for (size_t start = 0; start < codes.size(); start += batch) {
+        writes.clear();
+        for (size_t i = start; i < std::min(codes.size(), start + batch); i++) {
+            urls[i - start] = "https://example.com/article/" + codes[i];
+            RepositoryWrite w;
+            w.shortCode = codes[i];
+            w.longUrl = urls[i - start];
+            writes.push_back(w);
+        }
+        repo->saveBatch(writes);
+    }
+    return repo;
+}
+
+// Every thread does `perThread` Zipfian finds, 1% of them preceded by a save
+static double mixedThroughput(PartitionedRepository& repo, const std::vector<std::string>& codes,
+                              int threads, size_t perThread) {
+    bench::Zipf zipf(codes.size(), 0.99);
+    double secs = bench::runThreads(threads, [&](int t) {
+        std::mt19937_64 rng(t + 1);
+        size_t found = 0;
+        for (size_t i = 0; i < perThread; i++) {
+            const std::string& code = codes[zipf(rng)];
+            if (i % 100 == 0) repo.save(code, "https://example.com/updated/" + code);
+            found += !repo.find(code).empty();
+        }
+        bench::doNotOptimize(found);
+    });
+    return threads * (double)perThread / secs / 1e6;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+    int maxNodes = argc > 2 ? std::max(2, std::atoi(argv[2])) : 8;
+    std::vector<int> threadCounts = bench::threadCounts(maxThreads);
+    const size_t keyCount = 1000000;
+    const size_t perThread = 500000;
+
+    std::vector<std::string> codes;
+    codes.reserve(keyCount);
+    for (size_t i = 1; i <= keyCount; i++) codes.push_back(Base62Encoder::encode((long long)i));
+
+    bench::section("Partitions — M ops/s (99% find / 1% save), 1M links");
+    std::cout << "  nodes";
+    for (int threads : threadCounts) std::cout << std::setw(10) << threads << "T";
+    std::cout << "\n";
+    for (int nodes = 1; nodes <= maxNodes; nodes *= 2) {
+        auto repo = makeRepository(nodes, codes);
+        std::cout << "  " << std::setw(5) << nodes;
+        for (int threads : threadCounts) {
+            std::cout << std::fixed << std::setprecision(2) << std::setw(11)
+                      << mixedThroughput(*repo, codes, threads, perThread);
+        }
+        std::cout << "\n";
+    }
+
+    bench::section("Rebalance — addNode while readers run");
+    int nodes = std::max(1, maxNodes / 2);
+    auto repo = makeRepository(nodes, codes);
+    std::vector<int> before(codes.size());
+    for (size_t i = 0; i < codes.size(); i++) before[i] = repo->nodeFor(codes[i]);
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> reads{0}, misses{0};
+    int readers = std::max(1, threadCounts.back());
+    std::vector<std::thread> pool;
+    for (int t = 0; t < readers; t++) {
+        pool.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 100);
+            size_t n = 0, missed = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                missed += repo->find(codes[rng() % codes.size()]).empty();
+                n++;
+            }
+            reads += n;
+            misses += missed;
+        });
+    }
+
+    int newNode = nodes + 1;
+    auto start = std::chrono::steady_clock::now();
+    repo->addNode(newNode);
+    repo->waitForMigration();
+    double secs = bench::secondsSince(start);
+    done = true;
+    for (std::thread& t : pool) t.join();
+
+    size_t expected = 0, wrongTarget = 0;
+    for (size_t i = 0; i < codes.size(); i++) {
+        int after = repo->nodeFor(codes[i]);
+        if (after != before[i]) {
+            expected++;
+            wrongTarget += after != newNode;
+        }
+    }
+    size_t moved = repo->movedCount();
+
+    std::cout << "  " << nodes << " → " << newNode << " nodes: moved " << moved << " keys ("
+              << std::fixed << std::setprecision(1) << 100.0 * moved / codes.size() << "%, ideal "
+              << 100.0 / newNode << "%) in " << std::setprecision(0) << secs * 1e3 << " ms\n"
+              << "  " << readers << " reader(s) served " << std::setprecision(2) << reads / secs / 1e6
+              << " M finds/s during the move, " << misses << " misses\n"
+              << "  new node holds " << repo->nodeSize(newNode) << ", total " << repo->size() << "\n";
+
+    bool ok = moved == expected && wrongTarget == 0 && misses == 0 &&
+              repo->nodeSize(newNode) == moved && repo->size() == codes.size();
+    std::cout << (ok ? "  ✅ only the new node's ranges moved, no key lost or missed\n"
+                     : "  ❌ rebalance check failed (expected " + std::to_string(expected) + " moved, " +
+                           std::to_string(wrongTarget) + " to another node)\n");
+    return ok ? 0 : 1;
+}
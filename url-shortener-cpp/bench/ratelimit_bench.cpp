@@ -0,0 +1,154 @@
+// Rate limiter benchmarks: many distinct IPs (scan) and one hot IP
+//   g++ -std=c++17 -O2 -pthread bench/ratelimit_bench.cpp core/*.cpp -o ratelimit_bench
+//   ./ratelimit_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/RateLimiter.h"
+#include <iomanip>
+#include <mutex>
+#include <unordered_map>
+
+// The original limiter: one mutex, one std::string-keyed map that never shrinks
+class LegacyRateLimiter {
+    struct Bucket {
+        double tokens;
+        std::chrono::steady_clock::time_point lastRefill;
+    };
+    double maxTokens, refillRate;
+    std::unordered_map<std::string, Bucket> buckets;
+    std::mutex mtx;
+
+public:
+    LegacyRateLimiter(double maxTokens, double refillRate) : maxTokens(maxTokens), refillRate(refillRate) {}
+
+    bool allowRequest(const std::string& ip) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto now = std::chrono::steady_clock::now();
+        auto it = buckets.find(ip);
+        if (it == buckets.end()) {
+            buckets[ip] = {maxTokens - 1.0, now};
+            return true;
+        }
+        Bucket& b = it->second;
+        double elapsed = std::chrono::duration<double>(now - b.lastRefill).count();
+        b.tokens = std::min(maxTokens, b.tokens + elapsed * refillRate);
+        b.lastRefill = now;
+        if (b.tokens >= 1.0) {
+            b.tokens -= 1.0;
+            return true;
+        }
+        return false;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return buckets.size();
+    }
+};
+
+static std::vector<std::string> randomIps(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> ips;
+    ips.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = (uint32_t)rng();
+        ips.push_back(std::to_string(a >> 24) + "." + std::to_string((a >> 16) & 255) + "." +
+                      std::to_string((a >> 8) & 255) + "." + std::to_string(a & 255));
+    }
+    return ips;
+}
+
+// M decisions/s for `threads` threads; ipsFor(t) is thread t's request stream
+template <typename Limiter>
+static double throughput(Limiter& limiter, int threads, const std::vector<std::vector<std::string>>& streams) {
+    double secs = bench::runThreads(threads, [&](int t) {
+        size_t allowed = 0;
+        for (const std::string& ip : streams[t]) allowed += limiter.allowRequest(ip);
+        bench::doNotOptimize(allowed);
+    });
+    size_t total = 0;
+    for (int t = 0; t < threads; t++) total += streams[t].size();
+    return total / secs / 1e6;
+}
+
+static int correctnessChecks() {
+    int failures = 0;
+    auto same = [&](const char* a, const char* b) {
+        if (!(RateLimiter::keyFor(a) == RateLimiter::keyFor(b))) {
+            std::cout << "  ❌ " << a << " and " << b << " should be the same client\n";
+            failures++;
+        }
+    };
+    same("1.2.3.4", "::ffff:1.2.3.4");
+    same("::1", "0:0:0:0:0:0:0:1");
+    same("2001:db8::8a2e:370:7334", "2001:0db8:0000:0000:0000:8a2e:0370:7334");
+    same("fe80::1%eth0", "fe80::1");
+    if (RateLimiter::keyFor("1.2.3.4") == RateLimiter::keyFor("1.2.3.5")) failures++;
+
+    // Burst of 5 with no refill: exactly 5 allowed
+    RateLimiter limiter(5.0, 0.0);
+    int allowed = 0;
+    for (int i = 0; i < 20; i++) allowed += limiter.allowRequest("10.0.0.1");
+    if (allowed != 5) {
+        std::cout << "  ❌ burst of 5 allowed " << allowed << "\n";
+        failures++;
+    }
+
+    // Bounded: 200k distinct IPs into a 10k-bucket limiter
+    RateLimiter bounded(5.0, 2.0, 10000);
+    for (const std::string& ip : randomIps(200000, 7)) bounded.allowRequest(ip);
+    if (bounded.bucketCount() > 10000 * 4 / 3) {
+        std::cout << "  ❌ bounded limiter holds " << bounded.bucketCount() << " buckets\n";
+        failures++;
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+    std::vector<int> threadCounts = bench::threadCounts(maxThreads);
+    int most = threadCounts.back();
+    const size_t perThread = 1000000;
+
+    // Scan: every request from a different address out of 2M
+    std::vector<std::string> pool = randomIps(2000000, 42);
+    std::vector<std::vector<std::string>> scan(most), hot(most);
+    for (int t = 0; t < most; t++) {
+        std::mt19937_64 rng(t);
+        scan[t].reserve(perThread);
+        for (size_t i = 0; i < perThread; i++) scan[t].push_back(pool[rng() % pool.size()]);
+        hot[t].assign(perThread, "203.0.113.7");
+    }
+
+    bench::section("Rate limiter — many IPs (scan), M decisions/s");
+    std::cout << "  threads   global mutex   sharded CAS\n";
+    for (int threads : threadCounts) {
+        LegacyRateLimiter legacy(5.0, 2.0);
+        RateLimiter limiter(5.0, 2.0, 1 << 16);
+        double a = throughput(legacy, threads, scan);
+        double b = throughput(limiter, threads, scan);
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(12) << a << "   " << std::setw(11) << b << "\n";
+        if (threads == most) {
+            std::cout << "  buckets after run: legacy " << legacy.size() << " (unbounded), sharded "
+                      << limiter.bucketCount() << " in " << limiter.memoryBytes() / 1024 << " KiB ("
+                      << limiter.evictedCount() << " evicted)\n";
+        }
+    }
+
+    bench::section("Rate limiter — one hot IP, M decisions/s");
+    std::cout << "  threads   global mutex   sharded CAS\n";
+    for (int threads : threadCounts) {
+        LegacyRateLimiter legacy(1e9, 1e9);
+        RateLimiter limiter(4000.0, 1e9);
+        double a = throughput(legacy, threads, hot);
+        double b = throughput(limiter, threads, hot);
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(12) << a << "   " << std::setw(11) << b << "\n";
+    }
+
+    bench::section("Rate limiter — correctness");
+    int failures = correctnessChecks();
+    std::cout << (failures == 0 ? "  ✅ address parsing, burst and bound checks passed\n"
+                                : "  ❌ rate limiter checks failed\n");
+    return failures == 0 ? 0 : 1;
+}
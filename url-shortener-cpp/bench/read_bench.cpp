@@ -0,0 +1,142 @@
+// Repository read scaling: 99% find / 1% save from 1 to 64 threads
+//   g++ -std=c++17 -O2 -pthread bench/read_bench.cpp core/*.cpp -o read_bench
+//   ./read_bench [maxThreads]    (default 64)
+#include "BenchUtil.h"
+#include "../core/urlrespository.h"
+#include "../core/FlatUrlStore.h"
+#include "../core/Base62Encoder.h"
+#include <iomanip>
+#include <shared_mutex>
+
+static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// The previous read path, kept here as the baseline: every find takes the
+// one mutex exclusively and erases an expired entry on the spot
+class LegacyRepository {
+    FlatUrlStore store;
+    std::mutex mtx;
+
+public:
+    void save(const std::string& code, const std::string& url) {
+        std::lock_guard<std::mutex> lock(mtx);
+        store.put(code, url, 0);
+    }
+
+    std::string find(const std::string& code) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::string url;
+        int64_t expiresAt;
+        if (!store.get(code, url, expiresAt)) return "";
+        if (expiresAt != 0 && nowMs() > expiresAt) {
+            store.erase(code);
+            return "";
+        }
+        return url;
+    }
+};
+
+// Same store behind std::shared_mutex: readers share the lock, but every
+// lock and unlock writes its single reader count
+class SharedMutexRepository {
+    FlatUrlStore store;
+    std::shared_mutex mtx;
+
+public:
+    void save(const std::string& code, const std::string& url) {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        store.put(code, url, 0);
+    }
+
+    std::string find(const std::string& code) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        std::string url;
+        int64_t expiresAt;
+        return store.get(code, url, expiresAt) ? url : "";
+    }
+};
+
+static std::string makeUrl(const std::string& code) {
+    return "https://www.example.com/articles/" + code + "?utm_source=newsletter";
+}
+
+// M operations/s: every thread does `perThread` Zipfian finds, one in 100
+// replaced by a save of an existing code
+template <class Repo>
+static double mixedRate(Repo& repo, const std::vector<std::string>& codes,
+                        const std::vector<std::string>& urls, int threads, size_t perThread) {
+    static const bench::Zipf zipf(codes.size(), 0.99);
+    double secs = bench::runThreads(threads, [&](int t) {
+        std::mt19937_64 rng(t + 1);
+        size_t found = 0;
+        for (size_t i = 0; i < perThread; i++) {
+            size_t k = zipf(rng);
+            if (i % 100 == 0) repo.save(codes[k], urls[k]);
+            else found += !repo.find(codes[k]).empty();
+        }
+        bench::doNotOptimize(found);
+    });
+    return threads * (double)perThread / secs / 1e6;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 64;
+    const size_t keyCount = 1000000;
+    const size_t totalOps = 4000000;   // split across the threads of each run
+
+    std::vector<std::string> codes, urls;
+    for (size_t i = 1; i <= keyCount; i++) {
+        codes.push_back(Base62Encoder::encode((long long)i));
+        urls.push_back(makeUrl(codes.back()));
+    }
+    LegacyRepository legacy;
+    SharedMutexRepository sharedMutex;
+    UrlRepository repo;
+    for (size_t i = 0; i < keyCount; i++) {
+        legacy.save(codes[i], urls[i]);
+        sharedMutex.save(codes[i], urls[i]);
+        repo.save(codes[i], urls[i]);
+    }
+
+    bench::section("Repository reads — M ops/s (99% find / 1% save), 1M links");
+    std::cout << "  threads   mutex (legacy)   shared_mutex   UrlRepository\n";
+    for (int threads : bench::threadCounts(maxThreads)) {
+        size_t perThread = totalOps / threads;
+        double a = mixedRate(legacy, codes, urls, threads, perThread);
+        double b = mixedRate(sharedMutex, codes, urls, threads, perThread);
+        double c = mixedRate(repo, codes, urls, threads, perThread);
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(14) << a << "   " << std::setw(12) << b << "   " << std::setw(13) << c << "\n";
+    }
+
+    bench::section("Expiry off the read path");
+    // Readers hide expired links without erasing them; the next write (no
+    // reaper running here) erases them
+    UrlRepository ttlRepo;
+    const size_t expiring = 10000;
+    for (size_t i = 0; i < expiring; i++) ttlRepo.save(codes[i], urls[i], 1);
+    for (size_t i = expiring; i < 2 * expiring; i++) ttlRepo.save(codes[i], urls[i]);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1300));
+
+    std::atomic<size_t> wrong{0};
+    int readers = std::min(4, std::max(1, maxThreads));
+    bench::runThreads(readers, [&](int t) {
+        for (size_t i = t; i < 2 * expiring; i += readers) {
+            bool found = !ttlRepo.find(codes[i]).empty();
+            if (found != (i >= expiring)) wrong++;
+        }
+    });
+    size_t sizeAfterReads = ttlRepo.size();
+    ttlRepo.save(codes[2 * expiring], urls[2 * expiring]);
+    size_t sizeAfterWrite = ttlRepo.size();
+    std::cout << "  after reads: " << sizeAfterReads << " stored (" << expiring
+              << " expired, hidden); after one write: " << sizeAfterWrite << " stored\n";
+
+    bool ok = wrong == 0 && sizeAfterReads == 2 * expiring && sizeAfterWrite == expiring + 1;
+    std::cout << (ok ? "  ✅ expired links never served, erased by the next write\n"
+                     : "  ❌ " + std::to_string(wrong) + " wrong lookups, sizes " + std::to_string(sizeAfterReads) +
+                           " / " + std::to_string(sizeAfterWrite) + "\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// Redirect hot path: heap allocations per call and cache-hit throughput,
+// redirect() (string copy) vs resolve() (shared URL handle)
+//   g++ -std=c++17 -O2 -pthread bench/redirect_bench.cpp core/*.cpp -o redirect_bench
+//   ./redirect_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+// Every operator new in the process is counted (this program only)
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static int64_t currentMinute() {
+    return std::chrono::duration_cast<std::chrono::minutes>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Allocations per call of fn over every code, `rounds` times. Analytics
+// starts a new per-thread batch each minute, so a run that crosses a
+// minute boundary is repeated.
+template <typename Fn>
+static double allocationsPerCall(const std::vector<std::string>& codes, int rounds, Fn fn) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        int64_t minute = currentMinute();
+        size_t found = 0;
+        uint64_t before = allocations.load();
+        for (int r = 0; r < rounds; r++) {
+            for (const std::string& code : codes) found += fn(code);
+        }
+        uint64_t after = allocations.load();
+        bench::doNotOptimize(found);
+        if (currentMinute() == minute) return (double)(after - before) / ((double)rounds * codes.size());
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+    const size_t links = 10000;
+    const size_t perThread = 2000000;
+
+    bool ok = true;
+    for (CachePolicy policy : {CachePolicy::LRU, CachePolicy::CLOCK, CachePolicy::TINYLFU}) {
+        ServiceConfig config;
+        config.cacheCapacity = (int)links * 2;
+        config.cachePolicy = policy;
+        config.reaperIntervalMs = 0;
+        UrlShortenerService service(config);
+
+        std::vector<std::string> codes;
+        for (size_t i = 0; i < links; i++) {
+            std::string url = "https://www.example.com/articles/" + std::to_string(i) + "?utm_source=newsletter";
+            // A few long custom aliases too (beyond the small-string buffer)
+            std::string alias = i % 10 == 0 ? "SpringCampaignLandingPage" + std::to_string(i) : "";
+            codes.push_back(service.shortenUrl(url, 0, "", alias));
+        }
+        for (const std::string& code : codes) service.redirect(code);   // warm the cache and analytics
+
+        const char* name = policy == CachePolicy::LRU ? "LRU" : policy == CachePolicy::CLOCK ? "CLOCK" : "TINYLFU";
+        bench::section(std::string("Heap allocations per cache-hit redirect (") + name + ", analytics on)");
+        double viaRedirect = allocationsPerCall(codes, 10, [&](const std::string& c) {
+            return !service.redirect(c).empty();
+        });
+        double viaResolve = allocationsPerCall(codes, 10, [&](const std::string& c) {
+            return !service.resolve(c).empty();
+        });
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  redirect() → std::string   " << viaRedirect << "\n"
+                  << "  resolve()  → UrlHandle     " << viaResolve << "\n";
+        ok &= viaResolve == 0;
+
+        if (policy == CachePolicy::LRU) {
+            bench::section("Cache-hit redirects — M/s (10K links, uniform)");
+            std::cout << "  threads   redirect()   resolve()\n";
+            for (int threads : bench::threadCounts(maxThreads)) {
+                auto rate = [&](bool handle) {
+                    double secs = bench::runThreads(threads, [&](int t) {
+                        std::mt19937_64 rng(t + 1);
+                        size_t bytes = 0;
+                        for (size_t i = 0; i < perThread; i++) {
+                            const std::string& code = codes[rng() % links];
+                            bytes += handle ? service.resolve(code).size() : service.redirect(code).size();
+                        }
+                        bench::doNotOptimize(bytes);
+                    });
+                    return threads * (double)perThread / secs / 1e6;
+                };
+                double a = rate(false);
+                double b = rate(true);
+                std::cout << "  " << std::setw(7) << threads << "   " << std::setprecision(2)
+                          << std::setw(10) << a << "   " << std::setw(9) << b << "\n";
+            }
+        }
+    }
+
+    std::cout << (ok ? "\n  ✅ cache-hit resolve() performs no heap allocation\n"
+                     : "\n  ❌ cache-hit resolve() allocated\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Repository benchmarks
+//   g++ -std=c++17 -O2 -pthread bench/repository_bench.cpp core/*.cpp -o repository_bench
+//   ./repository_bench [entries]
+#include "BenchUtil.h"
+#include "../core/FlatUrlStore.h"
+#include "../core/urlrespository.h"
+#include "../core/Base62Encoder.h"
+#include <malloc.h>
+#include <new>
+#include <unordered_map>
+#include <iomanip>
+#include <filesystem>
+
+// ─────────────────────────────────────────────
+// Heap accounting: live bytes as seen by the allocator
+// ─────────────────────────────────────────────
+static std::atomic<long long> liveBytes{0};
+
+void* operator new(size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    liveBytes.fetch_add((long long)malloc_usable_size(p), std::memory_order_relaxed);
+    return p;
+}
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    liveBytes.fetch_sub((long long)malloc_usable_size(p), std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+// The previous node-based layout, kept here as the baseline
+struct MapEntry {
+    std::string longUrl;
+    std::chrono::steady_clock::time_point expiresAt;
+    bool hasExpiry;
+};
+
+static std::string makeUrl(size_t i) {
+    return "https://www.example.com/articles/" + std::to_string(i * 7919 % 1000003)
+         + "?utm_source=newsletter&id=" + std::to_string(i);
+}
+
+template <class Lookup>
+static double lookupNs(const std::vector<std::string>& codes, Lookup&& lookup) {
+    const size_t probes = 2000000;
+    std::mt19937_64 rng(7);
+    std::vector<uint32_t> order(probes);
+    for (auto& o : order) o = (uint32_t)(rng() % codes.size());
+
+    auto start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (uint32_t o : order) found += lookup(codes[o]);
+    double secs = bench::secondsSince(start);
+    bench::doNotOptimize(found);
+    return secs * 1e9 / probes;
+}
+
+// Write throughput with the log on, snapshot cost, and restart time
+static void persistence(const std::vector<std::string>& codes) {
+    namespace fs = std::filesystem;
+    std::string dir = (fs::temp_directory_path() / "urlshort-bench-data").string();
+    fs::remove_all(dir);
+    size_t entries = codes.size();
+    size_t tail = entries / 10;
+
+    PersistenceOptions options;
+    options.dataDir = dir;
+    options.snapshotEveryOps = 0;   // snapshots are timed explicitly below
+
+    std::cout << std::fixed << std::setprecision(2);
+    {
+        UrlRepository repo;
+        repo.enablePersistence(options);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < entries - tail; i++) repo.save(codes[i], makeUrl(i));
+        double secs = bench::secondsSince(start);
+        std::cout << "  save, group commit (async ack)   "
+                  << (entries - tail) / secs / 1e6 << " M ops/s\n";
+
+        start = std::chrono::steady_clock::now();
+        repo.snapshot();
+        std::cout << "  snapshot of " << repo.size() << " links        "
+                  << bench::secondsSince(start) << " s\n";
+
+        // Log tail that restart has to replay on top of the snapshot
+        for (size_t i = entries - tail; i < entries; i++) repo.save(codes[i], makeUrl(i));
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        UrlRepository repo;
+        repo.enablePersistence(options);
+        std::cout << "  restart (mmap snapshot + " << tail << " log records)  "
+                  << bench::secondsSince(start) << " s, " << repo.size() << " links\n";
+    }
+
+    // Durable acks: concurrent writers share each fdatasync
+    options.waitForDurable = true;
+    {
+        UrlRepository repo;
+        repo.enablePersistence(options);
+        const int threads = 16, perThread = 200;
+        double secs = bench::runThreads(threads, [&](int t) {
+            for (int i = 0; i < perThread; i++) {
+                repo.save("d" + std::to_string(t) + "_" + std::to_string(i), "https://example.com/");
+            }
+        });
+        std::cout << "  save, durable ack, " << threads << " threads      "
+                  << threads * perThread / secs << " ops/s\n";
+    }
+    fs::remove_all(dir);
+}
+
+int main(int argc, char** argv) {
+    size_t entries = argc > 1 ? (size_t)std::atoll(argv[1]) : 1000000;
+
+    std::vector<std::string> codes;
+    codes.reserve(entries);
+    for (size_t i = 1; i <= entries; i++) codes.push_back(Base62Encoder::encode((long long)i * 104729));
+
+    bench::section("UrlRepository store — memory per entry and lookup latency");
+    std::cout << "  entries=" << entries << "\n";
+
+    long long before = liveBytes.load();
+    long long mapBytes = 0;
+    double mapNs = 0;
+    {
+        std::unordered_map<std::string, MapEntry> store;
+        for (size_t i = 0; i < entries; i++) store[codes[i]] = MapEntry{makeUrl(i), {}, false};
+        mapBytes = liveBytes.load() - before;
+        mapNs = lookupNs(codes, [&](const std::string& c) {
+            auto it = store.find(c);
+            return it != store.end() ? it->second.longUrl.size() : 0;
+        });
+    }
+
+    before = liveBytes.load();
+    long long flatBytes = 0;
+    double flatNs = 0;
+    {
+        FlatUrlStore store;
+        for (size_t i = 0; i < entries; i++) store.put(codes[i], makeUrl(i), 0);
+        flatBytes = liveBytes.load() - before;
+        std::string url;
+        int64_t expiresAt;
+        flatNs = lookupNs(codes, [&](const std::string& c) {
+            return store.get(c, url, expiresAt) ? url.size() : 0;
+        });
+    }
+
+    size_t urlBytes = 0;
+    for (size_t i = 0; i < entries; i++) urlBytes += makeUrl(i).size();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  average URL length      " << (double)urlBytes / entries << " bytes\n\n";
+    std::cout << "  backend          bytes/entry   lookup ns/op\n";
+    std::cout << "  unordered_map    " << std::setw(11) << (double)mapBytes / entries
+              << "   " << std::setw(12) << mapNs << "\n";
+    std::cout << "  FlatUrlStore     " << std::setw(11) << (double)flatBytes / entries
+              << "   " << std::setw(12) << flatNs << "\n";
+
+    bench::section("Persistence — write-ahead log, snapshot, restart");
+    persistence(codes);
+    return 0;
+}
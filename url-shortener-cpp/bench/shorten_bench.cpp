@@ -0,0 +1,135 @@
+// Shorten-path benchmarks
+//   g++ -std=c++17 -O2 -pthread bench/shorten_bench.cpp core/*.cpp -o shorten_bench
+//   ./shorten_bench [maxThreads]
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include <iomanip>
+
+static std::vector<std::string> makeUrls(size_t n) {
+    std::vector<std::string> urls;
+    urls.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        urls.push_back("https://import.example.com/catalog/item/" + std::to_string(i));
+    }
+    return urls;
+}
+
+// Per-call shortenUrl vs. shortenBatch, same URLs split across threads
+static void perCallVsBatch(int maxThreads) {
+    const int perThread = 200000;
+    const int batchSize = 1000;
+
+    std::cout << "  threads   per-call M/s   batch(" << batchSize << ") M/s\n";
+    for (int threads : bench::threadCounts(maxThreads)) {
+        std::vector<std::string> urls = makeUrls((size_t)perThread * threads);
+
+        double perCall, batched;
+        {
+            ServiceConfig config;
+            config.reaperIntervalMs = 0;
+            UrlShortenerService service(config);
+            double secs = bench::runThreads(threads, [&](int t) {
+                for (int i = 0; i < perThread; i++) service.shortenUrl(urls[(size_t)t * perThread + i]);
+            });
+            perCall = threads * (double)perThread / secs / 1e6;
+        }
+        {
+            // Requests are built up front, as an import job would have them
+            std::vector<std::vector<ShortenRequest>> batches;
+            for (size_t i = 0; i < urls.size(); i += batchSize) {
+                batches.emplace_back(batchSize);
+                for (int j = 0; j < batchSize; j++) batches.back()[j].longUrl = urls[i + j];
+            }
+            size_t batchesPerThread = perThread / batchSize;
+
+            ServiceConfig config;
+            config.reaperIntervalMs = 0;
+            UrlShortenerService service(config);
+            double secs = bench::runThreads(threads, [&](int t) {
+                for (size_t b = 0; b < batchesPerThread; b++) {
+                    auto results = service.shortenBatch(batches[t * batchesPerThread + b]);
+                    bench::doNotOptimize(results);
+                }
+            });
+            batched = threads * (double)perThread / secs / 1e6;
+        }
+        std::cout << "  " << std::setw(7) << threads << "   " << std::fixed << std::setprecision(2)
+                  << std::setw(12) << perCall << "   " << std::setw(15) << batched << "\n";
+    }
+}
+
+// Clients re-shortening a working set: Zipfian picks from `unique` URLs.
+// Storage and throughput with the dedup index off vs. on; returns false if
+// a returned code does not redirect to its URL or dedup stored duplicates.
+static bool duplicateHeavy(int maxThreads) {
+    const size_t unique = 200000;
+    const size_t perThread = 1000000;
+    std::vector<std::string> urls = makeUrls(unique);
+    bench::Zipf zipf(unique, 0.9);
+    bool ok = true;
+
+    std::cout << "  dedup  threads   M shortens/s   links stored   storage MB   bytes/request\n";
+    for (bool dedup : {false, true}) {
+        for (int threads : bench::threadCounts(maxThreads)) {
+            ServiceConfig config;
+            config.reaperIntervalMs = 0;
+            config.dedup = dedup;
+            UrlShortenerService service(config);
+            std::vector<char> seen(unique, 0);
+            std::vector<std::vector<std::pair<size_t, std::string>>> samples(threads);
+            double secs = bench::runThreads(threads, [&](int t) {
+                std::mt19937_64 rng(t + 1);
+                for (size_t i = 0; i < perThread; i++) {
+                    size_t u = zipf(rng);
+                    std::string code = service.shortenUrl(urls[u]);
+                    if (i % 1000 == 0) samples[t].emplace_back(u, std::move(code));
+                }
+            });
+            for (int t = 0; t < threads; t++) {
+                std::mt19937_64 rng(t + 1);
+                for (size_t i = 0; i < perThread; i++) seen[zipf(rng)] = 1;
+            }
+            size_t distinct = std::count(seen.begin(), seen.end(), 1);
+            for (const auto& thread : samples) {
+                for (const auto& [u, code] : thread) ok &= service.redirect(code) == urls[u];
+            }
+            // Racing first requests may each create a link; allow a few
+            size_t links = service.urlCount();
+            if (dedup) ok &= links >= distinct && links <= distinct + distinct / 100;
+            size_t requests = perThread * threads;
+            std::cout << "  " << std::setw(5) << (dedup ? "on" : "off") << "  " << std::setw(7) << threads
+                      << "   " << std::fixed << std::setprecision(2) << std::setw(12)
+                      << requests / secs / 1e6 << "   " << std::setw(12) << links << "   "
+                      << std::setw(10) << service.storageBytes() / 1e6 << "   " << std::setw(13)
+                      << (double)service.storageBytes() / requests << "\n";
+        }
+    }
+
+    // TTL and alias requests never share a link, and are never reused
+    ServiceConfig config;
+    config.reaperIntervalMs = 0;
+    config.dedup = true;
+    UrlShortenerService service(config);
+    std::string plain = service.shortenUrl(urls[0]);
+    std::string expiring = service.shortenUrl(urls[0], 3600);
+    std::string alias = service.shortenUrl(urls[0], 0, "", "dedupAlias");
+    ok &= service.shortenUrl(urls[0]) == plain && expiring != plain && alias == "dedupAlias" &&
+          service.shortenUrl(urls[0], 3600) != expiring && service.urlCount() == 4;
+    std::vector<ShortenRequest> batch = {{urls[0], 0, ""}, {urls[1], 0, ""}, {urls[1], 0, ""}, {urls[0], 60, ""}};
+    auto results = service.shortenBatch(batch);
+    ok &= results[0].shortCode == plain && results[1].shortCode == results[2].shortCode &&
+          results[3].shortCode != expiring && service.redirect(results[1].shortCode) == urls[1] &&
+          service.urlCount() == 6;
+
+    std::cout << (ok ? "  ✅ every code redirects to its URL; one link per URL with dedup; TTL/alias links kept apart\n"
+                     : "  ❌ dedup check failed\n");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = bench::maxThreadsArg(argc, argv);
+    bench::section("Shorten throughput — shortenUrl vs. shortenBatch");
+    perCallVsBatch(maxThreads);
+    bench::section("Duplicate-heavy shortening — 200K URLs, Zipf 0.9");
+    return duplicateHeavy(maxThreads) ? 0 : 1;
+}
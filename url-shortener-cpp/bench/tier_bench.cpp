@@ -0,0 +1,210 @@
+// Tiered storage: resident memory and redirect latency vs corpus size, with
+// every link in memory vs idle links demoted to the on-disk cold tier
+//   g++ -std=c++17 -O2 -pthread bench/tier_bench.cpp core/*.cpp -o tier_bench
+//   ./tier_bench [maxLinks]
+//
+// Each configuration runs in its own process so RSS is not shared. 5% of
+// the links are hot; the redirect mix is 99% hot (Zipf) and 1% uniform over
+// every link. Cold table pages are dropped from the page cache before
+// timing, so cold hits pay for real reads.
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <malloc.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t CODE_WIDTH = 16;
+constexpr size_t HOT_EVERY  = 20;       // every 20th link is hot (5%)
+
+std::string makeUrl(size_t i) {
+    return "https://www.example.com/articles/" + std::to_string(i * 7919 % 1000003)
+         + "?utm_source=newsletter&campaign=spring&id=" + std::to_string(i);
+}
+
+size_t rssBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) return std::stoull(line.substr(6)) * 1024;
+    }
+    return 0;
+}
+
+void dropPageCache(const std::string& dir) {
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(dir, ec)) {
+        int fd = ::open(entry.path().c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+// Codes packed at a fixed width, allocated before the baseline RSS reading
+struct Codes {
+    std::vector<char> bytes;
+    explicit Codes(size_t n) : bytes(n * CODE_WIDTH, '\0') {}
+    void set(size_t i, const std::string& code) { std::memcpy(&bytes[i * CODE_WIDTH], code.data(), code.size()); }
+    std::string_view get(size_t i) const {
+        const char* p = &bytes[i * CODE_WIDTH];
+        return std::string_view(p, strnlen(p, CODE_WIDTH));
+    }
+};
+
+// One configuration; prints its table row and returns the exit status
+int runConfig(size_t links, bool tiered, const std::string& dir) {
+    Codes codes(links);
+    size_t baseline = rssBytes();
+
+    ServiceConfig config;
+    config.cacheCapacity = 10000;
+    config.reaperIntervalMs = 0;
+    config.analytics = false;           // measure storage, not click counters
+    if (tiered) config.coldTier.dir = dir;
+    UrlShortenerService service(config);
+
+    std::vector<ShortenRequest> batch(1000);
+    for (size_t start = 0; start < links; start += batch.size()) {
+        size_t n = std::min(batch.size(), links - start);
+        batch.resize(n);
+        for (size_t k = 0; k < n; k++) batch[k].longUrl = makeUrl(start + k);
+        std::vector<ShortenResult> results = service.shortenBatch(batch);
+        for (size_t k = 0; k < n; k++) codes.set(start + k, results[k].shortCode);
+    }
+
+    // A pass to start a demotion period, traffic to the hot links, then the
+    // pass that demotes everything else
+    service.demoteIdle();
+    for (size_t i = 0; i < links; i += HOT_EVERY) service.resolve(codes.get(i));
+    service.demoteIdle();
+    malloc_trim(0);
+    if (tiered) dropPageCache(dir);
+    size_t rss = rssBytes() - baseline;
+
+    // Timed redirects: 99% Zipf over the hot links, 1% uniform over all
+    size_t hotLinks = (links + HOT_EVERY - 1) / HOT_EVERY;
+    bench::Zipf zipf(hotLinks, 0.99);
+    std::mt19937_64 rng(42);
+    bench::Histogram all, cold;
+    const size_t probes = 200000;
+    size_t found = 0;
+    for (size_t p = 0; p < probes; p++) {
+        bool uniform = rng() % 100 == 0;
+        size_t i = uniform ? rng() % links : zipf(rng) * HOT_EVERY;
+        auto start = std::chrono::steady_clock::now();
+        found += !service.resolve(codes.get(i)).empty();
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        all.record(ns);
+        if (uniform && i % HOT_EVERY != 0) cold.record(ns);
+    }
+
+    // Every link still resolves to its own URL
+    bool ok = found == probes;
+    for (size_t i = 0; i < links && ok; i++) ok = service.resolve(codes.get(i)).view() == makeUrl(i);
+
+    std::cout << "  " << std::setw(9) << links << "   " << std::setw(4) << (tiered ? "on" : "off")
+              << "   " << std::setw(8) << std::fixed << std::setprecision(1) << rss / 1048576.0
+              << "   " << std::setw(9) << service.coldCount()
+              << "   " << std::setw(7) << std::setprecision(2) << all.percentile(0.50) / 1000.0
+              << "   " << std::setw(7) << all.percentile(0.99) / 1000.0
+              << "   " << std::setw(8) << all.percentile(0.999) / 1000.0
+              << "   " << std::setw(12) << (cold.count() ? cold.percentile(0.99) / 1000.0 : 0.0)
+              << (ok ? "" : "   ❌ wrong URL") << std::endl;   // the child ends with _Exit
+    return ok ? 0 : 1;
+}
+
+// Deletes, overwrites, merges and a restart against the repository directly
+bool checkSemantics(const std::string& dir) {
+    PersistenceOptions persistence;
+    persistence.dataDir = dir + "/data";
+    persistence.snapshotEveryOps = 0;
+    ColdTierOptions tier;
+    tier.dir = dir + "/cold";
+    tier.maxTables = 2;
+
+    const size_t n = 20000;
+    auto code = [](size_t i) { return "c" + std::to_string(i); };
+    auto expected = [&](size_t i) -> std::string {
+        if (i % 7 == 0) return "";                                  // removed while cold
+        if (i % 11 == 0) return makeUrl(i) + "#v2";                 // overwritten while cold
+        return makeUrl(i);
+    };
+    auto matches = [&](UrlRepository& repo) {
+        for (size_t i = 0; i < n; i++) {
+            if (repo.find(code(i)) != expected(i) || repo.exists(code(i)) != !expected(i).empty()) return false;
+        }
+        return true;
+    };
+
+    bool ok;
+    {
+        UrlRepository repo;
+        repo.enablePersistence(persistence);
+        repo.enableColdTier(tier);
+        for (size_t i = 0; i < n; i++) repo.save(code(i), makeUrl(i));
+        repo.demoteIdle();
+        repo.demoteIdle();                                          // first table
+        for (size_t i = 0; i < n; i += 7) repo.remove(code(i));
+        for (size_t i = 11; i < n; i += 11) {
+            if (i % 7 != 0) repo.save(code(i), makeUrl(i) + "#v2");
+        }
+        ok = repo.size() == n / 11 - n / 77 && matches(repo);
+        repo.demoteIdle();
+        repo.demoteIdle();                                          // overwrites: second table
+        repo.snapshot();
+        for (size_t i = 0; i < n; i += 3) repo.find(code(i));      // promote a third
+        repo.demoteIdle();
+        repo.demoteIdle();                                          // third table → merge
+        ok = ok && matches(repo);
+    }
+    {
+        UrlRepository repo;
+        repo.enablePersistence(persistence);
+        repo.enableColdTier(tier);
+        ok = ok && matches(repo);
+    }
+    std::cout << "  removes, overwrites, promotion, merge, restart   " << (ok ? "✅" : "❌") << "\n";
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t maxLinks = argc > 1 ? std::stoull(argv[1]) : 4000000;
+    std::string dir = (fs::temp_directory_path() / ("tier_bench_" + std::to_string(::getpid()))).string();
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    bench::section("Cold tier semantics");
+    bool ok = checkSemantics(dir + "/semantics");
+
+    bench::section("Resident memory and redirect latency (µs), 5% hot links");
+    std::cout << "      links   tier   RSS (MB)   cold rows       p50       p99      p99.9   cold p99\n";
+    for (size_t links = 250000; links <= maxLinks; links *= 4) {
+        for (bool tiered : {false, true}) {
+            std::string configDir = dir + "/" + std::to_string(links);
+            std::cout.flush();
+            pid_t child = ::fork();
+            if (child == 0) std::_Exit(runConfig(links, tiered, configDir));
+            int status = 0;
+            ::waitpid(child, &status, 0);
+            ok &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            fs::remove_all(configDir, ec);
+        }
+    }
+    fs::remove_all(dir, ec);
+
+    std::cout << (ok ? "\n  ✅ every link resolves to its URL in both tiers\n"
+                     : "\n  ❌ a link was lost or resolved wrongly\n");
+    return ok ? 0 : 1;
+}
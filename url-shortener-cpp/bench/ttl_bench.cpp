@@ -0,0 +1,49 @@
+// TTL reaper benchmark: memory under a workload of mostly short-TTL links
+//   g++ -std=c++17 -O2 -pthread bench/ttl_bench.cpp core/*.cpp -o ttl_bench
+//   ./ttl_bench [seconds]
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+// Resident set size in MiB
+static double rssMiB() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * (double)sysconf(_SC_PAGESIZE) / (1 << 20);
+}
+
+// Shorten continuously for `seconds`; 99% of links live for 1 second
+static void run(int reaperIntervalMs, int seconds) {
+    ServiceConfig config;
+    config.reaperIntervalMs = reaperIntervalMs;
+    UrlShortenerService service(config);
+
+    std::cout << "  sec   links stored   RSS MiB\n";
+    auto start = std::chrono::steady_clock::now();
+    long long created = 0;
+    for (int sec = 1; sec <= seconds; sec++) {
+        while (bench::secondsSince(start) < sec) {
+            for (int i = 0; i < 1000; i++, created++) {
+                int ttl = created % 100 == 0 ? 0 : 1;
+                service.shortenUrl("https://promo.example.com/flash-sale?id=" + std::to_string(created), ttl);
+            }
+        }
+        std::cout << "  " << std::setw(3) << sec << "   " << std::setw(12) << service.urlCount()
+                  << "   " << std::fixed << std::setprecision(1) << std::setw(7) << rssMiB() << "\n";
+    }
+    std::cout << "  created " << created << " links\n";
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 8;
+
+    bench::section("Short-TTL workload — lazy expiry only (no reaper)");
+    run(0, seconds);
+
+    bench::section("Short-TTL workload — timing-wheel reaper every 100 ms");
+    run(100, seconds);
+    return 0;
+}
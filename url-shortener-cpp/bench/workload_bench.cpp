@@ -0,0 +1,467 @@
+// Workload harness: drives UrlShortenerService from M threads with a
+// replayed JSONL trace or a synthetic shorten/redirect mix, and prints
+// throughput, latency percentiles and cache hit ratio as JSON.
+//   g++ -std=c++17 -O2 -pthread bench/workload_bench.cpp core/*.cpp -o workload_bench
+//   ./workload_bench [--threads 1,4,16] [--ops N] [--keys N] [--reads 0.9]
+//                    [--dist zipf|uniform] [--zipf-s 0.99] [--ttl-ratio R] [--ttl S]
+//                    [--alias-ratio R] [--seed N] [--trace FILE]
+//                    [--cache N] [--cache-policy lru|clock|tinylfu] [--ring ring|jump|maglev|rendezvous]
+//                    [--nodes N] [--dedup] [--no-analytics] [--out FILE]
+//
+// Trace lines are flat JSON objects; other lines are counted and skipped:
+//   {"op":"shorten","url":"https://...","ttl":60,"alias":"promo"}
+//   {"op":"redirect","code":"abc"}
+//   {"op":"redirect","ref":12}     code returned by the trace's 13th shorten
+// Trace operations go to threads round-robin; a redirect by "ref" waits
+// until that shorten has run, so every replay resolves the same codes.
+#include "BenchUtil.h"
+#include "../core/urlshortenerservice.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace {
+
+struct Options {
+    std::vector<int> threads;
+    size_t ops = 2000000;
+    size_t keys = 100000;
+    double reads = 0.9;
+    bool zipf = true;
+    double zipfS = 0.99;
+    double ttlRatio = 0;
+    int ttlSeconds = 3600;
+    double aliasRatio = 0;
+    uint64_t seed = 1;
+    std::string trace;
+    std::string out;
+    ServiceConfig service;
+    int nodes = 0;
+};
+
+enum class OpKind { Shorten, Redirect };
+
+struct Op {
+    OpKind kind;
+    std::string text;        // long URL, or short code
+    int ttlSeconds = 0;
+    std::string alias;
+    long long ref = -1;      // redirect: index into the trace's shortens
+    long long shortenIndex = -1;
+};
+
+// ── Trace parsing ──
+
+void skipSpaces(const std::string& s, size_t& i) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r')) i++;
+}
+
+bool readString(const std::string& s, size_t& i, std::string& out) {
+    if (i >= s.size() || s[i] != '"') return false;
+    out.clear();
+    for (i++; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"') {
+            i++;
+            return true;
+        }
+        if (c == '\\') {
+            if (++i >= s.size()) return false;
+            char e = s[i];
+            out += e == 'n' ? '\n' : e == 't' ? '\t' : e == 'r' ? '\r' : e;   // \uXXXX kept verbatim
+        } else {
+            out += c;
+        }
+    }
+    return false;
+}
+
+// Flat object of string / number / literal values
+bool parseObject(const std::string& line, std::map<std::string, std::string>& fields) {
+    size_t i = 0;
+    skipSpaces(line, i);
+    if (i >= line.size() || line[i++] != '{') return false;
+    for (;;) {
+        skipSpaces(line, i);
+        if (i < line.size() && line[i] == '}') return true;
+        std::string key, value;
+        if (!readString(line, i, key)) return false;
+        skipSpaces(line, i);
+        if (i >= line.size() || line[i++] != ':') return false;
+        skipSpaces(line, i);
+        if (i < line.size() && line[i] == '"') {
+            if (!readString(line, i, value)) return false;
+        } else {
+            size_t start = i;
+            while (i < line.size() && line[i] != ',' && line[i] != '}') i++;
+            value = line.substr(start, i - start);
+            while (!value.empty() && value.back() == ' ') value.pop_back();
+            if (value.empty() || value[0] == '{' || value[0] == '[') return false;
+        }
+        fields[key] = value;
+        skipSpaces(line, i);
+        if (i < line.size() && line[i] == ',') {
+            i++;
+            continue;
+        }
+        return i < line.size() && line[i] == '}';
+    }
+}
+
+bool loadTrace(const std::string& path, std::vector<Op>& ops, size_t& skipped) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    long long shortens = 0;
+    std::map<std::string, std::string> f;
+    while (std::getline(in, line)) {
+        f.clear();
+        if (!parseObject(line, f)) {
+            skipped++;
+            continue;
+        }
+        Op op;
+        if (f["op"] == "shorten" && !f["url"].empty()) {
+            op.kind = OpKind::Shorten;
+            op.text = f["url"];
+            op.ttlSeconds = std::atoi(f["ttl"].c_str());
+            op.alias = f["alias"];
+            op.shortenIndex = shortens++;
+        } else if (f["op"] == "redirect" && (!f["code"].empty() || !f["ref"].empty())) {
+            op.kind = OpKind::Redirect;
+            op.text = f["code"];
+            if (op.text.empty()) op.ref = std::atoll(f["ref"].c_str());
+            if (op.ref >= shortens) {   // must refer back
+                skipped++;
+                continue;
+            }
+        } else {
+            skipped++;
+            continue;
+        }
+        ops.push_back(std::move(op));
+    }
+    return true;
+}
+
+// ── Synthetic mix ──
+
+std::string syntheticUrl(uint64_t n) {
+    return "https://shop.example.com/products/" + std::to_string(n * 2654435761ULL % 100000007) +
+           "?ref=campaign&item=" + std::to_string(n);
+}
+
+// Per-thread op list, fixed by seed + thread index. Redirects pick one of
+// the `keys` preloaded codes.
+std::vector<Op> syntheticOps(const Options& o, int thread, int threads,
+                             const std::vector<std::string>& codes, const bench::Zipf* zipf) {
+    std::mt19937_64 rng(o.seed * 1000003 + thread);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t n = o.ops / threads + (thread < (int)(o.ops % threads) ? 1 : 0);
+    std::vector<Op> ops;
+    ops.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        Op op;
+        if (unit(rng) < o.reads && !codes.empty()) {
+            op.kind = OpKind::Redirect;
+            op.text = codes[zipf ? (*zipf)(rng) : rng() % codes.size()];
+        } else {
+            op.kind = OpKind::Shorten;
+            op.text = syntheticUrl(o.keys + (uint64_t)thread * o.ops + i);
+            if (unit(rng) < o.ttlRatio) op.ttlSeconds = o.ttlSeconds;
+            if (unit(rng) < o.aliasRatio) op.alias = "w" + std::to_string(thread) + "x" + std::to_string(i);
+        }
+        ops.push_back(std::move(op));
+    }
+    return ops;
+}
+
+// ── Running ──
+
+struct ThreadResult {
+    bench::Histogram shorten, redirect;
+    size_t failedShortens = 0;
+    size_t notFound = 0;
+};
+
+struct RunResult {
+    int threads = 0;
+    double seconds = 0;
+    bench::Histogram shorten, redirect, all;
+    size_t failedShortens = 0, notFound = 0;
+    CacheStats cache;
+    size_t links = 0;
+};
+
+void configureService(const Options& o, UrlShortenerService& service) {
+    for (int n = 1; n <= o.nodes; n++) service.addNode(n);
+    service.waitForRebalance();
+}
+
+RunResult run(const Options& o, int threads, const std::vector<Op>* trace) {
+    UrlShortenerService service(o.service);
+    configureService(o, service);
+
+    // Synthetic runs start from `keys` existing links (not timed)
+    std::vector<std::string> codes;
+    std::vector<std::vector<Op>> perThread(threads);
+    if (!trace) {
+        std::vector<ShortenRequest> batch;
+        for (size_t i = 0; i < o.keys; i++) {
+            batch.push_back({syntheticUrl(i), 0, ""});
+            if (batch.size() == 1024 || i + 1 == o.keys) {
+                for (const ShortenResult& r : service.shortenBatch(batch)) codes.push_back(r.shortCode);
+                batch.clear();
+            }
+        }
+        std::unique_ptr<bench::Zipf> zipf;
+        if (o.zipf && !codes.empty()) zipf = std::make_unique<bench::Zipf>(codes.size(), o.zipfS);
+        for (int t = 0; t < threads; t++) perThread[t] = syntheticOps(o, t, threads, codes, zipf.get());
+    }
+
+    // Trace: op i runs on thread i % threads; shortened codes are published
+    // for "ref" redirects
+    size_t shortens = 0;
+    if (trace) {
+        for (const Op& op : *trace) shortens += op.kind == OpKind::Shorten;
+    }
+    std::vector<std::string> traceCodes(shortens);
+    std::unique_ptr<std::atomic<bool>[]> published(new std::atomic<bool>[shortens]);
+    for (size_t i = 0; i < shortens; i++) published[i].store(false, std::memory_order_relaxed);
+
+    std::vector<ThreadResult> results(threads);
+    auto execute = [&](const Op& op, ThreadResult& r) {
+        std::string code;
+        if (op.kind == OpKind::Redirect && op.ref >= 0) {
+            while (!published[op.ref].load(std::memory_order_acquire)) std::this_thread::yield();
+            code = traceCodes[op.ref];
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (op.kind == OpKind::Shorten) {
+            std::string result = service.shortenUrl(op.text, op.ttlSeconds, "", op.alias);
+            r.shorten.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            r.failedShortens += result.empty();
+            if (op.shortenIndex >= 0) {
+                traceCodes[op.shortenIndex] = std::move(result);
+                published[op.shortenIndex].store(true, std::memory_order_release);
+            }
+        } else {
+            bool found = !service.redirect(op.ref >= 0 ? code : op.text).empty();
+            r.redirect.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            r.notFound += !found;
+        }
+    };
+
+    CacheStats before = service.cacheStats();
+    RunResult out;
+    out.threads = threads;
+    out.seconds = bench::runThreads(threads, [&](int t) {
+        if (trace) {
+            for (size_t i = t; i < trace->size(); i += threads) execute((*trace)[i], results[t]);
+        } else {
+            for (const Op& op : perThread[t]) execute(op, results[t]);
+        }
+    });
+    CacheStats after = service.cacheStats();
+    out.cache.hits = after.hits - before.hits;
+    out.cache.misses = after.misses - before.misses;
+    out.links = service.urlCount();
+
+    for (const ThreadResult& r : results) {
+        out.shorten.merge(r.shorten);
+        out.redirect.merge(r.redirect);
+        out.failedShortens += r.failedShortens;
+        out.notFound += r.notFound;
+    }
+    out.all.merge(out.shorten);
+    out.all.merge(out.redirect);
+    return out;
+}
+
+// ── JSON output ──
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string latencyJson(const bench::Histogram& h) {
+    std::ostringstream j;
+    j << "{\"count\": " << h.count() << ", \"p50_ns\": " << h.percentile(0.50)
+      << ", \"p99_ns\": " << h.percentile(0.99) << ", \"p999_ns\": " << h.percentile(0.999)
+      << ", \"max_ns\": " << h.max() << "}";
+    return j.str();
+}
+
+// Non-empty buckets as [upper bound ns, count]
+std::string bucketsJson(const bench::Histogram& h) {
+    std::ostringstream j;
+    j << "[";
+    bool first = true;
+    for (size_t i = 0; i < h.buckets().size(); i++) {
+        if (h.buckets()[i] == 0) continue;
+        j << (first ? "" : ", ") << "[" << bench::Histogram::upperBound(i) << ", " << h.buckets()[i] << "]";
+        first = false;
+    }
+    return j.str() + "]";
+}
+
+std::string runJson(const RunResult& r) {
+    uint64_t lookups = r.cache.hits + r.cache.misses;
+    std::ostringstream j;
+    j << "    {\n"
+      << "      \"threads\": " << r.threads << ",\n"
+      << "      \"seconds\": " << r.seconds << ",\n"
+      << "      \"ops_per_sec\": " << (r.seconds > 0 ? r.all.count() / r.seconds : 0) << ",\n"
+      << "      \"latency\": " << latencyJson(r.all) << ",\n"
+      << "      \"shorten\": " << latencyJson(r.shorten) << ",\n"
+      << "      \"redirect\": " << latencyJson(r.redirect) << ",\n"
+      << "      \"failed_shortens\": " << r.failedShortens << ",\n"
+      << "      \"redirects_not_found\": " << r.notFound << ",\n"
+      << "      \"cache\": {\"hits\": " << r.cache.hits << ", \"misses\": " << r.cache.misses
+      << ", \"hit_ratio\": " << (lookups ? (double)r.cache.hits / lookups : 0) << "},\n"
+      << "      \"links_stored\": " << r.links << ",\n"
+      << "      \"histogram_ns\": " << bucketsJson(r.all) << "\n"
+      << "    }";
+    return j.str();
+}
+
+const char* policyName(CachePolicy p) {
+    return p == CachePolicy::CLOCK ? "clock" : p == CachePolicy::TINYLFU ? "tinylfu" : "lru";
+}
+
+const char* ringName(HashAlgorithm a) {
+    switch (a) {
+        case HashAlgorithm::Jump:       return "jump";
+        case HashAlgorithm::Maglev:     return "maglev";
+        case HashAlgorithm::Rendezvous: return "rendezvous";
+        default:                        return "ring";
+    }
+}
+
+std::string configJson(const Options& o, size_t traceOps, size_t skipped) {
+    std::ostringstream j;
+    j << "  \"config\": {\n";
+    if (!o.trace.empty()) {
+        j << "    \"trace\": " << jsonString(o.trace) << ",\n"
+          << "    \"trace_ops\": " << traceOps << ",\n"
+          << "    \"trace_lines_skipped\": " << skipped << ",\n";
+    } else {
+        j << "    \"ops\": " << o.ops << ",\n"
+          << "    \"keys\": " << o.keys << ",\n"
+          << "    \"read_ratio\": " << o.reads << ",\n"
+          << "    \"distribution\": \"" << (o.zipf ? "zipf" : "uniform") << "\",\n"
+          << "    \"zipf_s\": " << o.zipfS << ",\n"
+          << "    \"ttl_ratio\": " << o.ttlRatio << ",\n"
+          << "    \"ttl_seconds\": " << o.ttlSeconds << ",\n"
+          << "    \"alias_ratio\": " << o.aliasRatio << ",\n"
+          << "    \"seed\": " << o.seed << ",\n";
+    }
+    j << "    \"cache_capacity\": " << o.service.cacheCapacity << ",\n"
+      << "    \"cache_policy\": \"" << policyName(o.service.cachePolicy) << "\",\n"
+      << "    \"ring\": \"" << ringName(o.service.ringAlgorithm) << "\",\n"
+      << "    \"nodes\": " << o.nodes << ",\n"
+      << "    \"dedup\": " << (o.service.dedup ? "true" : "false") << ",\n"
+      << "    \"analytics\": " << (o.service.analytics ? "true" : "false") << "\n"
+      << "  }";
+    return j.str();
+}
+
+std::vector<int> parseThreads(const std::string& list) {
+    std::vector<int> out;
+    std::stringstream in(list);
+    std::string part;
+    while (std::getline(in, part, ',')) {
+        int n = std::atoi(part.c_str());
+        if (n > 0) out.push_back(n);
+    }
+    return out;
+}
+
+bool parseArgs(int argc, char** argv, Options& o) {
+    o.service.reaperIntervalMs = 100;
+    o.service.cacheCapacity = 10000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        std::string v = hasValue ? argv[i + 1] : "";
+        if (arg == "--threads" && hasValue) o.threads = parseThreads(argv[++i]);
+        else if (arg == "--ops" && hasValue) o.ops = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--keys" && hasValue) o.keys = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--reads" && hasValue) o.reads = std::atof(argv[++i]);
+        else if (arg == "--dist" && hasValue) o.zipf = std::string(argv[++i]) != "uniform";
+        else if (arg == "--zipf-s" && hasValue) o.zipfS = std::atof(argv[++i]);
+        else if (arg == "--ttl-ratio" && hasValue) o.ttlRatio = std::atof(argv[++i]);
+        else if (arg == "--ttl" && hasValue) o.ttlSeconds = std::atoi(argv[++i]);
+        else if (arg == "--alias-ratio" && hasValue) o.aliasRatio = std::atof(argv[++i]);
+        else if (arg == "--seed" && hasValue) o.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--trace" && hasValue) o.trace = argv[++i];
+        else if (arg == "--out" && hasValue) o.out = argv[++i];
+        else if (arg == "--cache" && hasValue) o.service.cacheCapacity = std::atoi(argv[++i]);
+        else if (arg == "--cache-policy" && hasValue) {
+            o.service.cachePolicy = v == "clock"   ? CachePolicy::CLOCK
+                                  : v == "tinylfu" ? CachePolicy::TINYLFU : CachePolicy::LRU;
+            i++;
+        } else if (arg == "--ring" && hasValue) {
+            o.service.ringAlgorithm = v == "jump"       ? HashAlgorithm::Jump
+                                    : v == "maglev"     ? HashAlgorithm::Maglev
+                                    : v == "rendezvous" ? HashAlgorithm::Rendezvous
+                                                        : HashAlgorithm::Ring;
+            i++;
+        } else if (arg == "--nodes" && hasValue) o.nodes = std::atoi(argv[++i]);
+        else if (arg == "--dedup") o.service.dedup = true;
+        else if (arg == "--no-analytics") o.service.analytics = false;
+        else return false;
+    }
+    if (o.threads.empty()) o.threads = bench::threadCounts();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parseArgs(argc, argv, o)) {
+        std::cerr << "usage: see the comment at the top of bench/workload_bench.cpp\n";
+        return 2;
+    }
+
+    std::vector<Op> trace;
+    size_t skipped = 0;
+    if (!o.trace.empty() && !loadTrace(o.trace, trace, skipped)) {
+        std::cerr << "cannot read trace " << o.trace << "\n";
+        return 1;
+    }
+
+    std::ostringstream json;
+    json << "{\n" << configJson(o, trace.size(), skipped) << ",\n  \"runs\": [\n";
+    for (size_t k = 0; k < o.threads.size(); k++) {
+        RunResult r = run(o, o.threads[k], o.trace.empty() ? nullptr : &trace);
+        json << runJson(r) << (k + 1 < o.threads.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+
+    if (o.out.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream file(o.out);
+        file << json.str();
+        if (!file) {
+            std::cerr << "cannot write " << o.out << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -1,33 +1,281 @@
 #include "AnalyticsTracker.h"
+#include <chrono>
+#include <cstring>
 
-void AnalyticsTracker::recordHit(const std::string& shortCode) {
-    std::lock_guard<std::mutex> lock(mtx);
-    hitCounts[shortCode]++;
+namespace {
+
+// The merger folds every shard into the totals this often...
+constexpr int MERGE_INTERVAL_MS = 1000;
+// ...or as soon as a shard holds this many code entries
+constexpr size_t MERGE_SOON_ENTRIES = 1 << 16;
+
+std::atomic<uint64_t> nextInstanceId{1};
+
+struct CachedShard {
+    uint64_t owner = 0;      // AnalyticsTracker::instanceId
+    void* shard = nullptr;
+};
+thread_local CachedShard cachedShard;
+
+int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void appendRaw(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+AnalyticsTracker::AnalyticsTracker(AnalyticsMode mode, size_t topCapacity)
+    : instanceId(nextInstanceId.fetch_add(1)), mode(mode), topCapacity(topCapacity) {
+    if (mode == AnalyticsMode::Exact) mergerThread = std::thread(&AnalyticsTracker::mergerLoop, this);
+}
+
+AnalyticsTracker::~AnalyticsTracker() {
+    {
+        std::lock_guard<std::mutex> lock(mergerMtx);
+        stopMerger = true;
+    }
+    mergerCv.notify_all();
+    if (mergerThread.joinable()) mergerThread.join();
+}
+
+void AnalyticsTracker::mergerLoop() {
+    std::unique_lock<std::mutex> lock(mergerMtx);
+    while (!stopMerger) {
+        mergerCv.wait_for(lock, std::chrono::milliseconds(MERGE_INTERVAL_MS),
+                          [this] { return stopMerger || mergeWanted.load(std::memory_order_relaxed); });
+        if (stopMerger) break;
+        mergeWanted.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> mergeLock(mergeMtx);
+            mergeAll();
+        }
+        lock.lock();
+    }
+}
+
+AnalyticsTracker::Shard& AnalyticsTracker::localShard() {
+    if (cachedShard.owner != instanceId) {
+        std::lock_guard<std::mutex> lock(registryMtx);
+        std::unique_ptr<Shard>& shard = shards[std::this_thread::get_id()];
+        if (!shard) {
+            shard = std::make_unique<Shard>(topCapacity);
+            if (mode == AnalyticsMode::HeavyHitters) shard->sketch = std::make_unique<CountMinSketch>();
+        }
+        cachedShard.owner = instanceId;
+        cachedShard.shard = shard.get();
+    }
+    return *static_cast<Shard*>(cachedShard.shard);
+}
+
+void AnalyticsTracker::drain(Shard& shard) {
+    std::vector<MinuteBatch> taken;
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        taken.swap(shard.batches);
+        shard.pendingEntries = 0;
+    }
+    for (const MinuteBatch& batch : taken) {
+        for (const auto& [code, hits] : batch.counts) {
+            CodeStats& st = stats[code];
+            st.hits += hits;
+            st.series.add(batch.minute, (uint32_t)std::min<long long>(hits, UINT32_MAX));
+        }
+    }
+}
+
+void AnalyticsTracker::mergeAll() {
+    std::vector<Shard*> all;
+    {
+        std::lock_guard<std::mutex> lock(registryMtx);
+        all.reserve(shards.size());
+        for (const auto& entry : shards) all.push_back(entry.second.get());
+    }
+    for (Shard* shard : all) drain(*shard);
+}
+
+void AnalyticsTracker::recordHit(std::string_view shortCode) {
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    Shard& shard = localShard();
+    int64_t minute = shard.sketch ? 0 : nowSeconds() / 60;
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.top.add(shortCode);
+        if (shard.sketch) {
+            shard.sketch->add(shortCode);
+        } else {
+            // Earlier minutes stay queued for the merger
+            if (shard.batches.empty() || shard.batches.back().minute != minute) {
+                shard.batches.push_back({minute, {}});
+            }
+            // Look up through the shard's reused key buffer, so counting a
+            // code already seen this minute allocates nothing
+            shard.scratchKey.assign(shortCode.data(), shortCode.size());
+            if (++shard.batches.back().counts[shard.scratchKey] == 1) {
+                full = ++shard.pendingEntries == MERGE_SOON_ENTRIES;
+            }
+        }
+    }
+    // Only wakes the merger; a wake-up lost to a merger about to wait is
+    // made up by its next tick
+    if (full && !mergeWanted.exchange(true, std::memory_order_relaxed)) mergerCv.notify_one();
 }
 
 long long AnalyticsTracker::getHitCount(const std::string& shortCode) {
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = hitCounts.find(shortCode);
-    if (it == hitCounts.end()) return 0;
-    return it->second;
+    std::lock_guard<std::mutex> lock(mergeMtx);
+    if (mode == AnalyticsMode::HeavyHitters) {
+        std::lock_guard<std::mutex> registryLock(registryMtx);
+        long long total = 0;
+        for (const auto& entry : shards) {
+            std::lock_guard<std::mutex> shardLock(entry.second->mtx);
+            total += (long long)entry.second->sketch->estimate(shortCode);
+        }
+        return total;
+    }
+
+    mergeAll();
+    auto it = stats.find(shortCode);
+    if (it == stats.end()) return 0;
+    return it->second.hits;
 }
 
-void AnalyticsTracker::printReport(int topN) {
-    std::lock_guard<std::mutex> lock(mtx);
+std::vector<HitCount> AnalyticsTracker::topK(int k) {
+    std::lock_guard<std::mutex> lock(mergeMtx);
+    std::vector<Shard*> all;
+    {
+        std::lock_guard<std::mutex> registryLock(registryMtx);
+        for (const auto& entry : shards) all.push_back(entry.second.get());
+    }
+
+    // Sum each candidate over the shards that track it; a shard that does
+    // not can have seen it at most minCount() times
+    std::unordered_map<std::string, HitCount> candidates;
+    long long minSum = 0;
+    std::vector<SpaceSaving::Entry> entries;
+    for (Shard* shard : all) {
+        entries.clear();
+        long long shardMin;
+        {
+            std::lock_guard<std::mutex> shardLock(shard->mtx);
+            shard->top.entries(entries);
+            shardMin = shard->top.minCount();
+        }
+        minSum += shardMin;
+        for (const SpaceSaving::Entry& e : entries) {
+            HitCount& c = candidates[e.key];
+            c.hits += e.count;
+            c.error += e.error - shardMin;   // minSum is added back below
+        }
+    }
+
+    std::vector<HitCount> result;
+    result.reserve(candidates.size());
+    if (mode == AnalyticsMode::Exact) {
+        mergeAll();
+        for (auto& [code, c] : candidates) {
+            auto it = stats.find(code);
+            result.push_back({code, it == stats.end() ? 0 : it->second.hits, 0});
+        }
+    } else {
+        for (auto& [code, c] : candidates) {
+            result.push_back({code, c.hits, c.error + minSum});
+        }
+    }
+
+    size_t n = std::min(result.size(), (size_t)std::max(k, 0));
+    std::partial_sort(result.begin(), result.begin() + n, result.end(),
+                      [](const HitCount& a, const HitCount& b) {
+                          return a.hits != b.hits ? a.hits > b.hits : a.shortCode < b.shortCode;
+                      });
+    result.resize(n);
+    return result;
+}
+
+std::vector<uint32_t> AnalyticsTracker::clickSeries(const std::string& shortCode,
+                                                    SeriesResolution res, int buckets) {
+    buckets = std::max(0, std::min(buckets, ClickSeries::ringSize(res)));
+    std::vector<uint32_t> out(buckets, 0);
+    std::lock_guard<std::mutex> lock(mergeMtx);
+    mergeAll();
+    auto it = stats.find(shortCode);
+    if (it == stats.end()) return out;
+    int64_t first = nowSeconds() / ClickSeries::bucketSeconds(res) - buckets + 1;
+    for (int b = 0; b < buckets; b++) out[b] = it->second.series.at(res, first + b);
+    return out;
+}
+
+std::string AnalyticsTracker::exportSeries(const std::vector<std::string>& codes,
+                                           SeriesResolution res, int buckets) {
+    buckets = std::max(0, std::min(buckets, ClickSeries::ringSize(res)));
+    std::lock_guard<std::mutex> lock(mergeMtx);
+    mergeAll();
+
+    std::vector<std::pair<const std::string*, const CodeStats*>> rows;
+    if (codes.empty()) {
+        rows.reserve(stats.size());
+        for (const auto& [code, st] : stats) rows.emplace_back(&code, &st);
+    } else {
+        rows.reserve(codes.size());
+        for (const std::string& code : codes) {
+            auto it = stats.find(code);
+            rows.emplace_back(&code, it == stats.end() ? nullptr : &it->second);
+        }
+    }
 
-    // Copy to vector for sorting
-    std::vector<std::pair<std::string, long long>> entries(hitCounts.begin(), hitCounts.end());
-    std::sort(entries.begin(), entries.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
+    uint32_t bucketSeconds = (uint32_t)ClickSeries::bucketSeconds(res);
+    int64_t first = nowSeconds() / bucketSeconds - buckets + 1;
+    uint32_t count = (uint32_t)rows.size();
+
+    std::string out;
+    out.append("URLCLK1\0", 8);
+    appendRaw(out, bucketSeconds);
+    appendRaw(out, (uint32_t)buckets);
+    appendRaw(out, first);
+    appendRaw(out, count);
+    appendRaw(out, (uint32_t)0);
+
+    uint32_t offset = 0;
+    appendRaw(out, offset);
+    for (const auto& row : rows) {
+        offset += (uint32_t)row.first->size();
+        appendRaw(out, offset);
+    }
+    for (const auto& row : rows) out += *row.first;
+    out.append((8 - out.size() % 8) % 8, '\0');
+
+    for (const auto& row : rows) appendRaw(out, (uint64_t)(row.second ? row.second->hits : 0));
+
+    size_t countsAt = out.size();
+    out.resize(countsAt + (size_t)count * buckets * sizeof(uint32_t), '\0');
+    char* cell = &out[countsAt];
+    for (const auto& row : rows) {
+        for (int b = 0; b < buckets; b++, cell += sizeof(uint32_t)) {
+            if (!row.second) continue;
+            uint32_t hits = row.second->series.at(res, first + b);
+            std::memcpy(cell, &hits, sizeof(hits));
+        }
+    }
+    return out;
+}
+
+void AnalyticsTracker::printReport(int topN) {
+    std::vector<HitCount> entries = topK(topN);
 
     std::cout << "\n📊 Analytics Report (Top " << topN << " URLs):\n";
     std::cout << "  ┌─────────────┬───────────┐\n";
     std::cout << "  │  Short Code │   Clicks  │\n";
     std::cout << "  ├─────────────┼───────────┤\n";
 
-    int count = 0;
-    for (const auto& [code, hits] : entries) {
-        if (count++ >= topN) break;
+    for (const HitCount& entry : entries) {
+        const std::string& code = entry.shortCode;
+        long long hits = entry.hits;
         std::cout << "  │ " << std::left;
         // Pad short code to 11 chars
         std::string padded = code;
@@ -2,25 +2,139 @@
 #define ANALYTICS_TRACKER_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <memory>
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include "HeavyHitters.h"
+#include "ClickSeries.h"
+
+// How hit counts are kept
+enum class AnalyticsMode {
+    Exact,          // exact per-code totals (memory grows with distinct codes)
+    HeavyHitters    // bounded memory: Space-Saving top-K + Count-Min estimates
+};
+
+// One row of AnalyticsTracker::topK
+struct HitCount {
+    std::string shortCode;
+    long long hits = 0;
+    long long error = 0;      // hits may overcount by up to this much (0 = exact)
+};
 
 // Tracks click counts per short code
+//
+// recordHit() only touches a shard owned by the calling thread, so
+// redirects on different threads never share a lock or a counter, and it
+// never merges: shards are merged into the totals when counts or a report
+// are read, and by a background merger every MERGE_INTERVAL_MS (sooner
+// once a shard fills up) so that idle readers don't let batches pile up.
+//
+// Every shard also keeps a Space-Saving summary updated on each hit, so
+// topK() reads a few bounded summaries instead of sorting every code.
+// Exact mode additionally keeps per-code minute/hour/day click series.
 class AnalyticsTracker {
 private:
-    std::unordered_map<std::string, long long> hitCounts;
-    std::mutex mtx;
+    // Hits one thread recorded during one minute (minute = Unix time / 60)
+    struct MinuteBatch {
+        int64_t minute;
+        std::unordered_map<std::string, long long> counts;
+    };
+
+    // Hits recorded by one thread. In Exact mode `batches` holds counts
+    // since the last merge; a merge just swaps them out, so the owner never
+    // waits for more than an O(1) critical section. HeavyHitters mode keeps
+    // only the fixed-size summary and sketch.
+    struct Shard {
+        std::mutex mtx;
+        std::vector<MinuteBatch> batches;     // oldest first
+        size_t pendingEntries = 0;            // code entries across batches
+        std::string scratchKey;               // lookup key for `batches`
+        SpaceSaving top;
+        std::unique_ptr<CountMinSketch> sketch;
+
+        explicit Shard(size_t topCapacity) : top(topCapacity) {}
+    };
+
+    // Merged per-code state (Exact mode)
+    struct CodeStats {
+        long long hits = 0;
+        ClickSeries series;
+    };
+
+    uint64_t instanceId;                      // identifies this tracker's thread-local shard
+    AnalyticsMode mode;
+    size_t topCapacity;
+    std::atomic<bool> enabled{true};
+
+    std::mutex registryMtx;
+    std::unordered_map<std::thread::id, std::unique_ptr<Shard>> shards;
+
+    std::mutex mergeMtx;
+    std::unordered_map<std::string, CodeStats> stats;       // merged totals and series
+
+    // Background merger (Exact mode)
+    std::thread mergerThread;
+    std::mutex mergerMtx;
+    std::condition_variable mergerCv;
+    bool stopMerger = false;
+    std::atomic<bool> mergeWanted{false};     // a shard filled up
+
+    Shard& localShard();
+    void mergerLoop();
+    void drain(Shard& shard);                 // requires mergeMtx
+    void mergeAll();                          // requires mergeMtx
 
 public:
+    // topCapacity = codes tracked per thread for topK (more = more precise)
+    explicit AnalyticsTracker(AnalyticsMode mode = AnalyticsMode::Exact, size_t topCapacity = 1024);
+    ~AnalyticsTracker();
+
+    AnalyticsTracker(const AnalyticsTracker&) = delete;
+    AnalyticsTracker& operator=(const AnalyticsTracker&) = delete;
+
     // Record a redirect hit for a short code
-    void recordHit(const std::string& shortCode);
+    void recordHit(std::string_view shortCode);
+
+    // Turn hit recording off (recordHit becomes a no-op) or back on
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
 
-    // Get total hits for a short code
+    // Get total hits for a short code (an upper-bound estimate in HeavyHitters mode)
     long long getHitCount(const std::string& shortCode);
 
+    // The k most clicked codes, most clicked first. Candidates come from the
+    // per-thread summaries (cost independent of the number of codes); in
+    // Exact mode their counts are exact.
+    std::vector<HitCount> topK(int k);
+
+    AnalyticsMode getMode() const { return mode; }
+
+    // Hits per bucket for the `buckets` most recent buckets at `res`
+    // (oldest first, the last one is the current minute/hour/day).
+    // Exact mode only; HeavyHitters mode returns zeros.
+    std::vector<uint32_t> clickSeries(const std::string& shortCode, SeriesResolution res, int buckets);
+
+    // The same series for many codes (every tracked code if `codes` is
+    // empty) as one columnar little-endian blob:
+    //   char     magic[8]          "URLCLK1\0"
+    //   uint32   bucketSeconds     60, 3600 or 86400
+    //   uint32   buckets           B
+    //   int64    firstBucket       Unix time / bucketSeconds of column 0
+    //   uint32   codeCount         N
+    //   uint32   reserved
+    //   uint32   codeOffsets[N+1]  into codeBytes
+    //   char     codeBytes[]       zero-padded to a multiple of 8
+    //   uint64   totals[N]         lifetime hits
+    //   uint32   counts[N][B]      one row per code, oldest bucket first
+    std::string exportSeries(const std::vector<std::string>& codes, SeriesResolution res, int buckets);
+
     // Print top N URLs by click count
     void printReport(int topN = 10);
 };
@@ -1,19 +1,120 @@
 #include "Base62Encoder.h"
+#include <array>
+#include <climits>
+#include <cstring>
 
-static const std :: string  BASE62_CHARS=
+static constexpr char BASE62_CHARS[] =
  "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
+// Two digits per lookup: PAIRS[2*v], PAIRS[2*v+1] spell v in [0, 62*62)
+static constexpr std::array<char, 62 * 62 * 2> makePairs() {
+    std::array<char, 62 * 62 * 2> t{};
+    for (int v = 0; v < 62 * 62; v++) {
+        t[2 * v] = BASE62_CHARS[v / 62];
+        t[2 * v + 1] = BASE62_CHARS[v % 62];
+    }
+    return t;
+}
+static constexpr std::array<char, 62 * 62 * 2> PAIRS = makePairs();
+
+// Char -> digit value, -1 for anything that is not Base62
+static constexpr std::array<int8_t, 256> makeDigits() {
+    std::array<int8_t, 256> t{};
+    for (int i = 0; i < 256; i++) t[i] = -1;
+    for (int i = 0; i < 62; i++) t[(unsigned char)BASE62_CHARS[i]] = (int8_t)i;
+    return t;
+}
+static constexpr std::array<int8_t, 256> DIGITS = makeDigits();
+
+// Digits are produced back to front into the tail of a MAX_LEN buffer,
+// two per division; returns the index of the first digit. The last pair is
+// only taken while n >= 62, so it never starts with a '0'.
+static size_t encodeTail(unsigned long long n, char* buf) {
+    size_t pos = Base62Encoder::MAX_LEN;
+    while (n >= 62) {
+        unsigned v = (unsigned)(n % (62 * 62));
+        n /= 62 * 62;
+        pos -= 2;
+        std::memcpy(buf + pos, &PAIRS[2 * v], 2);
+    }
+    if (n > 0 || pos == Base62Encoder::MAX_LEN) buf[--pos] = BASE62_CHARS[n];
+    return pos;
+}
+
  std :: string Base62Encoder:: encode( long long number){
- if(number ==0){
-    return "0";
- }
- std :: string  result ="";
+    char buf[MAX_LEN];
+    size_t len = encode(number, buf);
+    return std::string(buf, len);
+}
+
+size_t Base62Encoder::encode(long long number, char* out) {
+    char buf[MAX_LEN];
+    size_t pos = encodeTail(number > 0 ? (unsigned long long)number : 0, buf);
+    size_t len = MAX_LEN - pos;
+    std::memcpy(out, buf + pos, len);
+    return len;
+}
+
+bool Base62Encoder::encodeFixed(long long number, char* out, size_t width) {
+    char buf[MAX_LEN];
+    size_t pos = encodeTail(number > 0 ? (unsigned long long)number : 0, buf);
+    size_t len = MAX_LEN - pos;
+    if (len > width) return false;
+    std::memset(out, '0', width - len);
+    std::memcpy(out + (width - len), buf + pos, len);
+    return true;
+}
+
+void Base62Encoder::encodeBatch(const long long* numbers, size_t count, Code* out) {
+    size_t i = 0;
+    // Four independent encodings per iteration
+    for (; i + 4 <= count; i += 4) {
+        char b0[MAX_LEN], b1[MAX_LEN], b2[MAX_LEN], b3[MAX_LEN];
+        size_t p0 = encodeTail(numbers[i]     > 0 ? numbers[i]     : 0, b0);
+        size_t p1 = encodeTail(numbers[i + 1] > 0 ? numbers[i + 1] : 0, b1);
+        size_t p2 = encodeTail(numbers[i + 2] > 0 ? numbers[i + 2] : 0, b2);
+        size_t p3 = encodeTail(numbers[i + 3] > 0 ? numbers[i + 3] : 0, b3);
+        out[i].len     = (uint8_t)(MAX_LEN - p0); std::memcpy(out[i].data,     b0 + p0, MAX_LEN - p0);
+        out[i + 1].len = (uint8_t)(MAX_LEN - p1); std::memcpy(out[i + 1].data, b1 + p1, MAX_LEN - p1);
+        out[i + 2].len = (uint8_t)(MAX_LEN - p2); std::memcpy(out[i + 2].data, b2 + p2, MAX_LEN - p2);
+        out[i + 3].len = (uint8_t)(MAX_LEN - p3); std::memcpy(out[i + 3].data, b3 + p3, MAX_LEN - p3);
+    }
+    for (; i < count; i++) out[i].len = (uint8_t)encode(numbers[i], out[i].data);
+}
 
- while(number>0){
-    int remainder = number % 62;
-    result= BASE62_CHARS[remainder] +result;
-    number=number/62;
+bool Base62Encoder::decode(std::string_view code, long long& number) {
+    size_t len = code.size();
+    if (len == 0 || len > MAX_LEN) return false;
+    // Up to MAX_LEN - 1 digits (< 62^10) cannot overflow; only the last
+    // digit of a full-width code needs a range check
+    size_t head = len < MAX_LEN ? len : MAX_LEN - 1;
+    long long n = 0;
+    for (size_t i = 0; i < head; i++) {
+        int d = DIGITS[(unsigned char)code[i]];
+        if (d < 0) return false;
+        n = n * 62 + d;
+    }
+    if (head < len) {
+        int d = DIGITS[(unsigned char)code[head]];
+        if (d < 0 || n > (LLONG_MAX - d) / 62) return false;
+        n = n * 62 + d;
+    }
+    number = n;
+    return true;
+}
 
- }
+bool Base62Encoder::isValid(std::string_view code) {
+    if (code.empty() || code.size() > MAX_ALIAS_LEN) return false;
+    for (char c : code) {
+        if (DIGITS[(unsigned char)c] < 0) return false;
+    }
+    return true;
+}
 
- return result;}
+bool Base62Encoder::isLookupValid(std::string_view code) {
+    if (code.empty() || code.size() > MAX_ALIAS_LEN) return false;
+    for (char c : code) {
+        if (DIGITS[(unsigned char)c] < 0 && c != '-' && c != '_') return false;
+    }
+    return true;
+}
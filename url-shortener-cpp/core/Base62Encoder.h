@@ -1,10 +1,48 @@
 #ifndef BASE62_ENCODER_H
 #define BASE62_ENCODER_H
 #include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// Base62 codec for short codes: digits 0-9, a-z, A-Z (most significant first)
 class Base62Encoder {
     public: 
+    static constexpr size_t MAX_LEN       = 11;   // digits of any non-negative 63-bit ID
+    static constexpr size_t MAX_ALIAS_LEN = 64;   // longest accepted custom alias
+
+    // Inline, fixed-capacity code (no heap allocation)
+    struct Code {
+        char data[MAX_LEN];
+        uint8_t len = 0;
+        std::string_view view() const { return std::string_view(data, len); }
+    };
+
     static std:: string encode( long long number);
+
+    // Write the code into out (room for MAX_LEN chars, no terminator);
+    // returns its length. Negative numbers encode as "0".
+    static size_t encode(long long number, char* out);
+
+    // Exactly `width` chars, left-padded with '0'; false if it doesn't fit
+    static bool encodeFixed(long long number, char* out, size_t width);
+
+    // Encode many IDs; independent IDs are interleaved so their division
+    // chains overlap in the pipeline
+    static void encodeBatch(const long long* numbers, size_t count, Code* out);
+
+    // Parse a code back into its number; false if it contains a non-Base62
+    // char, is empty, or does not fit in 63 bits
+    static bool decode(std::string_view code, long long& number);
+
+    // Cheap shape check for incoming codes and aliases (1..MAX_ALIAS_LEN
+    // Base62 chars), done before any cache or repository lookup
+    static bool isValid(std::string_view code);
+
+    // isValid() for codes being looked up: also lets through '-' and '_',
+    // which aliases stored before isValid() was enforced may contain
+    static bool isLookupValid(std::string_view code);
 };
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,58 @@
+#include "ClickSeries.h"
+#include <algorithm>
+
+namespace {
+
+// Zero the ring slots for buckets (from, to]
+void clearRange(uint32_t* ring, int size, int64_t from, int64_t to) {
+    for (int64_t i = std::max(from + 1, to - size + 1); i <= to; i++) ring[i % size] = 0;
+}
+
+void addSaturating(uint32_t& cell, uint32_t n) {
+    cell = cell > UINT32_MAX - n ? UINT32_MAX : cell + n;
+}
+
+} // namespace
+
+int ClickSeries::ringSize(SeriesResolution res) {
+    switch (res) {
+        case SeriesResolution::Minute: return MINUTES;
+        case SeriesResolution::Hour:   return HOURS;
+        default:                       return DAYS;
+    }
+}
+
+int64_t ClickSeries::bucketSeconds(SeriesResolution res) {
+    switch (res) {
+        case SeriesResolution::Minute: return 60;
+        case SeriesResolution::Hour:   return 3600;
+        default:                       return 86400;
+    }
+}
+
+void ClickSeries::add(int64_t minute, uint32_t n) {
+    if (minute < 0) return;
+    if (lastMinute < 0) lastMinute = minute;
+    if (minute > lastMinute) {
+        clearRange(minutes, MINUTES, lastMinute, minute);
+        clearRange(hours, HOURS, lastMinute / 60, minute / 60);
+        clearRange(days, DAYS, lastMinute / 1440, minute / 1440);
+        lastMinute = minute;
+    }
+
+    if (minute > lastMinute - MINUTES) addSaturating(minutes[minute % MINUTES], n);
+    if (minute / 60 > lastMinute / 60 - HOURS) addSaturating(hours[(minute / 60) % HOURS], n);
+    if (minute / 1440 > lastMinute / 1440 - DAYS) addSaturating(days[(minute / 1440) % DAYS], n);
+}
+
+uint32_t ClickSeries::at(SeriesResolution res, int64_t index) const {
+    if (lastMinute < 0 || index < 0) return 0;
+    int64_t last = lastMinute * 60 / bucketSeconds(res);
+    int size = ringSize(res);
+    if (index > last || index <= last - size) return 0;
+    switch (res) {
+        case SeriesResolution::Minute: return minutes[index % MINUTES];
+        case SeriesResolution::Hour:   return hours[index % HOURS];
+        default:                       return days[index % DAYS];
+    }
+}
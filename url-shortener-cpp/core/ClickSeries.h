@@ -0,0 +1,41 @@
+#ifndef CLICK_SERIES_H
+#define CLICK_SERIES_H
+
+#include <cstdint>
+
+// Bucket length of a click series
+enum class SeriesResolution {
+    Minute,     // last 60 minutes
+    Hour,       // last 24 hours
+    Day         // last 30 days
+};
+
+// Click counts for one short code in rolling windows. Each resolution is a
+// fixed ring of buckets, and a hit is rolled up into all three when it is
+// added, so memory is constant per code (~470 bytes).
+//
+// Bucket indices are Unix time / bucket length (minute = seconds / 60).
+class ClickSeries {
+public:
+    static constexpr int MINUTES = 60;
+    static constexpr int HOURS   = 24;
+    static constexpr int DAYS    = 30;
+
+    static int ringSize(SeriesResolution res);
+    static int64_t bucketSeconds(SeriesResolution res);
+
+    // Add n hits at `minute`; hits older than a ring's window only count
+    // in the coarser rings that still cover them
+    void add(int64_t minute, uint32_t n);
+
+    // Hits in bucket `index` at `res` (0 outside the window)
+    uint32_t at(SeriesResolution res, int64_t index) const;
+
+private:
+    int64_t lastMinute = -1;        // newest minute added, -1 = empty
+    uint32_t minutes[MINUTES] = {};
+    uint32_t hours[HOURS] = {};
+    uint32_t days[DAYS] = {};
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include "ColdTable.h"
+#include "HashUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char     COLD_MAGIC[8] = {'U', 'R', 'L', 'C', 'O', 'L', 'D', '1'};
+constexpr uint32_t COLD_VERSION  = 1;
+constexpr uint64_t BLOOM_SEED    = 0xb10015eedULL;
+constexpr size_t   RECORD_HEADER = 2 + 4 + 8;     // keyLen, urlLen, expiresAt
+constexpr size_t   INDEX_HEADER  = 8 + 4 + 4 + 4 + 2;
+
+struct ColdHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t bloomHashes;
+    uint64_t entries;
+    uint64_t blockCount;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+};
+
+uint32_t hashCount(int bitsPerKey) {
+    // k = bits/key * ln 2 minimises the false-positive rate
+    return (uint32_t)std::max(1L, std::lround(bitsPerKey * 0.69));
+}
+
+// Bit i of a Bloom filter of `bits` bits (Kirsch–Mitzenmacher double hashing)
+uint64_t bloomBit(uint64_t hash, uint32_t i, uint64_t bits) {
+    uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+    return (h1 + i * h2) % bits;
+}
+
+template <typename T>
+void appendRaw(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T readRaw(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+// ── Writer ──
+
+ColdTable::Writer::Writer(const std::string& path, size_t blockBytes, int bloomBitsPerKey)
+    : path(path), blockBytes(std::max<size_t>(blockBytes, 256)),
+      bloomBitsPerKey(std::max(bloomBitsPerKey, 1)) {
+    file = std::fopen((path + ".tmp").c_str(), "wb");
+    if (!file) return;
+    ColdHeader header{};
+    write(&header, sizeof(header));   // rewritten by finish()
+}
+
+ColdTable::Writer::~Writer() {
+    if (file) {
+        std::fclose(file);
+        std::remove((path + ".tmp").c_str());
+    }
+}
+
+void ColdTable::Writer::write(const void* data, size_t len) {
+    if (failed || std::fwrite(data, 1, len, file) != len) failed = true;
+    written += len;
+}
+
+void ColdTable::Writer::add(std::string_view key, std::string_view url, int64_t expiresAt) {
+    if (!ok()) return;
+    if (key.empty() || key.size() > UINT16_MAX || url.size() > UINT32_MAX) {
+        failed = true;
+        return;
+    }
+    size_t recordBytes = RECORD_HEADER + key.size() + url.size();
+    if (!block.empty() && block.size() + recordBytes > blockBytes) flushBlock();
+    if (block.empty()) blockFirstKey.assign(key.data(), key.size());
+
+    appendRaw(block, (uint16_t)key.size());
+    appendRaw(block, (uint32_t)url.size());
+    appendRaw(block, expiresAt);
+    block.append(key.data(), key.size());
+    block.append(url.data(), url.size());
+    blockHashes.push_back(hashString(key, BLOOM_SEED));
+    entries++;
+}
+
+void ColdTable::Writer::flushBlock() {
+    uint64_t bits = std::max<uint64_t>(64, (uint64_t)blockHashes.size() * bloomBitsPerKey);
+    bits = (bits + 63) & ~63ULL;
+    std::vector<uint64_t> bloom(bits / 64, 0);
+    uint32_t k = hashCount(bloomBitsPerKey);
+    for (uint64_t h : blockHashes) {
+        for (uint32_t i = 0; i < k; i++) {
+            uint64_t bit = bloomBit(h, i, bits);
+            bloom[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    index.push_back({written, (uint32_t)block.size(), (uint32_t)bloom.size(),
+                     (uint32_t)blockHashes.size(), blockFirstKey});
+    write(block.data(), block.size());
+    write(bloom.data(), bloom.size() * sizeof(uint64_t));
+    block.clear();
+    blockHashes.clear();
+}
+
+bool ColdTable::Writer::finish() {
+    if (!file) return false;
+    if (!block.empty()) flushBlock();
+
+    std::string indexBytes;
+    for (const IndexEntry& e : index) {
+        appendRaw(indexBytes, e.offset);
+        appendRaw(indexBytes, e.dataBytes);
+        appendRaw(indexBytes, e.bloomWords);
+        appendRaw(indexBytes, e.entries);
+        appendRaw(indexBytes, (uint16_t)e.firstKey.size());
+        indexBytes += e.firstKey;
+    }
+    ColdHeader header{};
+    std::memcpy(header.magic, COLD_MAGIC, sizeof(header.magic));
+    header.version = COLD_VERSION;
+    header.bloomHashes = hashCount(bloomBitsPerKey);
+    header.entries = entries;
+    header.blockCount = index.size();
+    header.indexOffset = written;
+    header.indexBytes = indexBytes.size();
+    write(indexBytes.data(), indexBytes.size());
+
+    bool good = !failed && std::fseek(file, 0, SEEK_SET) == 0
+             && std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fflush(file) == 0;
+#ifndef _WIN32
+    good = good && ::fsync(fileno(file)) == 0;
+#endif
+    good = std::fclose(file) == 0 && good;
+    file = nullptr;
+    std::string tmpPath = path + ".tmp";
+    if (!good || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ── Reader ──
+
+#ifndef _WIN32
+
+std::unique_ptr<ColdTable> ColdTable::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(ColdHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t fileSize = (size_t)st.st_size;
+    void* map = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return nullptr;
+    ::madvise(map, fileSize, MADV_RANDOM);
+
+    std::unique_ptr<ColdTable> table(new ColdTable());
+    table->path = path;
+    table->base = static_cast<const char*>(map);
+    table->mappedBytes = fileSize;   // unmapped by the destructor from here on
+
+    ColdHeader header;
+    std::memcpy(&header, table->base, sizeof(header));
+    if (std::memcmp(header.magic, COLD_MAGIC, sizeof(header.magic)) != 0
+        || header.version != COLD_VERSION || header.bloomHashes == 0
+        || header.indexOffset < sizeof(header) || header.indexOffset > fileSize
+        || header.indexBytes > fileSize - header.indexOffset) {
+        return nullptr;
+    }
+    table->entries = (size_t)header.entries;
+    table->bloomHashes = header.bloomHashes;
+
+    // Load the sparse index, checking every block lies before it
+    const char* p = table->base + header.indexOffset;
+    const char* end = p + header.indexBytes;
+    table->blocks.reserve((size_t)std::min<uint64_t>(header.blockCount, header.indexBytes / INDEX_HEADER));
+    for (uint64_t i = 0; i < header.blockCount; i++) {
+        if ((size_t)(end - p) < INDEX_HEADER) return nullptr;
+        Block b;
+        b.offset = readRaw<uint64_t>(p);
+        b.dataBytes = readRaw<uint32_t>(p + 8);
+        b.bloomWords = readRaw<uint32_t>(p + 12);
+        b.entries = readRaw<uint32_t>(p + 16);
+        b.firstKeyLen = readRaw<uint16_t>(p + 20);
+        p += INDEX_HEADER;
+        if ((size_t)(end - p) < b.firstKeyLen || b.bloomWords == 0
+            || b.offset < sizeof(header)
+            || b.offset + b.dataBytes + b.bloomWords * 8ULL > header.indexOffset) {
+            return nullptr;
+        }
+        b.firstKeyOff = (uint32_t)table->firstKeys.size();
+        table->firstKeys.append(p, b.firstKeyLen);
+        p += b.firstKeyLen;
+        table->blocks.push_back(b);
+    }
+    table->firstKeys.shrink_to_fit();
+    return table;
+}
+
+ColdTable::~ColdTable() {
+    if (base) ::munmap(const_cast<char*>(base), mappedBytes);
+}
+
+#else
+
+std::unique_ptr<ColdTable> ColdTable::open(const std::string&) {
+    return nullptr;
+}
+
+ColdTable::~ColdTable() {}
+
+#endif
+
+bool ColdTable::bloomMayContain(const Block& b, uint64_t hash) const {
+    const char* words = base + b.offset + b.dataBytes;
+    uint64_t bits = (uint64_t)b.bloomWords * 64;
+    for (uint32_t i = 0; i < bloomHashes; i++) {
+        uint64_t bit = bloomBit(hash, i, bits);
+        uint64_t word = readRaw<uint64_t>(words + (bit / 64) * 8);
+        if (!(word & (1ULL << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+bool ColdTable::get(std::string_view key, std::string_view& url, int64_t& expiresAt) const {
+    // Last block whose first key is <= key
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), key,
+                               [this](std::string_view k, const Block& b) { return k < firstKey(b); });
+    if (it == blocks.begin()) return false;
+    const Block& b = *--it;
+    if (!bloomMayContain(b, hashString(key, BLOOM_SEED))) return false;
+
+    const char* p = base + b.offset;
+    const char* end = p + b.dataBytes;
+    while ((size_t)(end - p) >= RECORD_HEADER) {
+        uint16_t keyLen = readRaw<uint16_t>(p);
+        uint32_t urlLen = readRaw<uint32_t>(p + 2);
+        if ((size_t)(end - p) < RECORD_HEADER + keyLen + (size_t)urlLen) return false;
+        std::string_view recordKey(p + RECORD_HEADER, keyLen);
+        int cmp = recordKey.compare(key);
+        if (cmp == 0) {
+            expiresAt = readRaw<int64_t>(p + 6);
+            url = std::string_view(p + RECORD_HEADER + keyLen, urlLen);
+            return true;
+        }
+        if (cmp > 0) return false;   // sorted: passed it
+        p += RECORD_HEADER + keyLen + urlLen;
+    }
+    return false;
+}
+
+size_t ColdTable::indexBytes() const {
+    return blocks.capacity() * sizeof(Block) + firstKeys.capacity();
+}
+
+// ── Cursor ──
+
+ColdTable::Cursor::Cursor(const ColdTable& t) : table(&t) {
+    load();
+}
+
+void ColdTable::Cursor::next() {
+    pos += RECORD_HEADER + curKey.size() + curUrl.size();
+    load();
+}
+
+// Read the record at (block, pos), moving on to the next block at the end
+// of this one; a truncated record ends the block
+void ColdTable::Cursor::load() {
+    for (; block < table->blocks.size(); block++, pos = 0) {
+        const Block& b = table->blocks[block];
+        if (pos + RECORD_HEADER > b.dataBytes) continue;
+        const char* p = table->base + b.offset + pos;
+        uint16_t keyLen = readRaw<uint16_t>(p);
+        uint32_t urlLen = readRaw<uint32_t>(p + 2);
+        if (pos + RECORD_HEADER + keyLen + (size_t)urlLen > b.dataBytes) continue;
+        curExpiresAt = readRaw<int64_t>(p + 6);
+        curKey = std::string_view(p + RECORD_HEADER, keyLen);
+        curUrl = std::string_view(p + RECORD_HEADER + keyLen, urlLen);
+        return;
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef COLD_TABLE_H
+#define COLD_TABLE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Immutable on-disk table of (short code, long URL, expiry) sorted by code,
+// the storage of the repository's cold tier (POSIX only).
+//
+// Records are packed into ~4 KiB blocks; each block is followed by its own
+// Bloom filter. Only a sparse index (first code, offset and size of every
+// block) is kept in memory; the file is mmapped, so a lookup costs one
+// binary search over the index, a Bloom probe and, if that passes, a scan
+// of one block, touching one or two pages.
+//
+// File layout (little-endian, no alignment):
+//   Header
+//   per block:  records (u16 keyLen, u32 urlLen, i64 expiresAt, key, url)
+//               Bloom filter (u64 words)
+//   index:      per block u64 offset, u32 dataBytes, u32 bloomWords,
+//               u32 entries, u16 firstKeyLen, first key
+class ColdTable {
+public:
+    // Streams records, in strictly increasing code order, into a new table.
+    // Written to path + ".tmp", fsynced, then renamed into place by finish().
+    class Writer {
+    public:
+        Writer(const std::string& path, size_t blockBytes = 4096, int bloomBitsPerKey = 10);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool ok() const { return file != nullptr && !failed; }
+        void add(std::string_view key, std::string_view url, int64_t expiresAt);
+        bool finish();
+        size_t size() const { return entries; }
+
+    private:
+        struct IndexEntry {
+            uint64_t offset;
+            uint32_t dataBytes, bloomWords, entries;
+            std::string firstKey;
+        };
+
+        std::string path;
+        std::FILE* file = nullptr;
+        bool failed = false;
+        size_t blockBytes;
+        int bloomBitsPerKey;
+        uint64_t written = 0;               // file offset of the next byte
+        size_t entries = 0;
+        std::string block;                  // records of the open block
+        std::vector<uint64_t> blockHashes;  // their Bloom hashes
+        std::string blockFirstKey;
+        std::vector<IndexEntry> index;
+
+        void flushBlock();
+        void write(const void* data, size_t len);
+    };
+
+    // Map a table written by Writer; nullptr if missing or corrupt
+    static std::unique_ptr<ColdTable> open(const std::string& path);
+    ~ColdTable();
+
+    ColdTable(const ColdTable&) = delete;
+    ColdTable& operator=(const ColdTable&) = delete;
+
+    // Views into the mapping, valid while the table is alive
+    bool get(std::string_view key, std::string_view& url, int64_t& expiresAt) const;
+
+    // Sequential scan in code order
+    class Cursor {
+    public:
+        explicit Cursor(const ColdTable& table);
+        bool valid() const { return block < table->blocks.size(); }
+        void next();
+        std::string_view key() const { return curKey; }
+        std::string_view url() const { return curUrl; }
+        int64_t expiresAt() const { return curExpiresAt; }
+
+    private:
+        const ColdTable* table;
+        size_t block = 0;
+        size_t pos = 0;                     // offset of the next record in the block
+        std::string_view curKey, curUrl;
+        int64_t curExpiresAt = 0;
+
+        void load();
+    };
+
+    template <class Fn>
+    void forEach(Fn&& fn) const {
+        for (Cursor c(*this); c.valid(); c.next()) fn(c.key(), c.url(), c.expiresAt());
+    }
+
+    const std::string& filePath() const { return path; }
+    size_t size() const { return entries; }
+    size_t fileBytes() const { return mappedBytes; }
+    // Heap bytes of the sparse index
+    size_t indexBytes() const;
+
+private:
+    struct Block {
+        uint64_t offset;
+        uint32_t dataBytes, bloomWords, entries;
+        uint32_t firstKeyOff;               // into firstKeys
+        uint16_t firstKeyLen;
+    };
+
+    std::string path;
+    const char* base = nullptr;
+    size_t mappedBytes = 0;
+    size_t entries = 0;
+    uint32_t bloomHashes = 0;
+    std::vector<Block> blocks;
+    std::string firstKeys;                  // every block's first key, back to back
+
+    ColdTable() = default;
+    std::string_view firstKey(const Block& b) const {
+        return std::string_view(firstKeys.data() + b.firstKeyOff, b.firstKeyLen);
+    }
+    bool bloomMayContain(const Block& b, uint64_t hash) const;
+};
+
+#endif
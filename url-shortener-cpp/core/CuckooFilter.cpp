@@ -0,0 +1,188 @@
+#include "CuckooFilter.h"
+#include "HashUtil.h"
+#include "Prefetch.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int LANES = 4;                    // 16-bit fingerprints per bucket
+constexpr uint64_t HASH_SEED = 0xc0c0f117e5ULL;
+constexpr size_t MAX_SEARCH = 2048;         // buckets explored to make room
+
+struct Position {
+    size_t bucket;
+    uint16_t fp;
+};
+
+Position locate(std::string_view key, size_t mask) {
+    uint64_t h = hashString(key, HASH_SEED);
+    uint16_t fp = (uint16_t)(h >> 48);
+    if (fp == 0) fp = 1;                     // 0 marks an empty lane
+    return {(size_t)h & mask, fp};
+}
+
+// Partial-key cuckoo hashing: the other bucket depends only on this one
+// and the fingerprint, so entries can move without their key
+size_t altBucket(size_t bucket, uint16_t fp, size_t mask) {
+    return (bucket ^ (size_t)(fp * 0x5bd1e995ULL)) & mask;
+}
+
+uint16_t lane(uint64_t word, int i) {
+    return (uint16_t)(word >> (16 * i));
+}
+
+uint64_t withLane(uint64_t word, int i, uint16_t fp) {
+    return (word & ~(0xFFFFULL << (16 * i))) | ((uint64_t)fp << (16 * i));
+}
+
+bool hasFingerprint(uint64_t word, uint16_t fp) {
+    for (int i = 0; i < LANES; i++) {
+        if (lane(word, i) == fp) return true;
+    }
+    return false;
+}
+
+int emptyLane(uint64_t word) {
+    for (int i = 0; i < LANES; i++) {
+        if (lane(word, i) == 0) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+CuckooFilter::CuckooFilter(size_t expectedKeys) {
+    publish(makeTable(expectedKeys), 0);
+}
+
+std::unique_ptr<CuckooFilter::Table> CuckooFilter::makeTable(size_t expectedKeys) {
+    // Aim for at most ~85% of the lanes in use
+    size_t buckets = 16;
+    while (buckets * LANES * 85 < expectedKeys * 100) buckets <<= 1;
+    auto t = std::make_unique<Table>();
+    t->mask = buckets - 1;
+    t->maxKeys = buckets * LANES * 95 / 100;
+    t->buckets = std::make_unique<std::atomic<uint64_t>[]>(buckets);
+    for (size_t i = 0; i < buckets; i++) t->buckets[i].store(0, std::memory_order_relaxed);
+    return t;
+}
+
+void CuckooFilter::publish(std::unique_ptr<Table> table, size_t keys) {
+    live.store(table.get(), std::memory_order_release);
+    tables.push_back(std::move(table));
+    count = keys;
+}
+
+bool CuckooFilter::mayContain(std::string_view key) const {
+    const Table* t = live.load(std::memory_order_acquire);
+    Position p = locate(key, t->mask);
+    size_t alt = altBucket(p.bucket, p.fp, t->mask);
+    for (;;) {
+        uint64_t before = moves.load(std::memory_order_acquire);
+        if (hasFingerprint(t->buckets[p.bucket].load(std::memory_order_acquire), p.fp) ||
+            hasFingerprint(t->buckets[alt].load(std::memory_order_acquire), p.fp)) {
+            return true;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // A miss only counts if no fingerprint moved while we looked
+        if (before % 2 == 0 && moves.load(std::memory_order_relaxed) == before) return false;
+    }
+}
+
+void CuckooFilter::prefetch(std::string_view key) const {
+    const Table* t = live.load(std::memory_order_acquire);
+    Position p = locate(key, t->mask);
+    prefetchRead(&t->buckets[p.bucket]);
+    prefetchRead(&t->buckets[altBucket(p.bucket, p.fp, t->mask)]);
+}
+
+bool CuckooFilter::insert(std::string_view key) {
+    Table& t = *tables.back();
+    if (count >= t.maxKeys || !insertInto(t, key)) return false;
+    count++;
+    return true;
+}
+
+// Single writer: plain load/store per bucket is enough, release so readers
+// see whole words
+bool CuckooFilter::insertInto(Table& t, std::string_view key) {
+    Position p = locate(key, t.mask);
+    size_t roots[2] = {p.bucket, altBucket(p.bucket, p.fp, t.mask)};
+    for (size_t b : roots) {
+        uint64_t word = t.buckets[b].load(std::memory_order_relaxed);
+        int free = emptyLane(word);
+        if (free >= 0) {
+            t.buckets[b].store(withLane(word, free, p.fp), std::memory_order_release);
+            return true;
+        }
+    }
+
+    // Breadth-first search for a chain of moves that ends in a free lane.
+    // No bucket appears twice, so every planned move is still valid when
+    // the chain is applied.
+    struct Node {
+        size_t bucket;
+        int parent;         // index into nodes, -1 for a root
+        int parentLane;     // lane of the parent whose entry moves here
+    };
+    std::vector<Node> nodes = {{roots[0], -1, -1}};
+    if (roots[1] != roots[0]) nodes.push_back({roots[1], -1, -1});
+    for (size_t n = 0; n < nodes.size() && nodes.size() < MAX_SEARCH; n++) {
+        uint64_t word = t.buckets[nodes[n].bucket].load(std::memory_order_relaxed);
+        for (int l = 0; l < LANES; l++) {
+            size_t next = altBucket(nodes[n].bucket, lane(word, l), t.mask);
+            if (std::any_of(nodes.begin(), nodes.end(), [&](const Node& x) { return x.bucket == next; })) continue;
+            uint64_t nextWord = t.buckets[next].load(std::memory_order_relaxed);
+            int free = emptyLane(nextWord);
+            if (free < 0) {
+                nodes.push_back({next, (int)n, l});
+                continue;
+            }
+
+            // Apply from the free end back to a root
+            moves.fetch_add(1, std::memory_order_relaxed);   // odd: moving
+            std::atomic_thread_fence(std::memory_order_release);
+            size_t dstBucket = next;
+            int dstLane = free;
+            int cur = (int)n, curLane = l;
+            while (cur >= 0) {
+                size_t src = nodes[cur].bucket;
+                uint16_t fp = lane(t.buckets[src].load(std::memory_order_relaxed), curLane);
+                uint64_t dstWord = t.buckets[dstBucket].load(std::memory_order_relaxed);
+                t.buckets[dstBucket].store(withLane(dstWord, dstLane, fp), std::memory_order_release);
+                dstBucket = src;
+                dstLane = curLane;
+                curLane = nodes[cur].parentLane;
+                cur = nodes[cur].parent;
+            }
+            uint64_t rootWord = t.buckets[dstBucket].load(std::memory_order_relaxed);
+            t.buckets[dstBucket].store(withLane(rootWord, dstLane, p.fp), std::memory_order_release);
+            moves.fetch_add(1, std::memory_order_release);   // even: settled
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CuckooFilter::remove(std::string_view key) {
+    Table& t = *tables.back();
+    Position p = locate(key, t.mask);
+    size_t roots[2] = {p.bucket, altBucket(p.bucket, p.fp, t.mask)};
+    for (size_t b : roots) {
+        uint64_t word = t.buckets[b].load(std::memory_order_relaxed);
+        for (int i = 0; i < LANES; i++) {
+            if (lane(word, i) == p.fp) {
+                t.buckets[b].store(withLane(word, i, 0), std::memory_order_release);
+                count--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t CuckooFilter::memoryBytes() const {
+    size_t total = 0;
+    for (const auto& t : tables) total += sizeof(Table) + (t->mask + 1) * sizeof(uint64_t);
+    return total;
+}
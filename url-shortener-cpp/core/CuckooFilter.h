@@ -0,0 +1,78 @@
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Approximate set membership with deletion (Fan et al., "Cuckoo Filter:
+// Practically Better Than Bloom"). "No" is definite; "yes" is wrong with
+// probability about 8 / 65536 (16-bit fingerprints, 4 per bucket).
+//
+// One writer at a time (the caller serializes insert/remove/rebuild), any
+// number of lock-free readers. A bucket is one atomic 64-bit word. Making
+// room moves fingerprints along a precomputed path from its far end, each
+// copied into its new bucket before its old lane is reused, and readers
+// that see a miss re-check against a move counter, so a present key is
+// never reported absent. Growing builds a new table; retired tables are
+// kept until destruction (together never larger than the live one) so
+// readers need no reference counting.
+class CuckooFilter {
+public:
+    explicit CuckooFilter(size_t expectedKeys = 1024);
+
+    bool mayContain(std::string_view key) const;
+
+    // Start loading the key's two buckets ahead of a batched mayContain()
+    void prefetch(std::string_view key) const;
+
+    // False when the table is too full: rebuild() with more room (the key
+    // is not added)
+    bool insert(std::string_view key);
+
+    // Remove one copy of a key that was inserted; false if none was found
+    bool remove(std::string_view key);
+
+    // Replace the contents with the keys forEachKey(add) passes to add(),
+    // sized for expectedKeys (grown further if they do not fit)
+    template <class ForEachKey>
+    void rebuild(size_t expectedKeys, ForEachKey&& forEachKey) {
+        for (;;) {
+            std::unique_ptr<Table> table = makeTable(expectedKeys);
+            bool fits = true;
+            size_t n = 0;
+            forEachKey([&](std::string_view key) {
+                if (fits) fits = insertInto(*table, key);
+                n++;
+            });
+            if (fits) {
+                publish(std::move(table), n);
+                return;
+            }
+            expectedKeys = expectedKeys * 2 + 64;
+        }
+    }
+
+    size_t size() const { return count; }
+    size_t memoryBytes() const;
+
+private:
+    struct Table {
+        size_t mask;                                 // buckets - 1
+        size_t maxKeys;                              // load limit for insert()
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+    };
+
+    std::atomic<const Table*> live{nullptr};
+    std::vector<std::unique_ptr<Table>> tables;     // every table so far, live one last
+    size_t count = 0;
+    std::atomic<uint64_t> moves{0};                 // odd while fingerprints are moving
+
+    static std::unique_ptr<Table> makeTable(size_t expectedKeys);
+    bool insertInto(Table& t, std::string_view key);
+    void publish(std::unique_ptr<Table> table, size_t keys);
+};
+
+#endif
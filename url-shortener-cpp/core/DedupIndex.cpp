@@ -0,0 +1,103 @@
+#include "DedupIndex.h"
+#include "HashUtil.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr uint64_t HASH_SEED = 0xd3d0b5eedULL;
+constexpr size_t INITIAL_SLOTS = 64;
+
+} // namespace
+
+DedupIndex::DedupIndex(int numShards) {
+    if (numShards <= 0) {
+        int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+        numShards = 1;
+        while (numShards < hw * 2 && numShards < 64) numShards <<= 1;
+    }
+    int n = 1;
+    while (n * 2 <= numShards) {
+        n <<= 1;
+        shardBits++;
+    }
+    for (int i = 0; i < n; i++) shards.push_back(std::make_unique<Shard>());
+}
+
+uint64_t DedupIndex::fingerprint(std::string_view longUrl) {
+    uint64_t h = hashString(longUrl, HASH_SEED);
+    return h == 0 ? 1 : h;
+}
+
+// Top bits pick the shard, low bits the slot, so the two stay independent
+DedupIndex::Shard& DedupIndex::shardFor(uint64_t fingerprint) const {
+    return *shards[shardBits == 0 ? 0 : fingerprint >> (64 - shardBits)];
+}
+
+bool DedupIndex::find(uint64_t fingerprint, int64_t& id) const {
+    const Shard& s = shardFor(fingerprint);
+    std::shared_lock<std::shared_mutex> lock(s.mtx);
+    if (s.slots.empty()) return false;
+    size_t mask = s.slots.size() - 1;
+    for (size_t i = fingerprint & mask;; i = (i + 1) & mask) {
+        const Slot& slot = s.slots[i];
+        if (slot.fingerprint == 0) return false;
+        if (slot.fingerprint == fingerprint) {
+            id = slot.id;
+            return true;
+        }
+    }
+}
+
+// Called with the shard exclusively locked; the table has a free slot
+void DedupIndex::insertFresh(Shard& s, uint64_t fingerprint, int64_t id) {
+    size_t mask = s.slots.size() - 1;
+    size_t i = fingerprint & mask;
+    while (s.slots[i].fingerprint != 0) i = (i + 1) & mask;
+    s.slots[i] = {fingerprint, id};
+    s.count++;
+}
+
+void DedupIndex::put(uint64_t fingerprint, int64_t id) {
+    Shard& s = shardFor(fingerprint);
+    std::unique_lock<std::shared_mutex> lock(s.mtx);
+    if (!s.slots.empty()) {
+        size_t mask = s.slots.size() - 1;
+        for (size_t i = fingerprint & mask; s.slots[i].fingerprint != 0; i = (i + 1) & mask) {
+            if (s.slots[i].fingerprint == fingerprint) {
+                s.slots[i].id = id;
+                return;
+            }
+        }
+    }
+
+    // Max load 3/4
+    if ((s.count + 1) * 4 > s.slots.size() * 3) {
+        std::vector<Slot> old(std::max(INITIAL_SLOTS, s.slots.size() * 2), Slot{0, 0});
+        old.swap(s.slots);
+        s.count = 0;
+        for (const Slot& slot : old) {
+            if (slot.fingerprint != 0) insertFresh(s, slot.fingerprint, slot.id);
+        }
+    }
+    insertFresh(s, fingerprint, id);
+}
+
+size_t DedupIndex::size() const {
+    size_t total = 0;
+    for (const auto& s : shards) {
+        std::shared_lock<std::shared_mutex> lock(s->mtx);
+        total += s->count;
+    }
+    return total;
+}
+
+size_t DedupIndex::memoryBytes() const {
+    size_t total = 0;
+    for (const auto& s : shards) {
+        std::shared_lock<std::shared_mutex> lock(s->mtx);
+        total += sizeof(Shard) + s->slots.capacity() * sizeof(Slot);
+    }
+    return total;
+}
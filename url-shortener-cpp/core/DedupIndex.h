@@ -0,0 +1,55 @@
+#ifndef DEDUP_INDEX_H
+#define DEDUP_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+// Reverse index long URL → auto-generated short code, so shortening a URL
+// that is already stored can hand back its existing code.
+//
+// A slot is a 64-bit fingerprint of the URL and the link's ID (its code is
+// the ID in Base62): 16 bytes, no copy of the URL. Sharded open-addressing
+// tables; lookups share their shard's lock. A hit is only a candidate —
+// fingerprints can collide and links can be removed behind the index's
+// back — so the caller confirms it against the repository and put()s a
+// fresh link when it does not match.
+class DedupIndex {
+private:
+    struct Slot {
+        uint64_t fingerprint;   // 0 = empty
+        int64_t id;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mtx;
+        std::vector<Slot> slots;
+        size_t count = 0;
+    };
+
+    int shardBits = 0;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Shard& shardFor(uint64_t fingerprint) const;
+    static void insertFresh(Shard& s, uint64_t fingerprint, int64_t id);
+
+public:
+    // numShards = 0 picks from core count
+    explicit DedupIndex(int numShards = 0);
+
+    // Never 0
+    static uint64_t fingerprint(std::string_view longUrl);
+
+    // ID last put() for this fingerprint
+    bool find(uint64_t fingerprint, int64_t& id) const;
+
+    // Insert, or replace the ID of a fingerprint already present
+    void put(uint64_t fingerprint, int64_t id);
+
+    size_t size() const;
+    size_t memoryBytes() const;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "ExpiryWheel.h"
+
+ExpiryWheel::ExpiryWheel(int64_t tick, int64_t startMs)
+    : tickMs(tick > 0 ? tick : 1) {
+    currentTick = startMs / tickMs;
+}
+
+// Round up, so an entry is only reported once its deadline has passed
+int64_t ExpiryWheel::tickOf(int64_t ms) const {
+    return (ms + tickMs - 1) / tickMs;
+}
+
+// File an entry due after currentTick. The level is the lowest one whose
+// 64^(L+1)-tick window also contains currentTick; its slot is then always
+// ahead of the current position, and it cascades exactly when its window opens.
+void ExpiryWheel::place(Entry&& e, int64_t due) {
+    for (int level = 0; level < LEVELS; level++) {
+        int shift = SLOT_BITS * level;
+        if (((due ^ currentTick) >> (shift + SLOT_BITS)) == 0) {
+            wheel[level][(due >> shift) & (SLOTS - 1)].push_back(std::move(e));
+            return;
+        }
+    }
+    overflow.push_back(std::move(e));
+}
+
+void ExpiryWheel::schedule(std::string_view key, int64_t expiresAt) {
+    int64_t due = tickOf(expiresAt);
+    if (due <= currentTick) due = currentTick + 1;   // already due: next tick
+    place(Entry{std::string(key), expiresAt}, due);
+    scheduled++;
+}
+
+void ExpiryWheel::advance(int64_t nowMs, std::vector<Entry>& expired) {
+    // Only whole ticks that have fully elapsed
+    int64_t target = nowMs / tickMs;
+
+    auto refile = [&](std::vector<Entry>& bucket) {
+        std::vector<Entry> entries;
+        entries.swap(bucket);
+        for (Entry& e : entries) {
+            int64_t due = tickOf(e.expiresAt);
+            if (due <= currentTick) {
+                expired.push_back(std::move(e));
+                scheduled--;
+            } else {
+                place(std::move(e), due);
+            }
+        }
+    };
+
+    while (currentTick < target) {
+        currentTick++;
+
+        // Entering a new window: pull far-future deadlines back in
+        if ((currentTick & ((int64_t(1) << (SLOT_BITS * LEVELS)) - 1)) == 0) refile(overflow);
+
+        // Cascade coarser levels whose slot boundary we just crossed, top down
+        for (int level = LEVELS - 1; level >= 1; level--) {
+            int shift = SLOT_BITS * level;
+            if ((currentTick & ((int64_t(1) << shift) - 1)) == 0) {
+                refile(wheel[level][(currentTick >> shift) & (SLOTS - 1)]);
+            }
+        }
+
+        refile(wheel[0][currentTick & (SLOTS - 1)]);
+    }
+}
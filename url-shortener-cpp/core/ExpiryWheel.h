@@ -0,0 +1,50 @@
+#ifndef EXPIRY_WHEEL_H
+#define EXPIRY_WHEEL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Hierarchical timing wheel of (key, deadline) pairs (not thread-safe).
+//
+// Four levels of 64 slots; a level-L slot spans 64^L ticks, so scheduling
+// is O(1) and advance() only touches the slots that come due plus the
+// occasional cascade from a coarser level. Deadlines beyond the top level's
+// window wait in an overflow list that is re-filed when the window turns.
+// Entries are never cancelled: the owner checks each expired key against
+// its current deadline and ignores stale ones.
+class ExpiryWheel {
+public:
+    struct Entry {
+        std::string key;
+        int64_t expiresAt;    // ms, same clock as advance()
+    };
+
+    // tickMs = resolution; startMs = "now" on the caller's clock
+    ExpiryWheel(int64_t tickMs, int64_t startMs);
+
+    void schedule(std::string_view key, int64_t expiresAt);
+
+    // Move time forward to nowMs and append every entry whose deadline is
+    // <= nowMs to `expired`
+    void advance(int64_t nowMs, std::vector<Entry>& expired);
+
+    size_t pending() const { return scheduled; }
+
+private:
+    static constexpr int LEVELS    = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS     = 1 << SLOT_BITS;
+
+    int64_t tickMs;
+    int64_t currentTick;
+    size_t scheduled = 0;
+    std::vector<Entry> wheel[LEVELS][SLOTS];
+    std::vector<Entry> overflow;
+
+    int64_t tickOf(int64_t ms) const;
+    void place(Entry&& e, int64_t dueTick);
+};
+
+#endif
@@ -0,0 +1,423 @@
+#include "FlatUrlStore.h"
+#include "HashUtil.h"
+#include <cstring>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr size_t NOT_FOUND = (size_t)-1;
+
+// ─────────────────────────────────────────────
+// Arena
+// ─────────────────────────────────────────────
+
+void FlatUrlStore::Arena::addBlock(size_t numChunks) {
+    std::shared_ptr<char> block(new char[numChunks * CHUNK_SIZE], std::default_delete<char[]>());
+    reserved += numChunks * CHUNK_SIZE;
+    for (size_t i = 0; i < numChunks; i++) chunks.push_back(block.get() + i * CHUNK_SIZE);
+    owned.push_back(std::move(block));
+}
+
+uint64_t FlatUrlStore::Arena::placement(uint64_t next, size_t len) {
+    uint64_t inChunk = next & (CHUNK_SIZE - 1);
+    if (inChunk != 0 && len > CHUNK_SIZE - inChunk) {
+        // Skip the unused tail of the current chunk
+        next = (next | (CHUNK_SIZE - 1)) + 1;
+    }
+    return next;
+}
+
+uint64_t FlatUrlStore::Arena::allocate(size_t len) {
+    uint64_t off = placement(next, len);
+    // Make sure every chunk the record touches exists; a record bigger than
+    // a chunk always starts on a boundary and gets one contiguous block
+    uint64_t lastChunk = len == 0 ? off >> CHUNK_BITS : (off + len - 1) >> CHUNK_BITS;
+    if (lastChunk >= chunks.size()) {
+        off = (uint64_t)chunks.size() << CHUNK_BITS;
+        addBlock(len <= CHUNK_SIZE ? 1 : (len + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    }
+    next = off + len;
+    return off;
+}
+
+void FlatUrlStore::Arena::adopt(char* base, uint64_t bytes, std::shared_ptr<void> owner) {
+    size_t numChunks = (size_t)((bytes + CHUNK_SIZE - 1) >> CHUNK_BITS);
+    for (size_t i = 0; i < numChunks; i++) chunks.push_back(base + i * CHUNK_SIZE);
+    owned.push_back(std::move(owner));
+    next = (uint64_t)chunks.size() << CHUNK_BITS;
+}
+
+// ─────────────────────────────────────────────
+// Table
+// ─────────────────────────────────────────────
+
+FlatUrlStore::FlatUrlStore(size_t initialCapacity) {
+    slots.assign(roundUpPow2(initialCapacity < 16 ? 16 : initialCapacity), Slot{});
+}
+
+// Stable hash: slot positions are persisted as-is in snapshots
+size_t FlatUrlStore::hashKey(std::string_view key) {
+    return (size_t)hashString(key);
+}
+
+size_t FlatUrlStore::roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+std::string_view FlatUrlStore::keyOf(const Slot& s) const {
+    if (s.ctrl != LONG_KEY) return std::string_view(s.key, s.ctrl);
+    uint32_t keyLen;
+    std::memcpy(&keyLen, s.key, sizeof(keyLen));
+    return std::string_view(arena.at(s.urlOff), keyLen);
+}
+
+size_t FlatUrlStore::urlStart(const Slot& s) const {
+    return s.urlOff + (s.ctrl == LONG_KEY ? keyOf(s).size() : 0);
+}
+
+std::string_view FlatUrlStore::urlOf(const Slot& s) const {
+    return std::string_view(arena.at(urlStart(s)), s.urlLen);
+}
+
+size_t FlatUrlStore::arenaBytes(const Slot& s) const {
+    return s.urlLen + (s.ctrl == LONG_KEY ? keyOf(s).size() : 0);
+}
+
+size_t FlatUrlStore::findSlot(std::string_view key, size_t hash) const {
+    if (key.empty()) return NOT_FOUND;
+    size_t mask = slots.size() - 1;
+    uint8_t wantCtrl = key.size() <= INLINE_KEY ? (uint8_t)key.size() : LONG_KEY;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& s = slots[i];
+        if (s.ctrl == EMPTY) return NOT_FOUND;
+        if (s.ctrl != wantCtrl) continue;
+        if (wantCtrl == LONG_KEY ? keyOf(s) == key
+                                 : std::memcmp(s.key, key.data(), key.size()) == 0) {
+            return i;
+        }
+    }
+}
+
+void FlatUrlStore::writeEntry(Slot& s, std::string_view key,
+                              std::string_view longUrl, int64_t expiresAt) {
+    bool inlineKey = key.size() <= INLINE_KEY;
+    size_t keyBytes = inlineKey ? 0 : key.size();
+
+    s.urlOff = arena.allocate(keyBytes + longUrl.size());
+    s.urlLen = (uint32_t)longUrl.size();
+    s.expiresAt = expiresAt;
+    std::memset(s.key, 0, INLINE_KEY);
+
+    char* dst = arena.at(s.urlOff);
+    if (inlineKey) {
+        s.ctrl = (uint8_t)key.size();
+        std::memcpy(s.key, key.data(), key.size());
+    } else {
+        s.ctrl = LONG_KEY;
+        uint32_t keyLen = (uint32_t)key.size();
+        std::memcpy(s.key, &keyLen, sizeof(keyLen));
+        std::memcpy(dst, key.data(), keyBytes);
+    }
+    std::memcpy(dst + keyBytes, longUrl.data(), longUrl.size());
+}
+
+void FlatUrlStore::releaseEntry(Slot& s) {
+    deadBytes += arenaBytes(s);
+}
+
+bool FlatUrlStore::put(std::string_view key, std::string_view longUrl, int64_t expiresAt) {
+    if (key.empty()) return false;
+
+    size_t existing = findSlot(key);
+    if (existing != NOT_FOUND) {
+        // Always append: arena bytes are immutable once written (see SnapshotView)
+        releaseEntry(slots[existing]);
+        writeEntry(slots[existing], key, longUrl, expiresAt);
+        compactArena();
+        return false;
+    }
+
+    // Keep (live + tombstone) load under 3/4 so probe chains stay short
+    if ((count + tombstones + 1) * 4 > slots.size() * 3) {
+        rehash(count * 2 >= slots.size() / 2 ? slots.size() * 2 : slots.size());
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = hashKey(key) & mask;
+    while (slots[i].ctrl != EMPTY && slots[i].ctrl != TOMBSTONE) i = (i + 1) & mask;
+
+    if (slots[i].ctrl == TOMBSTONE) tombstones--;
+    writeEntry(slots[i], key, longUrl, expiresAt);
+    count++;
+    return true;
+}
+
+bool FlatUrlStore::get(std::string_view key, std::string& longUrl, int64_t& expiresAt) const {
+    size_t i = findSlot(key);
+    if (i == NOT_FOUND) return false;
+    const Slot& s = slots[i];
+    std::string_view url = urlOf(s);
+    longUrl.assign(url.data(), url.size());
+    expiresAt = s.expiresAt;
+    return true;
+}
+
+bool FlatUrlStore::view(std::string_view key, std::string_view& longUrl, int64_t& expiresAt) const {
+    size_t i = findSlot(key);
+    if (i == NOT_FOUND) return false;
+    longUrl = urlOf(slots[i]);
+    expiresAt = slots[i].expiresAt;
+    return true;
+}
+
+bool FlatUrlStore::view(std::string_view key, size_t hash,
+                        std::string_view& longUrl, int64_t& expiresAt) const {
+    size_t i = findSlot(key, hash);
+    if (i == NOT_FOUND) return false;
+    longUrl = urlOf(slots[i]);
+    expiresAt = slots[i].expiresAt;
+    return true;
+}
+
+bool FlatUrlStore::expiryOf(std::string_view key, int64_t& expiresAt) const {
+    size_t i = findSlot(key);
+    if (i == NOT_FOUND) return false;
+    expiresAt = slots[i].expiresAt;
+    return true;
+}
+
+bool FlatUrlStore::contains(std::string_view key) const {
+    return findSlot(key) != NOT_FOUND;
+}
+
+bool FlatUrlStore::erase(std::string_view key) {
+    size_t i = findSlot(key);
+    if (i == NOT_FOUND) return false;
+
+    releaseEntry(slots[i]);
+    slots[i].ctrl = TOMBSTONE;
+    count--;
+    tombstones++;
+    compactArena();
+    return true;
+}
+
+void FlatUrlStore::rehash(size_t newCapacity) {
+    std::vector<Slot> old(roundUpPow2(newCapacity), Slot{});
+    old.swap(slots);
+    tombstones = 0;
+
+    size_t mask = slots.size() - 1;
+    for (const Slot& s : old) {
+        if (s.ctrl == EMPTY || s.ctrl == TOMBSTONE) continue;
+        size_t i = hashKey(keyOf(s)) & mask;
+        while (slots[i].ctrl != EMPTY) i = (i + 1) & mask;
+        slots[i] = s;   // arena offsets stay valid
+    }
+}
+
+void FlatUrlStore::shrinkToFit() {
+    size_t wanted = roundUpPow2(count * 2 < 16 ? 16 : count * 2);
+    if (wanted <= slots.size() / 2) rehash(wanted);
+}
+
+// Rewrite the arena once more than half of it is garbage
+void FlatUrlStore::compactArena() {
+    if (deadBytes < Arena::CHUNK_SIZE || deadBytes * 2 < arena.used()) return;
+
+    Arena fresh;
+    for (Slot& s : slots) {
+        if (s.ctrl == EMPTY || s.ctrl == TOMBSTONE) continue;
+        size_t len = arenaBytes(s);
+        uint64_t off = fresh.allocate(len);
+        std::memcpy(fresh.at(off), arena.at(s.urlOff), len);
+        s.urlOff = off;
+    }
+    arena = std::move(fresh);
+    deadBytes = 0;
+}
+
+size_t FlatUrlStore::memoryBytes() const {
+    return slots.capacity() * sizeof(Slot) + arena.reservedBytes();
+}
+
+// ─────────────────────────────────────────────
+// Snapshots
+// ─────────────────────────────────────────────
+//
+// File layout (all offsets page-aligned):
+//   SnapshotHeader | slot array image | arena image (1 MiB chunk layout)
+// The slot array is stored verbatim (positions depend only on the stable
+// key hash), and URL offsets are rewritten to a compacted arena.
+
+namespace {
+
+constexpr char     SNAPSHOT_MAGIC[8] = {'U', 'R', 'L', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t SNAPSHOT_VERSION  = 1;
+constexpr uint64_t PAGE              = 4096;
+
+struct SnapshotHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t slotCount;
+    uint64_t liveCount;
+    uint64_t tombstones;
+    uint64_t slotsOffset;
+    uint64_t arenaOffset;
+    uint64_t arenaBytes;
+    int64_t  highestId;      // added later: older files have zero padding here
+};
+
+uint64_t pageAlign(uint64_t n) { return (n + PAGE - 1) & ~(PAGE - 1); }
+
+}
+
+FlatUrlStore::SnapshotView FlatUrlStore::snapshotView() const {
+    SnapshotView view;
+    view.slots = slots;
+    view.chunks.reserve(arena.chunkCount());
+    for (size_t i = 0; i < arena.chunkCount(); i++) view.chunks.push_back(arena.chunk(i));
+    view.owners = arena.blocks();
+    view.count = count;
+    view.tombstones = tombstones;
+    return view;
+}
+
+#ifndef _WIN32
+
+bool FlatUrlStore::writeSnapshot(const SnapshotView& view, const std::string& path) {
+    std::string tmpPath = path + ".tmp";
+    std::FILE* f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+    std::vector<char> ioBuffer(4 << 20);
+    std::setvbuf(f, ioBuffer.data(), _IOFBF, ioBuffer.size());
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.slotSize = sizeof(Slot);
+    header.slotCount = view.slots.size();
+    header.liveCount = view.count;
+    header.tombstones = view.tombstones;
+    header.highestId = view.highestId;
+    header.slotsOffset = PAGE;
+    header.arenaOffset = pageAlign(header.slotsOffset + view.slots.size() * sizeof(Slot));
+
+    auto readArena = [&](uint64_t off) {
+        return view.chunks[off >> Arena::CHUNK_BITS] + (off & (Arena::CHUNK_SIZE - 1));
+    };
+    auto pad = [&](uint64_t n) {
+        static const char zeros[4096] = {};
+        while (n > 0) {
+            size_t step = n < sizeof(zeros) ? (size_t)n : sizeof(zeros);
+            std::fwrite(zeros, 1, step, f);
+            n -= step;
+        }
+    };
+
+    // Rewrite URL offsets into a compacted arena laid out like Arena::allocate
+    std::vector<Slot> out = view.slots;
+    uint64_t arenaNext = 0;
+    for (Slot& s : out) {
+        if (s.ctrl == EMPTY || s.ctrl == TOMBSTONE) continue;
+        size_t len = s.urlLen;
+        if (s.ctrl == LONG_KEY) {
+            uint32_t keyLen;
+            std::memcpy(&keyLen, s.key, sizeof(keyLen));
+            len += keyLen;
+        }
+        uint64_t off = Arena::placement(arenaNext, len);
+        arenaNext = off + len;
+        s.urlOff = off;
+    }
+    header.arenaBytes = arenaNext;
+
+    std::fwrite(&header, sizeof(header), 1, f);
+    pad(header.slotsOffset - sizeof(header));
+    std::fwrite(out.data(), sizeof(Slot), out.size(), f);
+    pad(header.arenaOffset - header.slotsOffset - out.size() * sizeof(Slot));
+
+    uint64_t written = 0;
+    for (size_t i = 0; i < out.size(); i++) {
+        const Slot& s = out[i];
+        if (s.ctrl == EMPTY || s.ctrl == TOMBSTONE) continue;
+        size_t len = s.urlLen;
+        if (s.ctrl == LONG_KEY) {
+            uint32_t keyLen;
+            std::memcpy(&keyLen, s.key, sizeof(keyLen));
+            len += keyLen;
+        }
+        pad(s.urlOff - written);
+        std::fwrite(readArena(view.slots[i].urlOff), 1, len, f);
+        written = s.urlOff + len;
+    }
+
+    bool ok = std::fflush(f) == 0 && !std::ferror(f) && ::fsync(fileno(f)) == 0;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool FlatUrlStore::loadSnapshot(const std::string& path, int64_t* highestId) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t fileSize = (size_t)st.st_size;
+    void* map = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    std::shared_ptr<void> mapping(map, [fileSize](void* p) { ::munmap(p, fileSize); });
+
+    const char* base = static_cast<const char*>(map);
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    bool valid = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0
+              && header.version == SNAPSHOT_VERSION
+              && header.slotSize == sizeof(Slot)
+              && header.slotCount >= 16
+              && (header.slotCount & (header.slotCount - 1)) == 0
+              && header.slotsOffset + header.slotCount * sizeof(Slot) <= header.arenaOffset
+              && header.arenaOffset + header.arenaBytes <= fileSize;
+    if (!valid) return false;
+
+    // The slot array is copied (it is mutated in place); the arena is not
+    ::madvise(map, fileSize, MADV_RANDOM);
+    const Slot* image = reinterpret_cast<const Slot*>(base + header.slotsOffset);
+    slots.assign(image, image + header.slotCount);
+    count = (size_t)header.liveCount;
+    tombstones = (size_t)header.tombstones;
+    deadBytes = 0;
+    if (highestId) *highestId = header.highestId;
+
+    arena = Arena();
+    if (header.arenaBytes > 0) {
+        // Mapped read-only: the arena never writes below its `next` offset
+        arena.adopt(const_cast<char*>(base + header.arenaOffset), header.arenaBytes,
+                    std::move(mapping));
+    }
+    return true;
+}
+
+#else
+
+bool FlatUrlStore::writeSnapshot(const SnapshotView&, const std::string&) { return false; }
+bool FlatUrlStore::loadSnapshot(const std::string&, int64_t*) { return false; }
+
+#endif
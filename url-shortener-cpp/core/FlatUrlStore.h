@@ -0,0 +1,172 @@
+#ifndef FLAT_URL_STORE_H
+#define FLAT_URL_STORE_H
+
+#include "Prefetch.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Open-addressing short code -> long URL table (not thread-safe; the
+// repository locks around it).
+//
+// Each entry is one 32-byte slot in a flat array. Short codes of up to
+// 11 chars (every Base62 64-bit ID) are stored inline in the slot; longer
+// custom aliases and all long URLs live in an append-only byte arena and
+// are referenced by offset/length, so there is no per-entry heap node.
+class FlatUrlStore {
+public:
+    static constexpr size_t INLINE_KEY = 11;
+
+    // Slot control byte values (1..INLINE_KEY = inline key length)
+    static constexpr uint8_t EMPTY     = 0;
+    static constexpr uint8_t LONG_KEY  = 0xFE;   // key bytes precede the URL in the arena
+    static constexpr uint8_t TOMBSTONE = 0xFF;
+
+    struct Slot {
+        char     key[INLINE_KEY];  // inline key, or (LONG_KEY) key length as uint32
+        uint8_t  ctrl;
+        uint32_t urlLen;
+        uint64_t urlOff;           // arena offset of [long key][url]
+        int64_t  expiresAt;        // opaque timestamp, 0 = never expires
+    };
+    static_assert(sizeof(Slot) == 32, "FlatUrlStore::Slot must stay 32 bytes");
+
+    explicit FlatUrlStore(size_t initialCapacity = 16);
+
+    // Insert or overwrite; returns true if the key was not present before
+    bool put(std::string_view key, std::string_view longUrl, int64_t expiresAt);
+
+    // Copy the URL and expiry out if the key is present
+    bool get(std::string_view key, std::string& longUrl, int64_t& expiresAt) const;
+
+    // Same without the copy; the view is valid until the next write
+    bool view(std::string_view key, std::string_view& longUrl, int64_t& expiresAt) const;
+
+    // Batched lookups: hash every key, prefetch each one's home slot, then
+    // view them with the hash, so the slot misses overlap
+    static size_t hashOf(std::string_view key) { return hashKey(key); }
+    void prefetch(size_t hash) const { prefetchRead(&slots[hash & (slots.size() - 1)]); }
+    bool view(std::string_view key, size_t hash, std::string_view& longUrl, int64_t& expiresAt) const;
+
+    bool contains(std::string_view key) const;
+
+    // Returns true if the key was present
+    bool erase(std::string_view key);
+
+    size_t size() const { return count; }
+
+    // Expiry of a present key, without copying the URL
+    bool expiryOf(std::string_view key, int64_t& expiresAt) const;
+
+    // Visit every live entry as fn(key, expiresAt), in table order
+    template <class Fn>
+    void forEach(Fn&& fn) const {
+        for (const Slot& s : slots) {
+            if (s.ctrl != EMPTY && s.ctrl != TOMBSTONE) fn(keyOf(s), s.expiresAt);
+        }
+    }
+
+    // Visit the live entries in slots [begin, end) as fn(key, url, expiresAt),
+    // so a long scan can be split across several lock acquisitions. The
+    // views are valid until the next write.
+    size_t slotCount() const { return slots.size(); }
+    template <class Fn>
+    void forEachIn(size_t begin, size_t end, Fn&& fn) const {
+        for (size_t i = begin; i < end && i < slots.size(); i++) {
+            const Slot& s = slots[i];
+            if (s.ctrl != EMPTY && s.ctrl != TOMBSTONE) fn(keyOf(s), urlOf(s), s.expiresAt);
+        }
+    }
+
+    // Give back slot array memory after many erases
+    void shrinkToFit();
+
+    // Bytes held by the slot array and arena (reserved capacity included)
+    size_t memoryBytes() const;
+
+    // Point-in-time copy of the table taken under the caller's lock. Arena
+    // bytes are never modified once written, so the view only shares the
+    // arena blocks and can be written to disk after the lock is released.
+    struct SnapshotView {
+        std::vector<Slot> slots;
+        std::vector<const char*> chunks;
+        std::vector<std::shared_ptr<void>> owners;
+        size_t count = 0;
+        size_t tombstones = 0;
+        int64_t highestId = 0;   // stored alongside for the owner (UrlRepository's ID mark)
+    };
+    SnapshotView snapshotView() const;
+
+    // Write a view as a compacted snapshot file (dead arena bytes dropped).
+    // Written to path + ".tmp", fsynced, then renamed into place.
+    static bool writeSnapshot(const SnapshotView& view, const std::string& path);
+
+    // Replace the contents with a snapshot file. The file is mmapped and the
+    // arena is served straight from the mapping; only the slot array is copied.
+    // highestId receives the view's highestId (0 in older snapshots).
+    bool loadSnapshot(const std::string& path, int64_t* highestId = nullptr);
+
+private:
+    // Append-only byte arena made of fixed 1 MiB chunks, so growth never
+    // copies existing URLs. Offsets are (chunk << CHUNK_BITS | position);
+    // a record never straddles a chunk boundary, and records bigger than a
+    // chunk get a dedicated block spanning several chunk indices.
+    class Arena {
+    public:
+        static constexpr int      CHUNK_BITS = 20;
+        static constexpr uint64_t CHUNK_SIZE = 1ULL << CHUNK_BITS;
+
+        // Reserve len contiguous bytes; returns their offset
+        uint64_t allocate(size_t len);
+
+        // Offset `len` bytes would get if allocated at offset `next`
+        static uint64_t placement(uint64_t next, size_t len);
+
+        // Serve existing chunks from memory owned elsewhere (e.g. a mapping);
+        // new allocations start in a fresh chunk after them
+        void adopt(char* base, uint64_t bytes, std::shared_ptr<void> owner);
+        char* at(uint64_t off) { return chunks[off >> CHUNK_BITS] + (off & (CHUNK_SIZE - 1)); }
+        const char* at(uint64_t off) const { return chunks[off >> CHUNK_BITS] + (off & (CHUNK_SIZE - 1)); }
+
+        uint64_t used() const { return next; }
+        size_t reservedBytes() const { return reserved; }
+        size_t chunkCount() const { return chunks.size(); }
+        const char* chunk(size_t i) const { return chunks[i]; }
+        const std::vector<std::shared_ptr<void>>& blocks() const { return owned; }
+
+    private:
+        std::vector<char*> chunks;                  // chunk index -> base address
+        std::vector<std::shared_ptr<void>> owned;   // shared with snapshot views
+        uint64_t next = 0;                          // offset of the next free byte
+        size_t reserved = 0;
+
+        void addBlock(size_t numChunks);
+    };
+
+    std::vector<Slot> slots;       // power-of-two sized
+    Arena arena;
+    size_t count = 0;              // live entries
+    size_t tombstones = 0;
+    size_t deadBytes = 0;          // arena bytes no longer referenced
+
+    static size_t hashKey(std::string_view key);
+    static size_t roundUpPow2(size_t n);
+
+    std::string_view keyOf(const Slot& s) const;
+    size_t urlStart(const Slot& s) const;
+    std::string_view urlOf(const Slot& s) const;
+    size_t arenaBytes(const Slot& s) const;
+
+    // Index of the slot holding key, or SIZE_MAX
+    size_t findSlot(std::string_view key) const { return findSlot(key, hashKey(key)); }
+    size_t findSlot(std::string_view key, size_t hash) const;
+    void writeEntry(Slot& s, std::string_view key, std::string_view longUrl, int64_t expiresAt);
+    void releaseEntry(Slot& s);
+    void rehash(size_t newCapacity);
+    void compactArena();
+};
+
+#endif
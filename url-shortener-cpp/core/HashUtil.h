@@ -0,0 +1,50 @@
+#ifndef HASH_UTIL_H
+#define HASH_UTIL_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Stable, seeded 64-bit hash (MurmurHash64A). Unlike std::hash its output
+// is identical across compilers, platforms and runs, so it can be used for
+// anything that is persisted or shared between processes.
+inline uint64_t hashBytes(const void* data, size_t len, uint64_t seed = 0) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (len * m);
+
+    size_t blocks = len / 8;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t k;
+        std::memcpy(&k, p + i * 8, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    const unsigned char* tail = p + blocks * 8;
+    switch (len & 7) {
+        case 7: h ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(tail[1]) << 8;  [[fallthrough]];
+        case 1: h ^= uint64_t(tail[0]);
+                h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+inline uint64_t hashString(std::string_view s, uint64_t seed = 0) {
+    return hashBytes(s.data(), s.size(), seed);
+}
+
+#endif
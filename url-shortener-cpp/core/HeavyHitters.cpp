@@ -0,0 +1,154 @@
+#include "HeavyHitters.h"
+#include "HashUtil.h"
+#include <algorithm>
+
+SpaceSaving::SpaceSaving(size_t cap) : capacity(std::max<size_t>(cap, 1)) {
+    slots.reserve(capacity);
+    heap.reserve(capacity);
+    pos.reserve(capacity);
+    index.reserve(capacity);
+}
+
+void SpaceSaving::swapNodes(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    pos[heap[a]] = (int)a;
+    pos[heap[b]] = (int)b;
+}
+
+void SpaceSaving::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (slots[heap[parent]].count <= slots[heap[i]].count) break;
+        swapNodes(i, parent);
+        i = parent;
+    }
+}
+
+void SpaceSaving::siftDown(size_t i) {
+    size_t n = heap.size();
+    for (;;) {
+        size_t smallest = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && slots[heap[l]].count < slots[heap[smallest]].count) smallest = l;
+        if (r < n && slots[heap[r]].count < slots[heap[smallest]].count) smallest = r;
+        if (smallest == i) return;
+        swapNodes(i, smallest);
+        i = smallest;
+    }
+}
+
+void SpaceSaving::add(std::string_view key, long long n) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        // Counts only grow, so an updated slot can only move down
+        slots[it->second].count += n;
+        siftDown(pos[it->second]);
+        return;
+    }
+
+    if (slots.size() < capacity) {
+        int slot = (int)slots.size();
+        slots.push_back({std::string(key), n, 0});
+        heap.push_back(slot);
+        pos.push_back((int)heap.size() - 1);
+        index.emplace(std::string_view(slots.back().key), slot);
+        siftUp(heap.size() - 1);
+        return;
+    }
+
+    // Full: the new key takes over the minimum slot and inherits its count
+    int slot = heap[0];
+    Entry& e = slots[slot];
+    auto node = index.extract(std::string_view(e.key));
+    e.key.assign(key.data(), key.size());
+    e.error = e.count;
+    e.count += n;
+    node.key() = e.key;
+    index.insert(std::move(node));
+    siftDown(0);
+}
+
+void SpaceSaving::entries(std::vector<Entry>& out) const {
+    out.insert(out.end(), slots.begin(), slots.end());
+}
+
+long long SpaceSaving::minCount() const {
+    return slots.size() < capacity || heap.empty() ? 0 : slots[heap[0]].count;
+}
+
+CountMinSketch::CountMinSketch(size_t width, int depth) : depth(std::max(depth, 1)) {
+    size_t w = 1;
+    while (w < width) w <<= 1;
+    mask = w - 1;
+    cells.assign(w * this->depth, 0);
+}
+
+// Row i uses h1 + i * h2 (Kirsch–Mitzenmacher double hashing)
+void CountMinSketch::add(std::string_view key, uint32_t n) {
+    uint64_t h1 = hashString(key, 0x9E3779B97F4A7C15ULL);
+    uint64_t h2 = hashString(key, 0xC2B2AE3D27D4EB4FULL) | 1;
+    for (int i = 0; i < depth; i++) {
+        uint32_t& cell = cells[(size_t)i * (mask + 1) + ((h1 + i * h2) & mask)];
+        cell = cell > UINT32_MAX - n ? UINT32_MAX : cell + n;
+    }
+}
+
+uint64_t CountMinSketch::estimate(std::string_view key) const {
+    uint64_t h1 = hashString(key, 0x9E3779B97F4A7C15ULL);
+    uint64_t h2 = hashString(key, 0xC2B2AE3D27D4EB4FULL) | 1;
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < depth; i++) {
+        best = std::min<uint64_t>(best, cells[(size_t)i * (mask + 1) + ((h1 + i * h2) & mask)]);
+    }
+    return best;
+}
+
+namespace {
+
+// Counter i of row `row` for a key with hashes h1, h2 (as in CountMinSketch)
+inline size_t counterIndex(uint64_t h1, uint64_t h2, int row, size_t mask) {
+    return (size_t)(h1 + row * h2) & mask;
+}
+
+} // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+    size_t w = 1;
+    while (w < capacity) w <<= 1;
+    words.assign(w, 0);
+    counterMask = w * 16 - 1;
+    sampleSize = 10 * std::max<size_t>(capacity, 1);
+}
+
+void FrequencySketch::add(std::string_view key) {
+    uint64_t h1 = hashString(key, 0x9E3779B97F4A7C15ULL);
+    uint64_t h2 = hashString(key, 0xC2B2AE3D27D4EB4FULL) | 1;
+    bool added = false;
+    for (int row = 0; row < 4; row++) {
+        size_t i = counterIndex(h1, h2, row, counterMask);
+        uint64_t& word = words[i / 16];
+        int shift = (int)(i % 16) * 4;
+        if (((word >> shift) & 0xF) != 0xF) {
+            word += 1ULL << shift;
+            added = true;
+        }
+    }
+    if (added && ++additions >= sampleSize) age();
+}
+
+int FrequencySketch::estimate(std::string_view key) const {
+    uint64_t h1 = hashString(key, 0x9E3779B97F4A7C15ULL);
+    uint64_t h2 = hashString(key, 0xC2B2AE3D27D4EB4FULL) | 1;
+    int best = 15;
+    for (int row = 0; row < 4; row++) {
+        size_t i = counterIndex(h1, h2, row, counterMask);
+        best = std::min(best, (int)((words[i / 16] >> ((i % 16) * 4)) & 0xF));
+    }
+    return best;
+}
+
+// Halve every counter: shift each word and clear the bit that crossed
+// into the next nibble
+void FrequencySketch::age() {
+    for (uint64_t& word : words) word = (word >> 1) & 0x7777777777777777ULL;
+    additions /= 2;
+}
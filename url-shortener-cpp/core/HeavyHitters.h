@@ -0,0 +1,96 @@
+#ifndef HEAVY_HITTERS_H
+#define HEAVY_HITTERS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Space-Saving summary (Metwally et al.): the `capacity` most frequent keys
+// of a stream in bounded memory. Any key seen more than N / capacity times
+// in a stream of N is guaranteed to be present; a key's count overestimates
+// its true frequency by at most its `error`.
+//
+// Slots sit in a min-heap by count, so admitting a new key replaces the
+// current minimum and an update costs O(log capacity). The index holds
+// views of the slot keys, so counting an already tracked key allocates
+// nothing.
+class SpaceSaving {
+public:
+    struct Entry {
+        std::string key;
+        long long count = 0;
+        long long error = 0;    // count - error <= true frequency <= count
+    };
+
+    explicit SpaceSaving(size_t capacity = 1024);
+
+    // Not copyable: the index points into this summary's slots
+    SpaceSaving(const SpaceSaving&) = delete;
+    SpaceSaving& operator=(const SpaceSaving&) = delete;
+
+    void add(std::string_view key, long long n = 1);
+
+    // Copy every tracked entry (unordered) into out
+    void entries(std::vector<Entry>& out) const;
+
+    // Smallest tracked count (0 while not full): the most an untracked key
+    // can have been seen
+    long long minCount() const;
+
+    size_t size() const { return slots.size(); }
+    size_t getCapacity() const { return capacity; }
+
+private:
+    size_t capacity;
+    std::vector<Entry> slots;                   // reserved up front, never reallocated
+    std::vector<int> heap;                      // slot indices, min count at the root
+    std::vector<int> pos;                       // slot -> heap position
+    std::unordered_map<std::string_view, int> index;   // slot key -> slot
+
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void swapNodes(size_t a, size_t b);
+};
+
+// Count-Min sketch: approximate counts for any key in width * depth
+// counters. Estimates never undercount and overcount by at most
+// e / width * N with probability 1 - e^-depth.
+class CountMinSketch {
+public:
+    explicit CountMinSketch(size_t width = 1 << 14, int depth = 4);
+
+    void add(std::string_view key, uint32_t n = 1);
+    uint64_t estimate(std::string_view key) const;
+    size_t memoryBytes() const { return cells.size() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t> cells;    // depth rows of width counters
+    size_t mask;
+    int depth;
+};
+
+// TinyLFU's popularity estimate (Einziger et al.): a Count-Min sketch of
+// four rows of 4-bit counters, 16 to a word, sized at one word per entry
+// it must rank. Counters saturate at 15 and all of them are halved once
+// 10 * capacity increments have been recorded, so estimates follow recent
+// popularity instead of growing forever.
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t capacity);
+
+    void add(std::string_view key);
+    int estimate(std::string_view key) const;   // 0-15
+    size_t memoryBytes() const { return words.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> words;
+    size_t counterMask;             // counters = 16 * words.size()
+    size_t sampleSize;
+    size_t additions = 0;
+
+    void age();
+};
+
+#endif
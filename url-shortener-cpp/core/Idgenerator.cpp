@@ -1,11 +1,102 @@
 #include "Idgenerator.h"
+#include <chrono>
+#include <algorithm>
+#include <climits>
 
+namespace {
 
-Idgenerator :: Idgenerator(){
+std::atomic<uint64_t> nextInstanceId{1};
+
+// A thread's current block of sequence numbers
+struct Lease {
+    uint64_t owner = 0;      // Idgenerator::instanceId
+    uint64_t next = 0;       // packed (ms, seq) of the next ID to hand out
+    uint64_t end = 0;        // one past the last leased
+};
+thread_local Lease lease;
+
+uint64_t nowSinceEpoch() {
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return ms > Idgenerator::EPOCH_MS ? (uint64_t)(ms - Idgenerator::EPOCH_MS) : 0;
+}
+
+}
+
+Idgenerator :: Idgenerator() : Idgenerator(IdMode::Counter) {}
+
+Idgenerator :: Idgenerator(IdMode m, int node, int block)
+    : mode(m),
+      nodeId(std::min<long long>(std::max(node, 0), MAX_NODE)),
+      blockSize(std::min(std::max(block, 1), 1 << SEQ_BITS)),
+      instanceId(nextInstanceId.fetch_add(1)),
+      clock(0) {
     counter=1;
 
 }
 
+int Idgenerator ::claimSequences(int want, uint64_t& first){
+    const uint64_t seqMask = (1ULL << SEQ_BITS) - 1;
+    uint64_t cur = clock.load(std::memory_order_relaxed);
+    for (;;) {
+        // Never go backwards: if the wall clock lags (or we have borrowed
+        // ahead after exhausting a millisecond) keep counting from `cur`
+        uint64_t start = std::max(cur, nowSinceEpoch() << SEQ_BITS);
+        uint64_t room = (1ULL << SEQ_BITS) - (start & seqMask);
+        uint64_t take = std::min<uint64_t>((uint64_t)want, room);
+        if (clock.compare_exchange_weak(cur, start + take, std::memory_order_relaxed)) {
+            first = start;
+            return (int)take;
+        }
+    }
+}
+
+long long Idgenerator ::compose(uint64_t packed) const {
+    uint64_t ms = packed >> SEQ_BITS;
+    uint64_t seq = packed & ((1ULL << SEQ_BITS) - 1);
+    return (long long)((ms << (NODE_BITS + SEQ_BITS)) | ((uint64_t)nodeId << SEQ_BITS) | seq);
+}
+
 long long Idgenerator ::getNextId(){
-    return counter.fetch_add(1);
-}
\ No newline at end of file
+    if (mode == IdMode::Counter) return counter.fetch_add(1);
+
+    // Hot path: thread-local lease, no shared atomics
+    if (lease.owner != instanceId || lease.next == lease.end) {
+        uint64_t first;
+        int got = claimSequences(blockSize, first);
+        lease.owner = instanceId;
+        lease.next = first;
+        lease.end = first + got;
+    }
+    return compose(lease.next++);
+}
+
+int Idgenerator ::reserveRange(int count, long long& firstId){
+    if (count <= 0) return 0;
+    if (mode == IdMode::Counter) {
+        firstId = counter.fetch_add(count);
+        return count;
+    }
+    // Consecutive sequences within one millisecond are consecutive IDs
+    uint64_t first;
+    int got = claimSequences(count, first);
+    firstId = compose(first);
+    return got;
+}
+
+bool Idgenerator ::advancePast(long long id){
+    if (id < 0 || id == LLONG_MAX) return false;   // nothing comes after LLONG_MAX
+    if (mode == IdMode::Snowflake) {
+        // Re-pack (ms, seq) from the ID and move the clock past it
+        uint64_t packed = (((uint64_t)id >> (NODE_BITS + SEQ_BITS)) << SEQ_BITS)
+                        | ((uint64_t)id & ((1ULL << SEQ_BITS) - 1));
+        uint64_t cur = clock.load();
+        while (cur <= packed && !clock.compare_exchange_weak(cur, packed + 1)) {
+        }
+        return true;
+    }
+    long long current = counter.load();
+    while (current <= id && !counter.compare_exchange_weak(current, id + 1)) {
+    }
+    return true;
+}
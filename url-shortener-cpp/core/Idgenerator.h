@@ -2,18 +2,58 @@
 #define ID_GENERATOR_H
 
 #include<atomic>
+#include<cstdint>
+
+// How IDs are produced
+enum class IdMode {
+    Counter,    // process-wide counter starting at 1 (single instance only)
+    Snowflake   // [41-bit ms timestamp][10-bit node id][12-bit sequence]
+};
 
 class Idgenerator {
     private :
            std :: atomic <long long> counter;
 
+    // Snowflake mode. `clock` packs (ms since EPOCH_MS << SEQ_BITS | next
+    // sequence), so taking a block of sequences is one CAS, and a full
+    // millisecond rolls straight into the next one. Threads lease blocks of
+    // `blockSize` sequences and then issue IDs from a thread-local lease
+    // without touching shared state.
+    IdMode mode;
+    long long nodeId;
+    int blockSize;
+    uint64_t instanceId;                   // identifies leases of this generator
+    std :: atomic <uint64_t> clock;
+
+    // Claim up to `want` sequences in one millisecond: returns how many,
+    // and the packed (ms, seq) of the first
+    int claimSequences(int want, uint64_t& first);
+    long long compose(uint64_t packed) const;
+
 public: 
+    static constexpr int      NODE_BITS = 10;
+    static constexpr int      SEQ_BITS  = 12;
+    static constexpr long long MAX_NODE = (1LL << NODE_BITS) - 1;
+    static constexpr int64_t  EPOCH_MS  = 1704067200000LL;   // 2024-01-01T00:00:00Z
+
     Idgenerator();
 
+    // nodeId must be unique per instance (0..MAX_NODE) in Snowflake mode;
+    // blockSize = sequences each thread leases at a time
+    Idgenerator(IdMode mode, int nodeId = 0, int blockSize = 64);
+
     long long getNextId();
 
+    // Reserve up to `count` consecutive IDs with one atomic operation.
+    // Returns how many were reserved; the first one is stored in firstId.
+    int reserveRange(int count, long long& firstId);
+
+    // Make sure future IDs are greater than id (e.g. after reloading data).
+    // False, changing nothing, if id is negative or LLONG_MAX.
+    bool advancePast(long long id);
 
+    IdMode getMode() const { return mode; }
 
 };
 
-#endif
\ No newline at end of file
+#endif
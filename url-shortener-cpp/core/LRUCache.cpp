@@ -1,50 +1,397 @@
 #include "LRUCache.h"
+#include <functional>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 
-LRUCache::LRUCache(int cap) : capacity(cap) {}
+LRUCache::LRUCache(int cap, int numShards, CachePolicy pol)
+    : capacity(cap), policy(pol) {
+    if (numShards <= 0) {
+        // Round hardware concurrency up to a power of two, at most 64 shards
+        int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+        numShards = 1;
+        while (numShards < hw * 2 && numShards < 64) numShards <<= 1;
+        // ...but keep shards big enough to rank entries: a shard of one or
+        // two entries evicts on every miss, whatever its policy
+        while (numShards > 1 && cap / numShards < MIN_DEFAULT_SHARD_CAPACITY) numShards >>= 1;
+    }
+    // Never create shards that would have no capacity
+    numShards = std::max(1, std::min(numShards, std::max(1, cap)));
+
+    // Split the capacity budget; the first (cap % n) shards get one extra slot
+    shards.reserve(numShards);
+    for (int i = 0; i < numShards; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->capacity = cap / numShards + (i < cap % numShards ? 1 : 0);
+        if (policy == CachePolicy::CLOCK && shard->capacity > 0) {
+            shard->slots.reset(new ClockSlot[shard->capacity]);
+            shard->index.reserve(shard->capacity);
+        }
+        if (policy == CachePolicy::TINYLFU && shard->capacity > 0) {
+            // 1% window; of the main space, 80% protected
+            shard->windowCapacity = std::max(1, shard->capacity / 100);
+            shard->protectedCapacity = (shard->capacity - shard->windowCapacity) * 4 / 5;
+            shard->sketch = std::make_unique<FrequencySketch>(shard->capacity);
+        }
+        shards.push_back(std::move(shard));
+    }
+}
+
+size_t LRUCache::shardIndex(std::string_view key) const {
+    size_t h = std::hash<std::string_view>{}(key);
+    // Mix the high bits in so weak std::hash implementations still spread
+    h ^= h >> 29;
+    return h % shards.size();
+}
+
+LRUCache::Shard& LRUCache::shardFor(std::string_view key) const {
+    return *shards[shardIndex(key)];
+}
+
+// Key indices in shard order, with starts[i]..starts[i + 1] the run of shard i
+void LRUCache::groupByShard(const std::vector<std::string_view>& keys,
+                            std::vector<uint32_t>& order, std::vector<uint32_t>& starts) const {
+    thread_local std::vector<uint32_t> shardOf;
+    shardOf.resize(keys.size());
+    starts.assign(shards.size() + 1, 0);
+    for (size_t i = 0; i < keys.size(); i++) {
+        shardOf[i] = (uint32_t)shardIndex(keys[i]);
+        starts[shardOf[i] + 1]++;
+    }
+    for (size_t i = 1; i < starts.size(); i++) starts[i] += starts[i - 1];
+    order.resize(keys.size());
+    std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+    for (size_t i = 0; i < keys.size(); i++) order[next[shardOf[i]]++] = (uint32_t)i;
+}
+
+// Lookups need the shard lock exclusively, except under CLOCK
+template <class Fn>
+void LRUCache::withLookupLock(Shard& s, Fn&& fn) {
+    if (policy == CachePolicy::CLOCK) {
+        std::shared_lock<std::shared_mutex> lock(s.mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::CacheLock);
+        fn();
+    } else {
+        std::unique_lock<std::shared_mutex> lock(s.mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::CacheLock);
+        fn();
+    }
+}
+
+// Shard lock held
+bool LRUCache::getLocked(Shard& s, std::string_view key, UrlHandle& value) {
+    return policy == CachePolicy::CLOCK   ? getClock(s, key, value)
+         : policy == CachePolicy::TINYLFU ? getTinyLfu(s, key, value)
+                                          : getLru(s, key, value);
+}
+
+// Shard lock held exclusively
+void LRUCache::putLocked(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt) {
+    if (policy == CachePolicy::CLOCK) putClock(s, key, std::move(value), expiresAt);
+    else if (policy == CachePolicy::TINYLFU) putTinyLfu(s, key, std::move(value), expiresAt);
+    else putLru(s, key, std::move(value), expiresAt);
+}
+
+bool LRUCache::expired(int64_t expiresAt) {
+    if (expiresAt == 0) return false;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() > expiresAt;
+}
+
+bool LRUCache::get(std::string_view key, UrlHandle& value) {
+    Shard& s = shardFor(key);
+    bool hit = false;
+    withLookupLock(s, [&] { hit = getLocked(s, key, value); });
+    (hit ? s.hits : s.misses).fetch_add(1, std::memory_order_relaxed);
+    return hit;
+}
+
+size_t LRUCache::getMany(const std::vector<std::string_view>& keys, std::vector<UrlHandle>& values) {
+    values.assign(keys.size(), UrlHandle());
+    thread_local std::vector<uint32_t> order, starts;
+    groupByShard(keys, order, starts);
+    size_t hits = 0;
+    for (size_t shard = 0; shard < shards.size(); shard++) {
+        if (starts[shard] == starts[shard + 1]) continue;
+        Shard& s = *shards[shard];
+        size_t shardHits = 0;
+        withLookupLock(s, [&] {
+            for (uint32_t k = starts[shard]; k < starts[shard + 1]; k++) {
+                shardHits += getLocked(s, keys[order[k]], values[order[k]]);
+            }
+        });
+        s.hits.fetch_add(shardHits, std::memory_order_relaxed);
+        s.misses.fetch_add(starts[shard + 1] - starts[shard] - shardHits, std::memory_order_relaxed);
+        hits += shardHits;
+    }
+    return hits;
+}
+
+bool LRUCache::get(std::string_view key, std::string& value) {
+    UrlHandle url;
+    if (!get(key, url)) return false;
+    value.assign(url.view());
+    return true;
+}
+
+void LRUCache::put(std::string_view key, UrlHandle value, int64_t expiresAtMs) {
+    Shard& s = shardFor(key);
+    if (s.capacity <= 0) return;
+    std::unique_lock<std::shared_mutex> lock(s.mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::CacheLock);
+    putLocked(s, key, std::move(value), expiresAtMs);
+}
+
+void LRUCache::putMany(const std::vector<std::string_view>& keys, const std::vector<UrlHandle>& values,
+                       const std::vector<int64_t>& expiresAtMs) {
+    thread_local std::vector<uint32_t> order, starts;
+    groupByShard(keys, order, starts);
+    for (size_t shard = 0; shard < shards.size(); shard++) {
+        Shard& s = *shards[shard];
+        if (starts[shard] == starts[shard + 1] || s.capacity <= 0) continue;
+        std::unique_lock<std::shared_mutex> lock(s.mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::CacheLock);
+        for (uint32_t k = starts[shard]; k < starts[shard + 1]; k++) {
+            if (!values[order[k]].empty()) putLocked(s, keys[order[k]], values[order[k]], expiresAtMs[order[k]]);
+        }
+    }
+}
+
+void LRUCache::put(std::string_view key, std::string_view value, int64_t expiresAtMs) {
+    put(key, UrlHandle(value), expiresAtMs);
+}
+
+// ─────────────────────────────────────────────
+// LRU engine
+// ─────────────────────────────────────────────
+
+bool LRUCache::getLru(Shard& s, std::string_view key, UrlHandle& value) {
+    auto it = s.cache.find(key);
+    if (it == s.cache.end() || expired(it->second.expiresAt)) return false;
+
+    value = it->second.value;
+    // Move to front without reallocating the list node
+    s.order.splice(s.order.begin(), s.order, it->second.pos);
+    return true;
+}
+
+void LRUCache::putLru(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt) {
+    auto it = s.cache.find(key);
+
+    if (it != s.cache.end()) {
+        s.order.splice(s.order.begin(), s.order, it->second.pos);
+        it->second.value = std::move(value);
+        it->second.expiresAt = expiresAt;
+        return;
+    }
+
+    if ((int)s.cache.size() >= s.capacity) {
+        // Recycle the evicted entry's list and map nodes for the new key
+        auto node = s.cache.extract(std::string_view(s.order.back()));
+        s.order.splice(s.order.begin(), s.order, std::prev(s.order.end()));
+        s.order.front().assign(key.data(), key.size());
+        node.key() = s.order.front();
+        node.mapped() = LruEntry{std::move(value), expiresAt, s.order.begin()};
+        s.cache.insert(std::move(node));
+        s.evictions.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    s.order.emplace_front(key);
+    s.cache.emplace(std::string_view(s.order.front()), LruEntry{std::move(value), expiresAt, s.order.begin()});
+}
 
-bool LRUCache::get(const std::string& key, std::string& value) {
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = cache.find(key);
-    if (it == cache.end()) return false;
+// ─────────────────────────────────────────────
+// CLOCK engine
+// ─────────────────────────────────────────────
 
-    value = it->second.first;
-    order.erase(it->second.second);
-    order.push_front(key);
-    it->second.second = order.begin();
+bool LRUCache::getClock(Shard& s, std::string_view key, UrlHandle& value) {
+    auto it = s.index.find(key);
+    if (it == s.index.end()) return false;
+
+    ClockSlot& slot = s.slots[it->second];
+    if (expired(slot.expiresAt)) return false;
+    // Only write the bit when it changes, so hot keys don't bounce the cache line
+    if (!slot.referenced.load(std::memory_order_relaxed)) {
+        slot.referenced.store(true, std::memory_order_relaxed);
+    }
+    value = slot.value;
     return true;
 }
 
-void LRUCache::put(const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = cache.find(key);
+// Advance the hand, giving referenced slots a second chance.
+// Caller holds the exclusive lock and the shard is full.
+int LRUCache::clockVictim(Shard& s) {
+    for (;;) {
+        ClockSlot& slot = s.slots[s.hand];
+        int current = s.hand;
+        s.hand = (s.hand + 1) % s.capacity;
+        if (!slot.referenced.load(std::memory_order_relaxed)) return current;
+        slot.referenced.store(false, std::memory_order_relaxed);
+    }
+}
+
+void LRUCache::putClock(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt) {
+    auto it = s.index.find(key);
 
-    if (it != cache.end()) {
-        order.erase(it->second.second);
-        order.push_front(key);
-        it->second = {value, order.begin()};
+    if (it != s.index.end()) {
+        ClockSlot& slot = s.slots[it->second];
+        slot.value = std::move(value);
+        slot.expiresAt = expiresAt;
+        slot.referenced.store(true, std::memory_order_relaxed);
         return;
     }
 
-    if ((int)cache.size() == capacity) {
-        std::string lruKey = order.back();
-        order.pop_back();
-        cache.erase(lruKey);
+    int idx;
+    decltype(s.index)::node_type node;   // the victim's index node, reused below
+    if (!s.freeSlots.empty()) {
+        idx = s.freeSlots.back();
+        s.freeSlots.pop_back();
+    } else if (s.highWater < s.capacity) {
+        idx = s.highWater++;
+    } else {
+        idx = clockVictim(s);
+        node = s.index.extract(std::string_view(s.slots[idx].key));
+        s.evictions.fetch_add(1, std::memory_order_relaxed);
     }
 
-    order.push_front(key);
-    cache[key] = {value, order.begin()};
+    ClockSlot& slot = s.slots[idx];
+    slot.key.assign(key.data(), key.size());
+    slot.value = std::move(value);
+    slot.expiresAt = expiresAt;
+    // New entries start unreferenced: they must earn their second chance
+    slot.referenced.store(false, std::memory_order_relaxed);
+    if (node) {
+        node.key() = slot.key;
+        s.index.insert(std::move(node));
+    } else {
+        s.index.emplace(std::string_view(slot.key), idx);
+    }
+}
+
+// ─────────────────────────────────────────────
+// TINYLFU engine
+// ─────────────────────────────────────────────
+
+std::list<std::string>& LRUCache::segmentList(Shard& s, Segment segment) {
+    return segment == Segment::Window ? s.order
+         : segment == Segment::Probation ? s.probation : s.protectedKeys;
 }
 
-void LRUCache::remove(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = cache.find(key);
-    if (it != cache.end()) {
-        order.erase(it->second.second);
-        cache.erase(it);
+// Every lookup, hit or miss, counts towards the key's popularity
+bool LRUCache::getTinyLfu(Shard& s, std::string_view key, UrlHandle& value) {
+    s.sketch->add(key);
+    auto it = s.cache.find(key);
+    if (it == s.cache.end() || expired(it->second.expiresAt)) return false;
+
+    value = it->second.value;
+    touchTinyLfu(s, it->second);
+    return true;
+}
+
+// A hit moves the entry to the front of its list; a probation entry is
+// promoted to protected, pushing protected's LRU entry back to probation
+void LRUCache::touchTinyLfu(Shard& s, LruEntry& entry) {
+    if (entry.segment != Segment::Probation) {
+        std::list<std::string>& list = segmentList(s, entry.segment);
+        list.splice(list.begin(), list, entry.pos);
+        return;
+    }
+    s.protectedKeys.splice(s.protectedKeys.begin(), s.probation, entry.pos);
+    entry.segment = Segment::Protected;
+    if ((int)s.protectedKeys.size() > s.protectedCapacity) {
+        auto demoted = std::prev(s.protectedKeys.end());
+        s.cache.find(std::string_view(*demoted))->second.segment = Segment::Probation;
+        s.probation.splice(s.probation.begin(), s.protectedKeys, demoted);
+    }
+}
+
+void LRUCache::evictTinyLfu(Shard& s, std::list<std::string>& from, std::list<std::string>::iterator pos) {
+    s.cache.erase(std::string_view(*pos));   // before the list node owning its key
+    from.erase(pos);
+    s.evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LRUCache::putTinyLfu(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt) {
+    auto it = s.cache.find(key);
+
+    if (it != s.cache.end()) {
+        it->second.value = std::move(value);
+        it->second.expiresAt = expiresAt;
+        touchTinyLfu(s, it->second);
+        return;
+    }
+
+    s.order.emplace_front(key);
+    s.cache.emplace(std::string_view(s.order.front()), LruEntry{std::move(value), expiresAt, s.order.begin()});
+    if ((int)s.order.size() <= s.windowCapacity) return;
+
+    // The window's LRU entry moves to the main space if there is room, or
+    // if it is more popular than the entry it would displace there
+    auto candidate = std::prev(s.order.end());
+    int mainSize = (int)(s.probation.size() + s.protectedKeys.size());
+    bool admit = mainSize < s.capacity - s.windowCapacity;
+    if (!admit) {
+        std::list<std::string>& victims = s.probation.empty() ? s.protectedKeys : s.probation;
+        if (!victims.empty() && s.sketch->estimate(*candidate) > s.sketch->estimate(victims.back())) {
+            evictTinyLfu(s, victims, std::prev(victims.end()));
+            admit = true;
+        }
+    }
+    if (admit) {
+        s.cache.find(std::string_view(*candidate))->second.segment = Segment::Probation;
+        s.probation.splice(s.probation.begin(), s.order, candidate);
+    } else {
+        evictTinyLfu(s, s.order, candidate);
+        s.rejections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LRUCache::remove(std::string_view key) {
+    Shard& s = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(s.mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::CacheLock);
+
+    if (policy == CachePolicy::CLOCK) {
+        auto it = s.index.find(key);
+        if (it != s.index.end()) {
+            int idx = it->second;
+            s.index.erase(it);            // before its key's storage is cleared
+            ClockSlot& slot = s.slots[idx];
+            slot.key.clear();
+            slot.value = UrlHandle();
+            slot.referenced.store(false, std::memory_order_relaxed);
+            s.freeSlots.push_back(idx);
+        }
+        return;
+    }
+
+    auto it = s.cache.find(key);
+    if (it != s.cache.end()) {
+        auto pos = it->second.pos;
+        std::list<std::string>& list = segmentList(s, it->second.segment);   // `order` under LRU
+        s.cache.erase(it);                // before the list node owning its key
+        list.erase(pos);
     }
 }
 
 int LRUCache::size() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return (int)cache.size();
+    int total = 0;
+    for (const auto& s : shards) {
+        std::shared_lock<std::shared_mutex> lock(s->mtx);
+        total += (int)(policy == CachePolicy::CLOCK ? s->index.size() : s->cache.size());
+    }
+    return total;
+}
+
+CacheStats LRUCache::stats() const {
+    CacheStats total;
+    for (const auto& s : shards) {
+        total.hits += s->hits.load(std::memory_order_relaxed);
+        total.misses += s->misses.load(std::memory_order_relaxed);
+        total.evictions += s->evictions.load(std::memory_order_relaxed);
+        total.rejections += s->rejections.load(std::memory_order_relaxed);
+    }
+    return total;
 }
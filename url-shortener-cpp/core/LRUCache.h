@@ -4,32 +4,164 @@
 #include <unordered_map>
 #include <list>
 #include <string>
+#include <string_view>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Metrics.h"
+#include "UrlHandle.h"
+#include "HeavyHitters.h"
 
+// Eviction engine used by each cache shard
+enum class CachePolicy {
+    LRU,    // exact recency order; a hit splices the list under an exclusive lock
+    CLOCK,  // second-chance; a hit only sets a reference bit under a shared lock
+    TINYLFU // W-TinyLFU: a miss only displaces an entry a frequency sketch rates
+            // less popular, so a scan of one-off codes cannot flush the hot set
+};
+
+// Lookups answered from the cache vs. not, since construction
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;      // entries pushed out to make room
+    uint64_t rejections = 0;     // TINYLFU: new entries dropped as less popular than the victim
+};
+
+// Sharded cache: keys are spread over independent shards by hash,
+// each with its own lock and capacity budget, so concurrent redirects
+// for different codes do not queue on a single mutex.
+//
+// Values are UrlHandles, so a hit hands out the stored URL by bumping a
+// reference count. Keys are stored once (in the LRU list or the CLOCK
+// slot) and the indexes hold string_views of them, so lookups take a
+// string_view and a hit allocates nothing.
+//
+// TINYLFU keeps ~1% of a shard as an LRU window that admits every miss and
+// the rest as a segmented LRU (probation, then protected once hit again).
+// An entry leaving the window enters the main space only if the shard's
+// FrequencySketch, fed by every lookup, estimates it more popular than the
+// probation LRU entry it would evict.
 class LRUCache {
 private:
+    static constexpr int MIN_DEFAULT_SHARD_CAPACITY = 64;
+
+    // Which TINYLFU list an entry is on
+    enum class Segment : uint8_t { Window, Probation, Protected };
+
+    // LRU entry; expiresAt is wall-clock ms, 0 = never
+    struct LruEntry {
+        UrlHandle value;
+        int64_t expiresAt;
+        std::list<std::string>::iterator pos;
+        Segment segment = Segment::Window;   // TINYLFU only
+    };
+
+    // CLOCK slot; `referenced` is set by readers holding only a shared lock
+    struct ClockSlot {
+        std::string key;
+        UrlHandle value;
+        int64_t expiresAt = 0;
+        std::atomic<bool> referenced{false};
+    };
+
+    struct Shard {
+        int capacity = 0;
+        mutable std::shared_mutex mtx;
+        std::atomic<uint64_t> hits{0}, misses{0};     // next to mtx, whose line get() writes anyway
+        std::atomic<uint64_t> evictions{0}, rejections{0};
+
+        // LRU engine: `order` owns the keys, most recent first
+        std::list<std::string> order;
+        std::unordered_map<std::string_view, LruEntry> cache;   // views into `order`
+
+        // TINYLFU engine: `order` is the window, `cache` indexes all three lists
+        std::list<std::string> probation, protectedKeys;
+        int windowCapacity = 0, protectedCapacity = 0;
+        std::unique_ptr<FrequencySketch> sketch;
+
+        // CLOCK engine: fixed slot array swept by a hand
+        std::unique_ptr<ClockSlot[]> slots;
+        std::unordered_map<std::string_view, int> index;   // key (view into its slot) -> slot
+        std::vector<int> freeSlots;                   // slots released by remove()
+        int highWater = 0;                            // slots ever handed out
+        int hand = 0;
+    };
+
     int capacity;
-    std::list<std::string> order;
-    std::unordered_map<
-        std::string,
-        std::pair<std::string, std::list<std::string>::iterator>
-    > cache;
-    mutable std::mutex mtx;
+    CachePolicy policy;
+    std::vector<std::unique_ptr<Shard>> shards;
+    Metrics* metrics = nullptr;       // lock hold times, if set
+
+    size_t shardIndex(std::string_view key) const;
+    Shard& shardFor(std::string_view key) const;
+    void groupByShard(const std::vector<std::string_view>& keys,
+                      std::vector<uint32_t>& order, std::vector<uint32_t>& starts) const;
+    static bool expired(int64_t expiresAt);
+
+    // Engines below run with the shard lock held (see withLookupLock)
+    template <class Fn>
+    void withLookupLock(Shard& s, Fn&& fn);
+    bool getLocked(Shard& s, std::string_view key, UrlHandle& value);
+    void putLocked(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt);
+
+    bool getLru(Shard& s, std::string_view key, UrlHandle& value);
+    void putLru(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt);
+    bool getClock(Shard& s, std::string_view key, UrlHandle& value);
+    void putClock(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt);
+    int  clockVictim(Shard& s);
+    bool getTinyLfu(Shard& s, std::string_view key, UrlHandle& value);
+    void putTinyLfu(Shard& s, std::string_view key, UrlHandle value, int64_t expiresAt);
+    void touchTinyLfu(Shard& s, LruEntry& entry);
+    void evictTinyLfu(Shard& s, std::list<std::string>& from, std::list<std::string>::iterator pos);
+    static std::list<std::string>& segmentList(Shard& s, Segment segment);
 
 public:
-    LRUCache(int cap);
+    // cap = total entries across all shards
+    // numShards = 0 picks a default based on hardware concurrency, capped so
+    // each shard holds at least MIN_DEFAULT_SHARD_CAPACITY entries
+    LRUCache(int cap, int numShards = 0, CachePolicy policy = CachePolicy::LRU);
+
+    // Returns true and fills value if key found and not expired; false otherwise.
+    // The handle shares the cached URL (no copy, no allocation).
+    bool get(std::string_view key, UrlHandle& value);
 
-    // Returns true and fills value if key found; false otherwise
-    bool get(const std::string& key, std::string& value);
+    // Same, copying the URL into a string
+    bool get(std::string_view key, std::string& value);
 
-    // Insert or update key-value pair; evicts LRU if at capacity
-    void put(const std::string& key, const std::string& value);
+    // get() for many keys, taking each shard's lock once: values[i] is
+    // empty on a miss. Returns the number of hits.
+    size_t getMany(const std::vector<std::string_view>& keys, std::vector<UrlHandle>& values);
+
+    // Insert or update key-value pair; evicts within the key's shard if at capacity.
+    // expiresAtMs = wall-clock ms after which the entry is never served (0 = never)
+    void put(std::string_view key, UrlHandle value, int64_t expiresAtMs = 0);
+    void put(std::string_view key, std::string_view value, int64_t expiresAtMs = 0);
+
+    // put() for many entries, taking each shard's lock once; empty values
+    // are skipped
+    void putMany(const std::vector<std::string_view>& keys, const std::vector<UrlHandle>& values,
+                 const std::vector<int64_t>& expiresAtMs);
 
     // Remove a key (used when URL expires)
-    void remove(const std::string& key);
+    void remove(std::string_view key);
 
     // Current number of cached entries
     int size() const;
+
+    // Hit, miss, eviction and rejection counts summed over the shards
+    CacheStats stats() const;
+
+    // Report shard lock hold times to `m` (call before sharing the cache)
+    void setMetrics(Metrics* m) { metrics = m; }
+
+    // Total capacity budget, number of independent shards, eviction engine
+    int getCapacity() const { return capacity; }
+    int shardCount() const { return (int)shards.size(); }
+    CachePolicy getPolicy() const { return policy; }
 };
 
-#endif
\ No newline at end of file
+#endif
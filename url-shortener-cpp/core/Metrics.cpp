@@ -0,0 +1,216 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+std::atomic<uint64_t> nextInstanceId{1};
+
+// One cached block per thread, valid for the Metrics instance it names
+struct CachedBlock {
+    uint64_t owner = 0;      // Metrics::instanceId
+    void* block = nullptr;
+};
+thread_local CachedBlock cachedBlock;
+
+struct CounterInfo {
+    const char* name;
+    const char* help;
+};
+
+const CounterInfo COUNTERS[(int)MetricCounter::COUNT] = {
+    {"shortens_total", "Short codes created or returned (shortenUrl and shortenBatch items)"},
+    {"shorten_failures_total", "Shorten requests rejected (rate limit, invalid or taken alias)"},
+    {"redirects_total", "redirect calls"},
+    {"redirects_not_found_total", "redirect calls for unknown or expired codes"},
+    {"rate_limited_total", "Requests refused by the rate limiter"},
+};
+
+const CounterInfo TIMERS[(int)MetricTimer::COUNT] = {
+    {"shorten_duration_seconds", "shortenUrl / shortenBatch call latency (sampled)"},
+    {"redirect_duration_seconds", "redirect latency (sampled)"},
+    {"cache_lock_hold_seconds", "Time a cache shard lock is held (sampled)"},
+    {"repository_lock_hold_seconds", "Time a repository lock is held (sampled)"},
+    {"rate_limiter_lock_hold_seconds", "Time a rate-limiter shard lock is held (sampled)"},
+};
+
+uint32_t sampleEvery(MetricTimer t) {
+    return t == MetricTimer::Shorten || t == MetricTimer::Redirect ? Metrics::SAMPLE_REQUESTS
+                                                                   : Metrics::SAMPLE_LOCKS;
+}
+
+uint64_t percentileOf(const std::vector<uint64_t>& buckets, uint64_t total, double q,
+                      uint64_t (*upper)(size_t), uint64_t max) {
+    if (total == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(q * (double)total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(upper(i), max);
+    }
+    return max;
+}
+
+} // namespace
+
+Metrics::ThreadBlock::ThreadBlock() {
+    for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+    for (auto& timer : buckets) {
+        for (auto& b : timer) b.store(0, std::memory_order_relaxed);
+    }
+    for (auto& s : sums) s.store(0, std::memory_order_relaxed);
+    for (auto& m : maxes) m.store(0, std::memory_order_relaxed);
+}
+
+Metrics::Metrics() : instanceId(nextInstanceId.fetch_add(1)) {}
+
+Metrics::ThreadBlock& Metrics::local() {
+    if (cachedBlock.owner != instanceId) {
+        std::lock_guard<std::mutex> lock(registryMtx);
+        std::unique_ptr<ThreadBlock>& block = blocks[std::this_thread::get_id()];
+        if (!block) block = std::make_unique<ThreadBlock>();
+        cachedBlock.owner = instanceId;
+        cachedBlock.block = block.get();
+    }
+    return *static_cast<ThreadBlock*>(cachedBlock.block);
+}
+
+// Same bucketing as bench::Histogram: values below 16 exactly, then 16
+// linear steps per power of two
+size_t Metrics::bucketOf(uint64_t ns) {
+    const uint64_t sub = 1u << SUB_BITS;
+    if (ns < sub) return (size_t)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int shift = msb - SUB_BITS;
+    size_t i = (size_t)(shift + 1) * sub + (size_t)((ns >> shift) - sub);
+    return std::min(i, (size_t)BUCKETS - 1);
+}
+
+uint64_t Metrics::bucketUpper(size_t i) {
+    const uint64_t sub = 1u << SUB_BITS;
+    if (i < sub) return i;
+    int shift = (int)(i / sub) - 1;
+    return ((sub + i % sub + 1) << shift) - 1;
+}
+
+void Metrics::count(MetricCounter c, uint64_t n) {
+    bump(local().counters[(int)c], n);
+}
+
+Metrics::Scope::Scope(Metrics* metrics, MetricTimer t) : timer(t) {
+    if (!metrics) return;
+    ThreadBlock& b = metrics->local();
+    if (++b.ticks[(int)t] < sampleEvery(t)) return;
+    b.ticks[(int)t] = 0;
+    block = &b;
+    start = std::chrono::steady_clock::now();
+}
+
+Metrics::Scope::~Scope() {
+    if (!block) return;
+    uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    ThreadBlock& b = *static_cast<ThreadBlock*>(block);
+    int t = (int)timer;
+    bump(b.buckets[t][bucketOf(ns)], 1);
+    bump(b.sums[t], ns);
+    if (ns > b.maxes[t].load(std::memory_order_relaxed)) b.maxes[t].store(ns, std::memory_order_relaxed);
+}
+
+// ── Export ──
+
+uint64_t Metrics::counterValue(MetricCounter c) const {
+    std::lock_guard<std::mutex> lock(registryMtx);
+    uint64_t total = 0;
+    for (const auto& [id, b] : blocks) total += b->counters[(int)c].load(std::memory_order_relaxed);
+    return total;
+}
+
+void Metrics::merged(MetricTimer t, std::vector<uint64_t>& buckets, uint64_t& sum, uint64_t& max) const {
+    buckets.assign(BUCKETS, 0);
+    sum = max = 0;
+    std::lock_guard<std::mutex> lock(registryMtx);
+    for (const auto& [id, b] : blocks) {
+        for (int i = 0; i < BUCKETS; i++) buckets[i] += b->buckets[(int)t][i].load(std::memory_order_relaxed);
+        sum += b->sums[(int)t].load(std::memory_order_relaxed);
+        max = std::max(max, b->maxes[(int)t].load(std::memory_order_relaxed));
+    }
+}
+
+Metrics::LatencySummary Metrics::latency(MetricTimer t) const {
+    std::vector<uint64_t> buckets;
+    LatencySummary s;
+    merged(t, buckets, s.sumNs, s.max);
+    for (uint64_t c : buckets) s.samples += c;
+    s.p50 = percentileOf(buckets, s.samples, 0.50, bucketUpper, s.max);
+    s.p99 = percentileOf(buckets, s.samples, 0.99, bucketUpper, s.max);
+    s.p999 = percentileOf(buckets, s.samples, 0.999, bucketUpper, s.max);
+    return s;
+}
+
+std::string Metrics::prometheusText(const std::vector<MetricGauge>& gauges) const {
+    std::ostringstream out;
+    out.precision(15);   // byte and entry counts print in full
+    for (const MetricGauge& g : gauges) {
+        out << "# HELP urlshortener_" << g.name << " " << g.help << "\n"
+            << "# TYPE urlshortener_" << g.name << " " << (g.counter ? "counter" : "gauge") << "\n"
+            << "urlshortener_" << g.name << " " << g.value << "\n";
+    }
+#ifndef URL_SHORTENER_NO_METRICS
+    for (int c = 0; c < (int)MetricCounter::COUNT; c++) {
+        out << "# HELP urlshortener_" << COUNTERS[c].name << " " << COUNTERS[c].help << "\n"
+            << "# TYPE urlshortener_" << COUNTERS[c].name << " counter\n"
+            << "urlshortener_" << COUNTERS[c].name << " " << counterValue((MetricCounter)c) << "\n";
+    }
+
+    // Histogram "le" bounds at powers of two from 128 ns (the fine buckets
+    // stay internal)
+    std::vector<uint64_t> buckets;
+    for (int t = 0; t < (int)MetricTimer::COUNT; t++) {
+        uint64_t sum, max;
+        merged((MetricTimer)t, buckets, sum, max);
+        const char* name = TIMERS[t].name;
+        out << "# HELP urlshortener_" << name << " " << TIMERS[t].help << "\n"
+            << "# TYPE urlshortener_" << name << " histogram\n";
+        uint64_t cumulative = 0, total = 0;
+        for (uint64_t c : buckets) total += c;
+        size_t i = 0;
+        for (uint64_t bound = 128; bound <= (1ULL << 34); bound <<= 1) {
+            while (i < buckets.size() && bucketUpper(i) < bound) cumulative += buckets[i++];
+            out << "urlshortener_" << name << "_bucket{le=\"" << bound / 1e9 << "\"} " << cumulative << "\n";
+            if (cumulative == total) break;
+        }
+        out << "urlshortener_" << name << "_bucket{le=\"+Inf\"} " << total << "\n"
+            << "urlshortener_" << name << "_sum " << sum / 1e9 << "\n"
+            << "urlshortener_" << name << "_count " << total << "\n";
+    }
+#endif
+    return out.str();
+}
+
+std::string Metrics::json(const std::vector<MetricGauge>& gauges) const {
+    std::ostringstream out;
+    out.precision(15);
+    out << "{";
+    bool first = true;
+    for (const MetricGauge& g : gauges) {
+        out << (first ? "" : ", ") << "\"" << g.name << "\": " << g.value;
+        first = false;
+    }
+#ifndef URL_SHORTENER_NO_METRICS
+    for (int c = 0; c < (int)MetricCounter::COUNT; c++) {
+        out << (first ? "" : ", ") << "\"" << COUNTERS[c].name << "\": " << counterValue((MetricCounter)c);
+        first = false;
+    }
+    for (int t = 0; t < (int)MetricTimer::COUNT; t++) {
+        LatencySummary s = latency((MetricTimer)t);
+        out << (first ? "" : ", ") << "\"" << TIMERS[t].name << "\": {\"samples\": " << s.samples
+            << ", \"p50_ns\": " << s.p50 << ", \"p99_ns\": " << s.p99 << ", \"p999_ns\": " << s.p999
+            << ", \"max_ns\": " << s.max << ", \"mean_ns\": " << (s.samples ? s.sumNs / s.samples : 0) << "}";
+        first = false;
+    }
+#endif
+    out << "}";
+    return out.str();
+}
@@ -0,0 +1,137 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Event counts kept per thread
+enum class MetricCounter {
+    Shortens,            // shorten requests that stored or returned a code
+    ShortenFailures,     // rejected: rate limit, bad or taken alias
+    Redirects,
+    RedirectsNotFound,
+    RateLimited,         // requests refused by the rate limiter
+    COUNT
+};
+
+// Sampled durations
+enum class MetricTimer {
+    Shorten,             // whole shortenUrl / shortenBatch call
+    Redirect,            // whole redirect / redirectMany call
+    CacheLock,           // time a cache shard lock is held
+    RepositoryLock,      // time a repository partition lock is held
+    RateLimiterLock,     // time a rate-limiter shard lock is held
+    COUNT
+};
+
+// Point-in-time values supplied by the caller when exporting
+struct MetricGauge {
+    std::string name;    // without the "urlshortener_" prefix
+    std::string help;
+    double value;
+    bool counter;        // monotonic (exported as a Prometheus counter)
+};
+
+// Low-overhead instrumentation for the service and its components.
+//
+// Each thread updates its own block of counters and histograms with plain
+// relaxed loads and stores (no read-modify-write, no lock); export sums the
+// blocks. Timers only read the clock for every SAMPLE_REQUESTS-th request
+// and every SAMPLE_LOCKS-th lock hold, so a timed histogram's count is a
+// sample while the counters are exact. Histograms have 16 linear buckets
+// per power of two (at most 6.25% error).
+//
+// Compiling with -DURL_SHORTENER_NO_METRICS turns METRIC_COUNT, METRIC_ADD
+// and METRIC_TIME_SCOPE into nothing; export then shows only the gauges.
+class Metrics {
+public:
+    static constexpr uint32_t SAMPLE_REQUESTS = 16;
+    static constexpr uint32_t SAMPLE_LOCKS = 64;
+    static constexpr int SUB_BITS = 4;
+    static constexpr int BUCKETS = 48 << SUB_BITS;   // up to 2^48 ns
+
+    struct LatencySummary {
+        uint64_t samples = 0;
+        uint64_t sumNs = 0;
+        uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0;
+    };
+
+    Metrics();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void count(MetricCounter c, uint64_t n = 1);
+
+    // count() on an optional instance (components hold a Metrics*)
+    static void increment(Metrics* metrics, MetricCounter c, uint64_t n = 1) {
+        if (metrics) metrics->count(c, n);
+    }
+
+    // Times its scope if this thread's turn for `timer` has come
+    class Scope {
+    public:
+        Scope(Metrics* metrics, MetricTimer timer);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        void* block = nullptr;            // ThreadBlock, only when sampling
+        MetricTimer timer;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    uint64_t counterValue(MetricCounter c) const;
+    LatencySummary latency(MetricTimer t) const;
+
+    // Prometheus text exposition format (version 0.0.4)
+    std::string prometheusText(const std::vector<MetricGauge>& gauges) const;
+    std::string json(const std::vector<MetricGauge>& gauges) const;
+
+private:
+    struct ThreadBlock {
+        std::atomic<uint64_t> counters[(int)MetricCounter::COUNT];
+        std::atomic<uint64_t> buckets[(int)MetricTimer::COUNT][BUCKETS];
+        std::atomic<uint64_t> sums[(int)MetricTimer::COUNT];
+        std::atomic<uint64_t> maxes[(int)MetricTimer::COUNT];
+        uint32_t ticks[(int)MetricTimer::COUNT] = {};   // owner only
+
+        ThreadBlock();
+    };
+
+    uint64_t instanceId;
+    mutable std::mutex registryMtx;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadBlock>> blocks;   // kept after the thread exits
+
+    ThreadBlock& local();
+    void merged(MetricTimer t, std::vector<uint64_t>& buckets, uint64_t& sum, uint64_t& max) const;
+
+    static size_t bucketOf(uint64_t ns);
+    static uint64_t bucketUpper(size_t i);
+    static void bump(std::atomic<uint64_t>& a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+
+#ifndef URL_SHORTENER_NO_METRICS
+#define METRIC_COUNT(metrics, counter) Metrics::increment(metrics, counter)
+#define METRIC_ADD(metrics, counter, n) Metrics::increment(metrics, counter, n)
+#define METRIC_TIME_SCOPE(metrics, timer) \
+    Metrics::Scope METRICS_CONCAT(metricsScope, __LINE__)(metrics, timer)
+#else
+#define METRIC_COUNT(metrics, counter) ((void)0)
+#define METRIC_ADD(metrics, counter, n) ((void)0)
+#define METRIC_TIME_SCOPE(metrics, timer) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,383 @@
+#include "PartitionedRepository.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+
+// Keys moved per moveMtx hold, so writers to moving keys wait briefly
+constexpr size_t MIGRATION_BATCH = 256;
+
+} // namespace
+
+PartitionedRepository::PartitionedRepository(int virtualNodes, HashAlgorithm algorithm)
+    : ring(virtualNodes, algorithm), previousRing(virtualNodes, algorithm) {
+    partitions[-1] = std::make_unique<UrlRepository>();
+}
+
+PartitionedRepository::~PartitionedRepository() {
+    waitForMigration();
+}
+
+bool PartitionedRepository::enablePersistence(const PersistenceOptions& options) {
+    auto lock = writeTopology();
+    if (!ring.getNodes().empty()) return false;
+    persistence = options;
+    return partitions.at(-1)->enablePersistence(options);
+}
+
+bool PartitionedRepository::enableColdTier(const ColdTierOptions& options) {
+    auto lock = writeTopology();
+    if (!ring.getNodes().empty()) return false;
+    coldTier = options;
+    return partitions.at(-1)->enableColdTier(options);
+}
+
+// Partitions are never destroyed, so the slow passes run without holding
+// the topology lock (an addNode waiting on it would stall every lookup)
+size_t PartitionedRepository::demoteIdle() {
+    std::vector<UrlRepository*> repos;
+    {
+        auto lock = readTopology();
+        for (const auto& entry : partitions) repos.push_back(entry.second.get());
+    }
+    size_t demoted = 0;
+    for (UrlRepository* repo : repos) demoted += repo->demoteIdle();
+    return demoted;
+}
+
+void PartitionedRepository::setMetrics(Metrics* m) {
+    auto lock = writeTopology();
+    metrics = m;
+    for (const auto& entry : partitions) entry.second->setMetrics(m);
+}
+
+// Every lookup takes the topology lock, so it must not make readers share a
+// cache line; ReadMostlyLock also lets addNode in ahead of new readers
+std::shared_lock<ReadMostlyLock> PartitionedRepository::readTopology() const {
+    return std::shared_lock<ReadMostlyLock>(topologyMtx);
+}
+
+std::unique_lock<ReadMostlyLock> PartitionedRepository::writeTopology() {
+    return std::unique_lock<ReadMostlyLock>(topologyMtx);
+}
+
+PartitionedRepository::Route PartitionedRepository::route(std::string_view shortCode) const {
+    if (ring.getNodes().empty()) return {partitions.at(-1).get(), nullptr};
+    uint64_t h = ring.hashKey(shortCode);
+    int node = ring.getNodeForHash(h);
+    Route r{partitions.at(node).get(), nullptr};
+    if (migrating.load(std::memory_order_acquire)) {
+        int old = previousRing.getNodeForHash(h);
+        if (old != node) r.previous = partitions.at(old).get();
+    }
+    return r;
+}
+
+// ── Topology ──
+
+bool PartitionedRepository::addNode(int nodeId) {
+    std::lock_guard<std::mutex> migrationLock(migrationMtx);
+    if (migrationThread.joinable()) migrationThread.join();
+
+    auto lock = writeTopology();
+    if (partitions.count(nodeId)) return false;
+
+    if (ring.getNodes().empty()) {
+        // First node: the local partition becomes it, nothing moves
+        partitions[nodeId] = std::move(partitions.at(-1));
+        partitions.erase(-1);
+        ring.addNode(nodeId);
+        return true;
+    }
+
+    auto repo = std::make_unique<UrlRepository>();
+    repo->setMetrics(metrics);
+    if (!persistence.dataDir.empty()) {
+        PersistenceOptions options = persistence;
+        options.dataDir = (std::filesystem::path(persistence.dataDir) /
+                           ("node-" + std::to_string(nodeId))).string();
+        repo->enablePersistence(options);
+    }
+    if (!coldTier.dir.empty()) {
+        ColdTierOptions options = coldTier;
+        options.dir = (std::filesystem::path(coldTier.dir) / ("node-" + std::to_string(nodeId))).string();
+        repo->enableColdTier(options);
+    }
+
+    std::vector<UrlRepository*> sources;
+    for (const auto& entry : partitions) sources.push_back(entry.second.get());
+    partitions[nodeId] = std::move(repo);
+    previousRing = ring;
+    ring.addNode(nodeId);
+    migrating.store(true, std::memory_order_release);
+    migrationThread = std::thread(&PartitionedRepository::migrate, this, nodeId, std::move(sources));
+    return true;
+}
+
+// Runs on migrationThread. `ring` cannot change until it finishes: addNode
+// waits for it before touching the topology.
+void PartitionedRepository::migrate(int target, std::vector<UrlRepository*> sources) {
+    UrlRepository* dst;
+    {
+        auto lock = readTopology();
+        dst = partitions.at(target).get();
+    }
+
+    std::vector<std::string> keys, batch;
+    std::vector<RepositoryEntry> entries;
+    std::vector<RepositoryWrite> writes;
+    for (UrlRepository* src : sources) {
+        keys.clear();
+        src->forEachKey([&](std::string_view key) {
+            if (ring.getNode(key) == target) keys.emplace_back(key);
+        });
+        // A code can be both in memory and in a cold table
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        // Three lock acquisitions per batch: copy out, insert, remove
+        for (size_t start = 0; start < keys.size(); start += MIGRATION_BATCH) {
+            size_t end = std::min(keys.size(), start + MIGRATION_BATCH);
+            batch.assign(keys.begin() + start, keys.begin() + end);
+            std::lock_guard<std::mutex> moveLock(moveMtx);
+            entries.clear();
+            src->findBatch(batch, entries);   // skips keys removed or expired meanwhile
+            writes.clear();
+            for (const RepositoryEntry& e : entries) {
+                RepositoryWrite w;
+                w.shortCode = e.shortCode;
+                w.longUrl = e.longUrl;
+                w.expiresAt = e.expiresAt;
+                w.onlyIfAbsent = true;   // a newer write already went to dst
+                writes.push_back(w);
+            }
+            dst->saveBatch(writes);
+            src->removeBatch(batch);
+            movedKeys.fetch_add(entries.size(), std::memory_order_relaxed);
+        }
+    }
+
+    // Readers still routing with the previous ring find every moved key at
+    // its new owner, so this needs no topology lock
+    migrating.store(false, std::memory_order_release);
+}
+
+void PartitionedRepository::waitForMigration() {
+    std::lock_guard<std::mutex> migrationLock(migrationMtx);
+    if (migrationThread.joinable()) migrationThread.join();
+}
+
+bool PartitionedRepository::isMigrating() const {
+    return migrating.load(std::memory_order_acquire);
+}
+
+int PartitionedRepository::nodeFor(std::string_view shortCode) const {
+    auto lock = readTopology();
+    return ring.getNode(shortCode);
+}
+
+std::vector<int> PartitionedRepository::nodes() const {
+    auto lock = readTopology();
+    return ring.getNodes();
+}
+
+size_t PartitionedRepository::nodeSize(int nodeId) const {
+    auto lock = readTopology();
+    auto it = partitions.find(nodeId);
+    return it == partitions.end() ? 0 : it->second->size();
+}
+
+// ── Reads and writes ──
+
+bool PartitionedRepository::save(const std::string& shortCode, const std::string& longUrl,
+                                 int ttlSeconds, int64_t generatedId) {
+    auto lock = readTopology();
+    Route r = route(shortCode);
+    if (!r.previous) return r.owner->save(shortCode, longUrl, ttlSeconds, generatedId);
+    std::lock_guard<std::mutex> moveLock(moveMtx);
+    bool logged = r.owner->save(shortCode, longUrl, ttlSeconds, generatedId);
+    r.previous->remove(shortCode);
+    return logged;
+}
+
+size_t PartitionedRepository::saveBatch(std::vector<RepositoryWrite>& writes) {
+    auto lock = readTopology();
+    if (partitions.size() == 1 && !migrating.load(std::memory_order_acquire)) return partitions.begin()->second->saveBatch(writes);
+
+    std::vector<Route> routes;
+    routes.reserve(writes.size());
+    bool moving = false;
+    for (const RepositoryWrite& w : writes) {
+        routes.push_back(route(w.shortCode));
+        moving |= routes.back().previous != nullptr;
+    }
+    std::unique_lock<std::mutex> moveLock(moveMtx, std::defer_lock);
+    if (moving) moveLock.lock();
+
+    // One saveBatch (one lock acquisition) per owning node
+    std::unordered_map<UrlRepository*, std::vector<size_t>> groups;
+    for (size_t i = 0; i < writes.size(); i++) {
+        const Route& r = routes[i];
+        writes[i].saved = writes[i].persisted = false;
+        if (r.previous && writes[i].onlyIfAbsent && r.previous->exists(writes[i].shortCode)) continue;
+        groups[r.owner].push_back(i);
+    }
+
+    size_t saved = 0;
+    std::vector<RepositoryWrite> part;
+    for (const auto& [repo, indices] : groups) {
+        part.clear();
+        for (size_t i : indices) part.push_back(writes[i]);
+        saved += repo->saveBatch(part);
+        for (size_t k = 0; k < indices.size(); k++) {
+            writes[indices[k]].saved = part[k].saved;
+            writes[indices[k]].persisted = part[k].persisted;
+        }
+    }
+
+    if (moving) {
+        for (size_t i = 0; i < writes.size(); i++) {
+            if (routes[i].previous && writes[i].saved) routes[i].previous->remove(writes[i].shortCode);
+        }
+    }
+    return saved;
+}
+
+std::string PartitionedRepository::find(std::string_view shortCode) {
+    int64_t expiresAt;
+    return find(shortCode, expiresAt);
+}
+
+std::string PartitionedRepository::find(std::string_view shortCode, int64_t& expiresAt) {
+    auto lock = readTopology();
+    Route r = route(shortCode);
+    // Previous owner first: a move copies before it removes, so checking
+    // in this order never misses a key that is being moved
+    if (r.previous) {
+        std::string longUrl = r.previous->find(shortCode, expiresAt);
+        if (!longUrl.empty()) return longUrl;
+    }
+    return r.owner->find(shortCode, expiresAt);
+}
+
+UrlHandle PartitionedRepository::findHandle(std::string_view shortCode, int64_t& expiresAt) {
+    auto lock = readTopology();
+    Route r = route(shortCode);
+    if (r.previous) {
+        UrlHandle longUrl = r.previous->findHandle(shortCode, expiresAt);
+        if (!longUrl.empty()) return longUrl;
+    }
+    return r.owner->findHandle(shortCode, expiresAt);
+}
+
+void PartitionedRepository::findMany(const std::vector<std::string_view>& codes,
+                                     std::vector<UrlHandle>& out, std::vector<int64_t>& expiresAt) {
+    auto lock = readTopology();
+    if (partitions.size() == 1 && !migrating.load(std::memory_order_acquire)) {
+        partitions.begin()->second->findMany(codes, out, expiresAt);
+        return;
+    }
+
+    // One findMany per owning node; codes being moved are looked up one by
+    // one, previous owner first (as in find)
+    out.assign(codes.size(), UrlHandle());
+    expiresAt.assign(codes.size(), 0);
+    std::unordered_map<UrlRepository*, std::vector<size_t>> groups;
+    for (size_t i = 0; i < codes.size(); i++) {
+        Route r = route(codes[i]);
+        if (!r.previous) {
+            groups[r.owner].push_back(i);
+            continue;
+        }
+        out[i] = r.previous->findHandle(codes[i], expiresAt[i]);
+        if (out[i].empty()) out[i] = r.owner->findHandle(codes[i], expiresAt[i]);
+    }
+
+    std::vector<std::string_view> part;
+    std::vector<UrlHandle> partOut;
+    std::vector<int64_t> partExpiry;
+    for (const auto& [repo, indices] : groups) {
+        part.clear();
+        for (size_t i : indices) part.push_back(codes[i]);
+        repo->findMany(part, partOut, partExpiry);
+        for (size_t k = 0; k < indices.size(); k++) {
+            out[indices[k]] = std::move(partOut[k]);
+            expiresAt[indices[k]] = partExpiry[k];
+        }
+    }
+}
+
+bool PartitionedRepository::exists(std::string_view shortCode) {
+    auto lock = readTopology();
+    Route r = route(shortCode);
+    return (r.previous && r.previous->exists(shortCode)) || r.owner->exists(shortCode);
+}
+
+void PartitionedRepository::remove(const std::string& shortCode) {
+    auto lock = readTopology();
+    Route r = route(shortCode);
+    if (!r.previous) {
+        r.owner->remove(shortCode);
+        return;
+    }
+    std::lock_guard<std::mutex> moveLock(moveMtx);
+    r.owner->remove(shortCode);
+    r.previous->remove(shortCode);
+}
+
+size_t PartitionedRepository::reapExpired(std::vector<std::string>& removed) {
+    auto lock = readTopology();
+    size_t reaped = 0;
+    for (const auto& entry : partitions) reaped += entry.second->reapExpired(removed);
+    return reaped;
+}
+
+size_t PartitionedRepository::size() const {
+    auto lock = readTopology();
+    size_t total = 0;
+    for (const auto& entry : partitions) total += entry.second->size();
+    return total;
+}
+
+int PartitionedRepository::persistenceError() const {
+    auto lock = readTopology();
+    for (const auto& entry : partitions) {
+        if (int err = entry.second->persistenceError()) return err;
+    }
+    return 0;
+}
+
+int64_t PartitionedRepository::highestGeneratedId() const {
+    auto lock = readTopology();
+    int64_t highest = 0;
+    for (const auto& entry : partitions) highest = std::max(highest, entry.second->highestGeneratedId());
+    return highest;
+}
+
+size_t PartitionedRepository::expiredCount() const {
+    auto lock = readTopology();
+    size_t total = 0;
+    for (const auto& entry : partitions) total += entry.second->expiredCount();
+    return total;
+}
+
+size_t PartitionedRepository::memoryBytes() const {
+    auto lock = readTopology();
+    size_t total = 0;
+    for (const auto& entry : partitions) total += entry.second->memoryBytes();
+    return total;
+}
+
+size_t PartitionedRepository::coldEntries() const {
+    auto lock = readTopology();
+    size_t total = 0;
+    for (const auto& entry : partitions) total += entry.second->coldEntries();
+    return total;
+}
+
+size_t PartitionedRepository::coldBytes() const {
+    auto lock = readTopology();
+    size_t total = 0;
+    for (const auto& entry : partitions) total += entry.second->coldBytes();
+    return total;
+}
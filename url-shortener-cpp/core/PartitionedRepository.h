@@ -0,0 +1,120 @@
+#ifndef PARTITIONED_REPOSITORY_H
+#define PARTITIONED_REPOSITORY_H
+
+#include "urlrespository.h"
+#include "consistenthashing.h"
+#include "ReadMostlyLock.h"
+#include <shared_mutex>
+#include <unordered_map>
+
+// Splits the link table across storage nodes chosen by a ConsistentHashRing.
+// Each node is an in-process UrlRepository (its own lock, table, log and
+// data directory), so a lookup only contends with traffic for its node.
+//
+// A standalone service is a one-node cluster: until the first addNode()
+// everything lives in the local partition, and the first node adopts it.
+// Every later node takes over its key ranges in the background. While that
+// migration runs, a moving key is read from its previous owner first and
+// then its new one, and writes go to the new owner and drop the old copy,
+// so redirects keep being served throughout.
+class PartitionedRepository {
+private:
+    // Where a key lives; `previous` is set only while it is being moved
+    struct Route {
+        UrlRepository* owner;
+        UrlRepository* previous;
+    };
+
+    mutable ReadMostlyLock topologyMtx;      // ring, previousRing, partitions
+    ConsistentHashRing ring;
+    ConsistentHashRing previousRing;         // ring before the running migration
+    std::unordered_map<int, std::unique_ptr<UrlRepository>> partitions;   // -1 = local, before addNode
+    std::atomic<bool> migrating{false};
+
+    // Moving a key and writing a moving key must not interleave, or a
+    // removed entry could be copied back to its new owner
+    std::mutex moveMtx;
+    std::mutex migrationMtx;                 // addNode / migrationThread start and join
+    std::thread migrationThread;
+    std::atomic<size_t> movedKeys{0};
+
+    PersistenceOptions persistence;          // empty dataDir = in-memory nodes
+    ColdTierOptions coldTier;                // empty dir = no cold tier
+    Metrics* metrics = nullptr;              // handed to every partition
+
+    std::shared_lock<ReadMostlyLock> readTopology() const;
+    std::unique_lock<ReadMostlyLock> writeTopology();
+    Route route(std::string_view shortCode) const;   // topologyMtx held (shared)
+    void migrate(int target, std::vector<UrlRepository*> sources);
+
+public:
+    PartitionedRepository(int virtualNodes = ConsistentHashRing::DEFAULT_VIRTUAL_NODES,
+                          HashAlgorithm algorithm = HashAlgorithm::Ring);
+    ~PartitionedRepository();
+
+    PartitionedRepository(const PartitionedRepository&) = delete;
+    PartitionedRepository& operator=(const PartitionedRepository&) = delete;
+
+    // Persist the local partition in options.dataDir; nodes added later
+    // (other than the first, which adopts it) use dataDir/node-<id>.
+    // Call once, before any addNode() and before sharing between threads.
+    bool enablePersistence(const PersistenceOptions& options);
+
+    // Give the local partition a cold tier in options.dir (after
+    // enablePersistence); nodes added later use dir/node-<id>.
+    bool enableColdTier(const ColdTierOptions& options);
+
+    // Demote idle entries of every partition; returns how many moved
+    size_t demoteIdle();
+
+    // Report every partition's lock hold times to `m`, nodes added later
+    // included. Call before sharing between threads.
+    void setMetrics(Metrics* m);
+
+    // Add a storage node and start moving its share of the keys to it in
+    // the background. Waits for a previous migration first; returns false
+    // if the node already exists.
+    bool addNode(int nodeId);
+
+    // Block until the running migration (if any) has finished
+    void waitForMigration();
+    bool isMigrating() const;
+
+    // Keys copied to a new owner by migrations so far
+    size_t movedCount() const { return movedKeys.load(std::memory_order_relaxed); }
+
+    // Node that owns a short code (-1 before the first addNode)
+    int nodeFor(std::string_view shortCode) const;
+    std::vector<int> nodes() const;
+    size_t nodeSize(int nodeId) const;
+
+    // Same contracts as the UrlRepository methods of the same name
+    bool save(const std::string& shortCode, const std::string& longUrl, int ttlSeconds = 0,
+              int64_t generatedId = 0);
+    size_t saveBatch(std::vector<RepositoryWrite>& writes);
+    std::string find(std::string_view shortCode);
+    std::string find(std::string_view shortCode, int64_t& expiresAt);
+    UrlHandle findHandle(std::string_view shortCode, int64_t& expiresAt);
+    void findMany(const std::vector<std::string_view>& codes, std::vector<UrlHandle>& out,
+                  std::vector<int64_t>& expiresAt);
+    bool exists(std::string_view shortCode);
+    void remove(const std::string& shortCode);
+    size_t reapExpired(std::vector<std::string>& removed);
+
+    // Visit every stored short code, one partition at a time
+    template <class Fn>
+    void forEachKey(Fn&& fn) const {
+        auto lock = readTopology();
+        for (const auto& entry : partitions) entry.second->forEachKey(fn);
+    }
+
+    size_t size() const;
+    size_t expiredCount() const;
+    int64_t highestGeneratedId() const;   // over every partition (moves keep it at the source)
+    int persistenceError() const;         // first failed partition's, 0 if none
+    size_t memoryBytes() const;
+    size_t coldEntries() const;
+    size_t coldBytes() const;
+};
+
+#endif
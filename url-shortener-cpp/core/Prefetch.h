@@ -0,0 +1,15 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+// Ask for the cache line holding *p ahead of a read, so batched lookups
+// overlap their memory latency instead of waiting on one miss at a time.
+// A hint only: never faults, and compiles to nothing without the builtin.
+inline void prefetchRead(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#else
+    (void)p;
+#endif
+}
+
+#endif
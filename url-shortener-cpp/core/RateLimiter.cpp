@@ -1,39 +1,295 @@
 #include "RateLimiter.h"
+#include "HashUtil.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
 
-RateLimiter::RateLimiter(double maxTok, double refRate)
-    : maxTokens(maxTok), refillRate(refRate) {}
+// Bucket word: 40-bit tick (ms since construction, +1 so a live bucket is
+// never 0) above 24 bits of tokens in 1/4096 units
+static constexpr int      TOKEN_BITS = 24;
+static constexpr uint64_t TOKEN_MASK = (1ULL << TOKEN_BITS) - 1;
+static constexpr uint64_t UNIT       = 4096;
 
-void RateLimiter::refill(Bucket& b) {
-    auto now = std::chrono::steady_clock::now();
-    double elapsed = std::chrono::duration<double>(now - b.lastRefill).count();
-    b.tokens = std::min(maxTokens, b.tokens + elapsed * refillRate);
-    b.lastRefill = now;
+// ── Address parsing ──
+
+static bool parseIPv4(std::string_view s, uint8_t out[4]) {
+    int part = 0;
+    size_t i = 0;
+    while (part < 4) {
+        size_t digits = 0;
+        int value = 0;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9' && digits < 3) {
+            value = value * 10 + (s[i++] - '0');
+            digits++;
+        }
+        if (digits == 0 || value > 255) return false;
+        out[part++] = (uint8_t)value;
+        if (part < 4) {
+            if (i >= s.size() || s[i] != '.') return false;
+            i++;
+        }
+    }
+    return i == s.size();
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool parseIPv6(std::string_view s, uint8_t out[16]) {
+    s = s.substr(0, s.find('%'));   // drop a zone id ("fe80::1%eth0")
+    if (s.size() < 2) return false;
+
+    uint16_t groups[8] = {};
+    int n = 0, gap = -1;
+    size_t i = 0;
+    if (s[0] == ':') {
+        if (s[1] != ':') return false;
+        gap = 0;
+        i = 2;
+    }
+    while (i < s.size()) {
+        size_t end = s.find(':', i);
+        std::string_view part = s.substr(i, end == std::string_view::npos ? end : end - i);
+        if (part.find('.') != std::string_view::npos) {
+            // Trailing embedded IPv4 ("::ffff:1.2.3.4")
+            uint8_t v4[4];
+            if (end != std::string_view::npos || n > 6 || !parseIPv4(part, v4)) return false;
+            groups[n++] = (uint16_t)(v4[0] << 8 | v4[1]);
+            groups[n++] = (uint16_t)(v4[2] << 8 | v4[3]);
+            break;
+        }
+        if (part.empty() || part.size() > 4 || n == 8) return false;
+        uint16_t value = 0;
+        for (char c : part) {
+            int d = hexValue(c);
+            if (d < 0) return false;
+            value = (uint16_t)(value << 4 | d);
+        }
+        groups[n++] = value;
+        if (end == std::string_view::npos) break;
+        i = end + 1;
+        if (i < s.size() && s[i] == ':') {
+            if (gap >= 0) return false;
+            gap = n;
+            i++;
+        } else if (i == s.size()) {
+            return false;   // trailing single ':'
+        }
+    }
+    if (gap < 0 ? n != 8 : n > 7) return false;
+
+    std::memset(out, 0, 16);
+    int head = gap < 0 ? n : gap;
+    for (int g = 0; g < head; g++) {
+        out[2 * g] = (uint8_t)(groups[g] >> 8);
+        out[2 * g + 1] = (uint8_t)groups[g];
+    }
+    for (int g = head; g < n; g++) {
+        int pos = 8 - (n - g);
+        out[2 * pos] = (uint8_t)(groups[g] >> 8);
+        out[2 * pos + 1] = (uint8_t)groups[g];
+    }
+    return true;
 }
 
-bool RateLimiter::allowRequest(const std::string& ip) {
-    std::lock_guard<std::mutex> lock(mtx);
+bool RateLimiter::IpKey::operator==(const IpKey& o) const {
+    return std::memcmp(bytes, o.bytes, sizeof(bytes)) == 0;
+}
 
-    auto it = buckets.find(ip);
-    if (it == buckets.end()) {
-        // New IP: start with full bucket
-        buckets[ip] = { maxTokens - 1.0, std::chrono::steady_clock::now() };
-        return true;
+RateLimiter::IpKey RateLimiter::keyFor(std::string_view ip) {
+    IpKey key;
+    uint8_t v4[4];
+    if (parseIPv4(ip, v4)) {
+        key.bytes[10] = key.bytes[11] = 0xFF;
+        std::memcpy(key.bytes + 12, v4, 4);
+    } else if (!parseIPv6(ip, key.bytes)) {
+        uint64_t h[2] = {hashString(ip, 1), hashString(ip, 2)};
+        std::memcpy(key.bytes, h, sizeof(h));
     }
+    return key;
+}
 
-    Bucket& b = it->second;
-    refill(b);
+// ── Buckets ──
+
+RateLimiter::RateLimiter(double maxTok, double refRate, size_t maxBuckets, int numShards)
+    : maxTokens(maxTok), refillRate(refRate),
+      epoch(std::chrono::steady_clock::now()) {
+    maxUnits = (uint64_t)(std::min(std::max(maxTokens, 1.0), (double)(TOKEN_MASK / UNIT)) * UNIT);
+    unitsPerMs = std::max(refillRate, 0.0) * UNIT / 1000.0;
+
+    maxBuckets = std::max<size_t>(maxBuckets, 1);
+    if (numShards <= 0) {
+        int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+        numShards = 1;
+        while (numShards < hw * 2 && numShards < 64) numShards <<= 1;
+    }
+    // Power of two, and at least 16 buckets per shard
+    int n = 1;
+    while (n * 2 <= numShards && (size_t)(n * 2) * 16 <= maxBuckets) {
+        n <<= 1;
+        shardBits++;
+    }
+
+    // Max load 3/4
+    maxBucketsPerShard = (maxBuckets + n - 1) / n;
+    maxSlotsPerShard = 16;
+    while (maxSlotsPerShard * 3 < maxBucketsPerShard * 4) maxSlotsPerShard <<= 1;
+
+    for (int i = 0; i < n; i++) {
+        auto shard = std::make_unique<Shard>();
+        size_t initial = std::min<size_t>(16, maxSlotsPerShard);
+        shard->slots = std::make_unique<Slot[]>(initial);
+        shard->mask = initial - 1;
+        shards.push_back(std::move(shard));
+    }
+}
+
+uint64_t RateLimiter::nowTick() const {
+    auto elapsed = std::chrono::steady_clock::now() - epoch;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() + 1;
+}
+
+// Tokens (in units) after refilling `state` up to `now`; `tick` gets the
+// timestamp to store. Time that refilled less than one unit is not
+// consumed, so slow refill rates still accumulate.
+uint64_t RateLimiter::refilled(uint64_t state, uint64_t now, uint64_t& tick) const {
+    uint64_t last = state >> TOKEN_BITS;
+    uint64_t units = state & TOKEN_MASK;
+    tick = last;
+    if (now <= last) return units;
+    double gain = (double)(now - last) * unitsPerMs;
+    if ((double)units + gain >= (double)maxUnits) {
+        tick = now;
+        return maxUnits;
+    }
+    uint64_t whole = (uint64_t)gain;
+    if (whole == 0) return units;
+    tick = now;
+    return units + whole;
+}
 
-    if (b.tokens >= 1.0) {
-        b.tokens -= 1.0;
-        return true;
+bool RateLimiter::consume(std::atomic<uint64_t>& state, uint64_t now) {
+    uint64_t cur = state.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t tick;
+        uint64_t units = refilled(cur, now, tick);
+        if (units < UNIT) return false;   // rejected requests never write
+        uint64_t next = (tick << TOKEN_BITS) | (units - UNIT);
+        if (state.compare_exchange_weak(cur, next, std::memory_order_relaxed)) return true;
     }
-    return false; // Rate limited
 }
 
-double RateLimiter::getTokens(const std::string& ip) {
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = buckets.find(ip);
-    if (it == buckets.end()) return maxTokens;
-    refill(it->second);
-    return it->second.tokens;
+RateLimiter::Slot* RateLimiter::find(const Shard& s, const IpKey& key, uint64_t hash) const {
+    for (size_t i = hash & s.mask;; i = (i + 1) & s.mask) {
+        Slot& slot = s.slots[i];
+        if (slot.state.load(std::memory_order_relaxed) == 0) return nullptr;
+        if (slot.key == key) return &slot;
+    }
+}
+
+void RateLimiter::insertFresh(Shard& s, const IpKey& key, uint64_t hash, uint64_t state) {
+    size_t i = hash & s.mask;
+    while (s.slots[i].state.load(std::memory_order_relaxed) != 0) i = (i + 1) & s.mask;
+    s.slots[i].key = key;
+    s.slots[i].state.store(state, std::memory_order_relaxed);
+    s.count++;
+}
+
+// Called with the shard exclusively locked when it is at its load limit or
+// its bucket budget: grow while under maxSlotsPerShard, otherwise rebuild
+// without idle buckets and, if that is not enough, keep only the most
+// recently used half of the budget
+void RateLimiter::makeRoom(Shard& s, uint64_t now) {
+    size_t capacity = s.mask + 1;
+    std::vector<std::pair<IpKey, uint64_t>> live;
+    live.reserve(s.count);
+    for (size_t i = 0; i < capacity; i++) {
+        uint64_t state = s.slots[i].state.load(std::memory_order_relaxed);
+        if (state != 0) live.emplace_back(s.slots[i].key, state);
+    }
+
+    if (capacity < maxSlotsPerShard && s.count < maxBucketsPerShard) {
+        capacity *= 2;
+    } else {
+        size_t before = live.size();
+        live.erase(std::remove_if(live.begin(), live.end(), [&](const std::pair<IpKey, uint64_t>& e) {
+            uint64_t tick;
+            return refilled(e.second, now, tick) >= maxUnits;
+        }), live.end());
+        size_t keep = std::max<size_t>(1, std::min(capacity / 2, maxBucketsPerShard / 2));
+        if (live.size() > keep) {
+            std::nth_element(live.begin(), live.begin() + keep, live.end(),
+                             [](const std::pair<IpKey, uint64_t>& a, const std::pair<IpKey, uint64_t>& b) {
+                                 return (a.second >> TOKEN_BITS) > (b.second >> TOKEN_BITS);
+                             });
+            live.resize(keep);
+        }
+        evicted.fetch_add(before - live.size(), std::memory_order_relaxed);
+    }
+
+    s.slots = std::make_unique<Slot[]>(capacity);
+    s.mask = capacity - 1;
+    s.count = 0;
+    for (const auto& e : live) {
+        insertFresh(s, e.first, hashBytes(e.first.bytes, sizeof(e.first.bytes)), e.second);
+    }
+}
+
+bool RateLimiter::allowRequest(std::string_view ip) {
+    return allowRequest(keyFor(ip));
+}
+
+bool RateLimiter::allowRequest(const IpKey& key) {
+    uint64_t hash = hashBytes(key.bytes, sizeof(key.bytes));
+    Shard& s = *shards[shardBits == 0 ? 0 : hash >> (64 - shardBits)];
+    uint64_t now = nowTick();
+
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RateLimiterLock);
+        if (Slot* slot = find(s, key, hash)) return consume(slot->state, now);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(s.mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::RateLimiterLock);
+    if (Slot* slot = find(s, key, hash)) return consume(slot->state, now);
+    if ((s.count + 1) * 4 > (s.mask + 1) * 3 || s.count >= maxBucketsPerShard) makeRoom(s, now);
+
+    // New IP: start with full bucket
+    insertFresh(s, key, hash, (now << TOKEN_BITS) | (maxUnits - UNIT));
+    return true;
+}
+
+double RateLimiter::getTokens(std::string_view ip) {
+    IpKey key = keyFor(ip);
+    uint64_t hash = hashBytes(key.bytes, sizeof(key.bytes));
+    Shard& s = *shards[shardBits == 0 ? 0 : hash >> (64 - shardBits)];
+    std::shared_lock<std::shared_mutex> lock(s.mtx);
+    Slot* slot = find(s, key, hash);
+    if (!slot) return maxUnits / (double)UNIT;
+    uint64_t tick;
+    return refilled(slot->state.load(std::memory_order_relaxed), nowTick(), tick) / (double)UNIT;
+}
+
+size_t RateLimiter::bucketCount() const {
+    size_t total = 0;
+    for (const auto& s : shards) {
+        std::shared_lock<std::shared_mutex> lock(s->mtx);
+        total += s->count;
+    }
+    return total;
+}
+
+size_t RateLimiter::memoryBytes() const {
+    size_t total = 0;
+    for (const auto& s : shards) {
+        std::shared_lock<std::shared_mutex> lock(s->mtx);
+        total += sizeof(Shard) + (s->mask + 1) * sizeof(Slot);
+    }
+    return total;
 }
@@ -2,34 +2,87 @@
 #define RATE_LIMITER_H
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <chrono>
-#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "Metrics.h"
 
 // Token Bucket Rate Limiter (per IP)
+//
+// Buckets live in sharded open-addressing tables keyed by the 16-byte
+// binary address. Each bucket is one atomic word (timestamp | tokens), so a
+// request only takes its shard's lock in shared mode and spends a token
+// with a CAS; the exclusive lock is needed only to add a new IP.
+//
+// Memory is bounded by maxBuckets. When a full shard needs room it first
+// drops idle buckets (ones that have refilled to maxTokens, so forgetting
+// them changes nothing), then the least recently used ones.
 class RateLimiter {
+public:
+    // IPv6 address, or IPv4 as ::ffff:a.b.c.d. Strings that are not an
+    // address are hashed into a key so any client id still works.
+    struct IpKey {
+        uint8_t bytes[16] = {};
+        bool operator==(const IpKey& o) const;
+    };
+
+    static IpKey keyFor(std::string_view ip);
+
 private:
-    struct Bucket {
-        double tokens;
-        std::chrono::steady_clock::time_point lastRefill;
+    struct Slot {
+        IpKey key;
+        std::atomic<uint64_t> state{0};   // 0 = empty, else (tick << TOKEN_BITS) | tokens
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mtx;
+        std::unique_ptr<Slot[]> slots;
+        size_t mask = 0;
+        size_t count = 0;
     };
 
     double maxTokens;    // max burst capacity
     double refillRate;   // tokens added per second
-    std::unordered_map<std::string, Bucket> buckets;
-    std::mutex mtx;
+    uint64_t maxUnits;   // maxTokens in fixed-point units
+    double unitsPerMs;   // refillRate in fixed-point units per ms
+    size_t maxSlotsPerShard;
+    size_t maxBucketsPerShard;
+    int shardBits = 0;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<uint64_t> evicted{0};
+    Metrics* metrics = nullptr;       // lock hold times, if set
 
-    void refill(Bucket& b);
+    uint64_t nowTick() const;
+    uint64_t refilled(uint64_t state, uint64_t now, uint64_t& tick) const;
+    bool consume(std::atomic<uint64_t>& state, uint64_t now);
+    Slot* find(const Shard& s, const IpKey& key, uint64_t hash) const;
+    void insertFresh(Shard& s, const IpKey& key, uint64_t hash, uint64_t state);
+    void makeRoom(Shard& s, uint64_t now);
 
 public:
-    // maxTokens = burst limit, refillRate = tokens/second
-    RateLimiter(double maxTokens = 5.0, double refillRate = 2.0);
+    // maxTokens = burst limit, refillRate = tokens/second,
+    // maxBuckets = IPs tracked at once, numShards = 0 picks from core count
+    RateLimiter(double maxTokens = 5.0, double refillRate = 2.0,
+                size_t maxBuckets = 1 << 16, int numShards = 0);
 
     // Returns true if request is allowed, false if rate-limited
-    bool allowRequest(const std::string& ip);
+    bool allowRequest(std::string_view ip);
+    bool allowRequest(const IpKey& key);
 
     // Get remaining tokens for an IP (for display)
-    double getTokens(const std::string& ip);
+    double getTokens(std::string_view ip);
+
+    size_t bucketCount() const;
+    size_t memoryBytes() const;
+    uint64_t evictedCount() const { return evicted.load(std::memory_order_relaxed); }
+
+    // Report shard lock hold times to `m` (call before sharing the limiter)
+    void setMetrics(Metrics* m) { metrics = m; }
 };
 
 #endif
@@ -0,0 +1,64 @@
+#include "ReadMostlyLock.h"
+#include <thread>
+
+// Threads take slots round-robin on first use
+int ReadMostlyLock::slotIndex() {
+    static std::atomic<int> nextSlot{0};
+    thread_local int slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % READER_SLOTS;
+    return slot;
+}
+
+// The reader announces itself, then checks for a writer; the writer raises
+// its flag, then checks the readers. Both sides are sequentially consistent,
+// so at least one of them sees the other. The same pairing (reader leaves,
+// then checks the flag / writer raises it, then checks the slots; writer
+// lowers it, then checks parkedReaders) means a parked thread is always woken.
+void ReadMostlyLock::lock_shared() {
+    Slot& s = slots[slotIndex()];
+    for (;;) {
+        s.readers.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer.load(std::memory_order_seq_cst)) return;
+        unlock_shared();
+
+        for (int spin = 0; spin < SPIN_LIMIT && writer.load(std::memory_order_acquire); spin++) {
+            std::this_thread::yield();
+        }
+        if (writer.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> park(parkMtx);
+            parkedReaders.fetch_add(1, std::memory_order_seq_cst);
+            writerDone.wait(park, [this] { return !writer.load(std::memory_order_seq_cst); });
+            parkedReaders.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ReadMostlyLock::unlock_shared() {
+    slots[slotIndex()].readers.fetch_sub(1, std::memory_order_seq_cst);
+    if (writer.load(std::memory_order_seq_cst)) {
+        // A writer may be parked waiting for this slot to drain
+        std::lock_guard<std::mutex> park(parkMtx);
+        readerLeft.notify_one();
+    }
+}
+
+void ReadMostlyLock::lock() {
+    writerMtx.lock();
+    writer.store(true, std::memory_order_seq_cst);
+    for (Slot& s : slots) {
+        auto drained = [&s] { return s.readers.load(std::memory_order_seq_cst) == 0; };
+        for (int spin = 0; spin < SPIN_LIMIT && !drained(); spin++) std::this_thread::yield();
+        if (!drained()) {
+            std::unique_lock<std::mutex> park(parkMtx);
+            readerLeft.wait(park, drained);
+        }
+    }
+}
+
+void ReadMostlyLock::unlock() {
+    writer.store(false, std::memory_order_seq_cst);
+    if (parkedReaders.load(std::memory_order_seq_cst) != 0) {
+        std::lock_guard<std::mutex> park(parkMtx);
+        writerDone.notify_all();
+    }
+    writerMtx.unlock();
+}
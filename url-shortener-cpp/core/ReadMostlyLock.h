@@ -0,0 +1,56 @@
+#ifndef READ_MOSTLY_LOCK_H
+#define READ_MOSTLY_LOCK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Reader-writer lock for read-dominated data, usable with std::shared_lock
+// and std::unique_lock / std::lock_guard.
+//
+// std::shared_mutex keeps one reader count, so every lookup writes the same
+// cache line and readers slow each other down as threads are added. Here a
+// reader only increments the counter of its own slot (threads are spread
+// over READER_SLOTS cache lines); a writer raises a flag and waits for all
+// slots to drain. Readers that see the flag step aside until the writer is
+// done, so a steady stream of lookups cannot starve writers.
+//
+// Waiters on either side spin briefly (critical sections here are short),
+// then park on a condition variable, so a writer held up by IO or
+// preemption costs blocked threads no CPU.
+//
+// Not recursive: a thread holding a shared lock must not take it again.
+class ReadMostlyLock {
+public:
+    ReadMostlyLock() = default;
+    ReadMostlyLock(const ReadMostlyLock&) = delete;
+    ReadMostlyLock& operator=(const ReadMostlyLock&) = delete;
+
+    void lock_shared();
+    void unlock_shared();
+
+    void lock();
+    void unlock();
+
+private:
+    static constexpr int READER_SLOTS = 64;
+    static constexpr int SPIN_LIMIT = 64;   // yields before a waiter parks
+
+    struct alignas(64) Slot {
+        std::atomic<int64_t> readers{0};
+    };
+
+    Slot slots[READER_SLOTS];
+    std::atomic<bool> writer{false};
+    std::mutex writerMtx;            // one writer at a time
+
+    std::mutex parkMtx;              // guards the waits below
+    std::condition_variable writerDone;     // parked readers: writer flag cleared
+    std::condition_variable readerLeft;     // parked writer: a slot may have drained
+    std::atomic<int> parkedReaders{0};
+
+    static int slotIndex();
+};
+
+#endif
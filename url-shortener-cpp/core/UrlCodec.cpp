@@ -0,0 +1,361 @@
+#include "UrlCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t MAX_TOKEN_LEN    = 48;
+constexpr size_t MAX_TOKEN_PIECES = 3;
+
+// Training sample for the standard model: the shapes of links people
+// shorten (popular sites, article paths, tracking parameters)
+const char* const STANDARD_SAMPLES[] = {
+    "https://www.google.com/search?q=url+shortener&oq=url+shortener&sourceid=chrome&ie=UTF-8",
+    "https://www.google.com/maps/place/Eiffel+Tower/@48.8583701,2.2944813,17z",
+    "https://docs.google.com/document/d/1aBcDeFgHiJkLmNoPqRsTuVwXyZ/edit?usp=sharing",
+    "https://drive.google.com/file/d/1AbCdEfGhIjKlMnOpQrStUvWxYz/view?usp=sharing",
+    "https://www.youtube.com/watch?v=dQw4w9WgXcQ",
+    "https://www.youtube.com/watch?v=9bZkp7q19f0&list=PLFgquLnL59alCl_2TQvOiD5Vgm1hCaGSI&index=2",
+    "https://youtu.be/dQw4w9WgXcQ?si=Xy12AbCdEf",
+    "https://www.facebook.com/events/1234567890/?ref=newsfeed",
+    "https://www.instagram.com/p/CxYz123AbC/?utm_source=ig_web_copy_link",
+    "https://twitter.com/nasa/status/1234567890123456789",
+    "https://x.com/github/status/1765432109876543210?s=20",
+    "https://www.linkedin.com/posts/company_update-activity-7123456789012345678-AbCd?utm_source=share&utm_medium=member_desktop",
+    "https://www.linkedin.com/in/jane-doe-12345678/",
+    "https://www.reddit.com/r/programming/comments/1abcde/how_we_cut_our_p99_latency_in_half/",
+    "https://github.com/torvalds/linux/blob/master/kernel/sched/core.c",
+    "https://github.com/facebook/react/pull/28001/files",
+    "https://github.com/rust-lang/rust/issues/12345#issuecomment-987654321",
+    "https://stackoverflow.com/questions/1234567/how-do-i-undo-the-most-recent-local-commits-in-git",
+    "https://en.wikipedia.org/wiki/Consistent_hashing",
+    "https://en.wikipedia.org/wiki/Bloom_filter#Probability_of_false_positives",
+    "https://medium.com/@author/building-a-url-shortener-in-c-3f2a1b4c5d6e",
+    "https://www.amazon.com/dp/B08N5WRWNW?ref=ppx_yo2ov_dt_b_product_details&th=1",
+    "https://www.amazon.com/gp/product/B07FZ8S74R/ref=ppx_yo_dt_b_asin_title_o00_s00?ie=UTF8&psc=1",
+    "https://www.ebay.com/itm/123456789012?hash=item1cbe2a0f4d:g:AbCdEfGhIjKlMnOp",
+    "https://www.nytimes.com/2024/03/15/technology/artificial-intelligence-chips.html",
+    "https://www.theguardian.com/world/2024/mar/15/climate-report-record-temperatures",
+    "https://www.bbc.com/news/world-europe-68567890",
+    "https://edition.cnn.com/2024/03/15/tech/ai-regulation-europe/index.html",
+    "https://www.washingtonpost.com/politics/2024/03/15/budget-vote-senate/",
+    "https://techcrunch.com/2024/03/15/startup-raises-series-a/?guccounter=1",
+    "https://www.example.com/blog/2024/03/how-to-scale-your-app?utm_source=newsletter&utm_medium=email&utm_campaign=spring_sale",
+    "https://shop.example.com/products/blue-running-shoes?variant=41234567890&utm_source=facebook&utm_medium=paid_social&utm_campaign=summer",
+    "https://example.org/articles/12345/the-complete-guide-to-caching?utm_source=twitter&utm_medium=social",
+    "https://news.example.net/2023/11/02/local-elections-results.html?utm_source=rss&utm_medium=rss&utm_campaign=local-elections",
+    "https://www.example.co.uk/category/electronics/laptops/index.html?page=2&sort=price_asc",
+    "https://app.example.io/dashboard/projects/8f14e45f-ceea-467f-a8f0-5a4b3c2d1e0f/settings",
+    "https://api.example.com/v1/users/12345/orders?limit=50&offset=100",
+    "https://www.spotify.com/us/premium/?utm_source=us-en_brand_contextual_text&utm_medium=paidsearch",
+    "https://open.spotify.com/track/4cOdK2wGLETKBW3PvgPWqT?si=1a2b3c4d5e6f4a7b",
+    "https://www.twitch.tv/videos/1234567890",
+    "https://www.tiktok.com/@user.name/video/7234567890123456789?is_from_webapp=1&sender_device=pc",
+    "https://www.pinterest.com/pin/123456789012345678/",
+    "https://www.netflix.com/title/80100172",
+    "https://www.imdb.com/title/tt0111161/?ref_=nv_sr_srsg_0",
+    "https://www.booking.com/hotel/fr/le-grand-paris.html?aid=304142&checkin=2024-06-01&checkout=2024-06-05",
+    "https://www.airbnb.com/rooms/12345678?adults=2&check_in=2024-07-01&check_out=2024-07-07",
+    "https://zoom.us/j/91234567890?pwd=AbCdEfGhIjKlMnOpQrStUvWxYz",
+    "https://calendar.google.com/calendar/event?eid=AbCdEf123456&ctz=Europe/Paris",
+    "https://forms.gle/AbCdEfGhIjKlMnOp9",
+    "https://bit.ly/3AbCdEf",
+    "http://www.example.com/index.php?id=123&lang=en",
+    "http://blog.example.org/2019/05/hello-world/",
+    "https://support.microsoft.com/en-us/windows/update-windows-3c5ae7fc-9fb6-9af1-1984-b5e0412c556a",
+    "https://developer.mozilla.org/en-US/docs/Web/HTTP/Status/302",
+    "https://www.apple.com/shop/buy-iphone/iphone-15-pro?afid=p238%7Cs4Bk&cid=aos-us-kwgo-brand",
+    "https://www.wikipedia.org/",
+    "https://www.example.com/search?q=winter+jackets&category=outdoor&utm_source=google&utm_medium=cpc&utm_campaign=brand&gclid=EAIaIQobChMI1234567890",
+    "https://www.example.com/landing?utm_source=newsletter&utm_medium=email&utm_campaign=weekly_digest&utm_content=header_link",
+};
+
+bool isDelimiter(char c) {
+    return c == '/' || c == '.' || c == '?' || c == '&' || c == '=' || c == '#' || c == ':';
+}
+
+// Split a URL into pieces: a run of ordinary characters plus the
+// delimiters after it ("https://", "www.", "com/", "utm_source=")
+void splitPieces(std::string_view url, std::vector<std::string_view>& pieces) {
+    pieces.clear();
+    size_t start = 0, i = 0;
+    while (i < url.size()) {
+        while (i < url.size() && !isDelimiter(url[i])) i++;
+        while (i < url.size() && isDelimiter(url[i])) i++;
+        pieces.push_back(url.substr(start, i - start));
+        start = i;
+    }
+}
+
+uint32_t reverseBits(uint32_t code, int bits) {
+    uint32_t r = 0;
+    for (int i = 0; i < bits; i++) r |= ((code >> i) & 1) << (bits - 1 - i);
+    return r;
+}
+
+// Huffman code lengths; every symbol has a nonzero frequency
+std::vector<uint8_t> huffmanLengths(const std::vector<uint64_t>& frequencies) {
+    size_t n = frequencies.size();
+    std::vector<size_t> parent(2 * n, 0);
+    using Node = std::pair<uint64_t, size_t>;   // (weight, id): ties by id, deterministic
+    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+    for (size_t i = 0; i < n; i++) queue.push({frequencies[i], i});
+    size_t next = n;
+    while (queue.size() > 1) {
+        Node a = queue.top();
+        queue.pop();
+        Node b = queue.top();
+        queue.pop();
+        parent[a.second] = parent[b.second] = next;
+        queue.push({a.first + b.first, next++});
+    }
+    std::vector<uint8_t> lengths(n);
+    size_t root = next - 1;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t depth = 0;
+        for (size_t node = i; node != root; node = parent[node]) depth++;
+        lengths[i] = depth;
+    }
+    return lengths;
+}
+
+void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+bool getVarint(std::string_view in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        uint8_t b = (uint8_t)in[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+const UrlCodec& UrlCodec::standard() {
+    static const UrlCodec codec = train(std::vector<std::string>(std::begin(STANDARD_SAMPLES),
+                                                                  std::end(STANDARD_SAMPLES)),
+                                        STANDARD_TAG);
+    return codec;
+}
+
+// Dictionary: runs of 1-3 pieces scored by bytes saved (count × (len - 1));
+// code: Huffman over the symbol counts of the tokenized samples, +1 each so
+// any byte can still be encoded
+UrlCodec UrlCodec::train(const std::vector<std::string>& samples, uint8_t tag, size_t maxTokens) {
+    UrlCodec codec;
+    codec.tag = tag;
+
+    std::unordered_map<std::string_view, uint64_t> counts;
+    std::vector<std::string_view> pieces;
+    for (const std::string& url : samples) {
+        splitPieces(url, pieces);
+        size_t offset = 0;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            size_t len = 0;
+            for (size_t k = i; k < pieces.size() && k < i + MAX_TOKEN_PIECES; k++) {
+                len += pieces[k].size();
+                if (len > MAX_TOKEN_LEN) break;
+                if (len >= 2) counts[std::string_view(url).substr(offset, len)]++;
+            }
+            offset += pieces[i].size();
+        }
+    }
+
+    std::vector<std::pair<uint64_t, std::string_view>> ranked;
+    for (const auto& [token, count] : counts) {
+        if (count >= 2) ranked.push_back({count * (token.size() - 1), token});
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    if (ranked.size() > maxTokens) ranked.resize(maxTokens);
+    for (const auto& r : ranked) codec.tokens.emplace_back(r.second);
+    std::sort(codec.tokens.begin(), codec.tokens.end());
+
+    codec.startPairs.assign(65536 / 64, 0);
+    for (size_t i = 0; i < codec.tokens.size(); i++) {
+        const std::string& token = codec.tokens[i];
+        uint32_t pair = (uint8_t)token[0] | (uint32_t)(uint8_t)token[1] << 8;
+        codec.startPairs[pair / 64] |= 1ULL << (pair % 64);
+        Candidate c{0, 0, (uint16_t)i, (uint16_t)token.size()};
+        size_t len = std::min<size_t>(token.size(), 8);
+        std::memcpy(&c.prefix, token.data(), len);
+        c.mask = len == 8 ? ~0ULL : (1ULL << (len * 8)) - 1;
+        codec.byFirstByte[(uint8_t)token[0]].push_back(c);
+    }
+    for (auto& candidates : codec.byFirstByte) {
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const Candidate& a, const Candidate& b) { return a.size > b.size; });
+    }
+
+    std::vector<uint64_t> frequencies(256 + codec.tokens.size(), 1);
+    std::vector<uint16_t> symbols;
+    for (const std::string& url : samples) {
+        codec.tokenize(url, symbols);
+        for (uint16_t s : symbols) frequencies[s]++;
+    }
+    codec.buildCode(frequencies);
+    return codec;
+}
+
+void UrlCodec::tokenize(std::string_view url, std::vector<uint16_t>& symbols) const {
+    symbols.clear();
+    for (size_t pos = 0; pos < url.size();) {
+        size_t left = url.size() - pos;
+        uint64_t head = 0;
+        if (left >= 8) {
+            std::memcpy(&head, url.data() + pos, 8);
+        } else {
+            for (size_t i = 0; i < left; i++) head |= (uint64_t)(uint8_t)url[pos + i] << (i * 8);
+        }
+        size_t matched = 0;
+        uint32_t pair = (uint32_t)(head & 0xFFFF);   // tokens are >= 2 bytes
+        if (left >= 2 && (startPairs[pair / 64] >> (pair % 64) & 1)) {
+            for (const Candidate& c : byFirstByte[(uint8_t)url[pos]]) {
+                if ((head & c.mask) != c.prefix || left < c.size) continue;
+                if (c.size <= 8 || std::memcmp(url.data() + pos + 8, tokens[c.id].data() + 8, c.size - 8) == 0) {
+                    symbols.push_back((uint16_t)(256 + c.id));
+                    matched = c.size;
+                    break;
+                }
+            }
+        }
+        if (matched == 0) {
+            symbols.push_back((uint8_t)url[pos]);
+            matched = 1;
+        }
+        pos += matched;
+    }
+}
+
+// Canonical Huffman code limited to MAX_CODE_BITS (frequencies are halved
+// until it fits), and its single-level decode table
+void UrlCodec::buildCode(const std::vector<uint64_t>& frequencies) {
+    std::vector<uint64_t> scaled = frequencies;
+    std::vector<uint8_t> lengths;
+    for (;;) {
+        lengths = huffmanLengths(scaled);
+        if (*std::max_element(lengths.begin(), lengths.end()) <= MAX_CODE_BITS) break;
+        for (uint64_t& f : scaled) f = (f + 1) / 2;
+    }
+
+    size_t n = lengths.size();
+    std::vector<uint16_t> order(n);
+    for (size_t i = 0; i < n; i++) order[i] = (uint16_t)i;
+    std::sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) {
+        return lengths[a] != lengths[b] ? lengths[a] < lengths[b] : a < b;
+    });
+
+    codes.assign(n, 0);
+    codeBits = lengths;
+    decodeTable.assign(1 << MAX_CODE_BITS, DecodeEntry{0, 0});
+    uint32_t code = 0;
+    int previous = 0;
+    for (uint16_t s : order) {
+        code <<= lengths[s] - previous;
+        previous = lengths[s];
+        // Bits are written least significant first, so codes are stored reversed
+        codes[s] = reverseBits(code, lengths[s]);
+        for (uint32_t i = codes[s]; i < decodeTable.size(); i += 1u << lengths[s]) {
+            decodeTable[i] = {s, lengths[s]};
+        }
+        code++;
+    }
+}
+
+void UrlCodec::encode(std::string_view url, std::string& out) const {
+    out.clear();
+    if (url.empty()) return;
+    thread_local std::vector<uint16_t> symbols;
+    tokenize(url, symbols);
+
+    out.reserve(url.size() + 10);
+    out.push_back((char)tag);
+    putVarint(out, url.size());
+    uint64_t buffer = 0;
+    int bits = 0;
+    for (uint16_t s : symbols) {
+        buffer |= (uint64_t)codes[s] << bits;
+        bits += codeBits[s];
+        while (bits >= 8) {
+            out.push_back((char)(buffer & 0xFF));
+            buffer >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) out.push_back((char)buffer);
+}
+
+std::string UrlCodec::encode(std::string_view url) const {
+    std::string out;
+    encode(url, out);
+    return out;
+}
+
+size_t UrlCodec::decodedSize(std::string_view stored) {
+    if (stored.empty() || (uint8_t)stored[0] < 0x80) return stored.size();
+    size_t pos = 1;
+    uint64_t size;
+    return getVarint(stored, pos, size) ? (size_t)size : 0;
+}
+
+bool UrlCodec::decode(std::string_view stored, char* out) const {
+    if (stored.empty()) return true;
+    if ((uint8_t)stored[0] < 0x80) {
+        std::memcpy(out, stored.data(), stored.size());   // plain URL
+        return true;
+    }
+    size_t pos = 1;
+    uint64_t size;
+    if ((uint8_t)stored[0] != tag || !getVarint(stored, pos, size)) return false;
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(stored.data()) + pos;
+    const uint8_t* inEnd = reinterpret_cast<const uint8_t*>(stored.data()) + stored.size();
+    char* end = out + size;
+    uint64_t buffer = 0;
+    int bits = 0;
+    while (out < end) {
+        if (bits < MAX_CODE_BITS) {
+            // Top the buffer up to >= 56 bits; past the input it fills with zeros
+            if (inEnd - in >= 8) {
+                uint64_t word;
+                std::memcpy(&word, in, 8);   // little-endian
+                buffer |= word << bits;
+                in += (63 - bits) >> 3;
+                bits |= 56;
+            } else {
+                for (; bits <= 56; bits += 8) {
+                    if (in < inEnd) buffer |= (uint64_t)*in++ << bits;
+                }
+            }
+        }
+        DecodeEntry e = decodeTable[buffer & ((1u << MAX_CODE_BITS) - 1)];
+        buffer >>= e.bits;
+        bits -= e.bits;
+        if (e.symbol < 256) {
+            *out++ = (char)e.symbol;
+        } else {
+            const std::string& token = tokens[e.symbol - 256];
+            if ((size_t)(end - out) < token.size()) return false;   // corrupt
+            std::memcpy(out, token.data(), token.size());
+            out += token.size();
+        }
+    }
+    return true;
+}
+
+std::string UrlCodec::decode(std::string_view stored) const {
+    std::string url(decodedSize(stored), '\0');
+    if (!decode(stored, url.data())) return "";
+    return url;
+}
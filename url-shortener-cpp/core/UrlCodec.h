@@ -0,0 +1,77 @@
+#ifndef URL_CODEC_H
+#define URL_CODEC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compact encoding of long URLs, as the repository stores them.
+//
+// A URL is split greedily into tokens of a dictionary of frequent URL
+// pieces ("https://www.", "youtube.com/watch?v=", "utm_source=", ...) and
+// single bytes, and the symbols are Huffman-coded. Both the dictionary and
+// the code are trained from sample URLs; decoding is a table lookup per
+// symbol.
+//
+// Encoded value: tag byte (0x80 | model), decoded length (varint), bits.
+// A stored value whose first byte is below 0x80 is a plain URL written
+// before the codec existed (URLs start with an ASCII scheme) and decodes
+// to itself; "" stays "".
+class UrlCodec {
+public:
+    static constexpr uint8_t STANDARD_TAG = 0x81;
+
+    // The model stored values use, trained on a built-in sample of URLs.
+    // It is part of the on-disk format: change it only under a new tag.
+    static const UrlCodec& standard();
+
+    // Train a model on `samples` (values it encodes carry `tag`)
+    static UrlCodec train(const std::vector<std::string>& samples, uint8_t tag = 0x82,
+                          size_t maxTokens = 240);
+
+    // Replace `out` with the encoding of url
+    void encode(std::string_view url, std::string& out) const;
+    std::string encode(std::string_view url) const;
+
+    // Length of the URL a stored value decodes to
+    static size_t decodedSize(std::string_view stored);
+
+    // Write the decodedSize(stored) bytes of the URL to out. A value
+    // encoded by another model decodes to "" (false).
+    bool decode(std::string_view stored, char* out) const;
+    std::string decode(std::string_view stored) const;
+
+    size_t tokenCount() const { return tokens.size(); }
+
+private:
+    static constexpr int MAX_CODE_BITS = 12;   // = decode table index width
+
+    struct DecodeEntry {
+        uint16_t symbol;
+        uint8_t  bits;
+    };
+
+    // A token as tokenize() tries it: bytes 0-7 little-endian, matched
+    // with one masked compare, then the rest
+    struct Candidate {
+        uint64_t prefix, mask;
+        uint16_t id, size;
+    };
+
+    uint8_t tag = STANDARD_TAG;
+    std::vector<std::string> tokens;                      // symbol 256 + i
+    std::array<std::vector<Candidate>, 256> byFirstByte;  // longest first
+    std::vector<uint64_t> startPairs;  // bit b0 | b1 << 8: some token starts with b0 b1
+    std::vector<uint32_t> codes;                         // per symbol, bit-reversed
+    std::vector<uint8_t> codeBits;
+    std::vector<DecodeEntry> decodeTable;                // 1 << MAX_CODE_BITS entries
+
+    // Greedy longest-match split of url into symbols
+    void tokenize(std::string_view url, std::vector<uint16_t>& symbols) const;
+    void buildCode(const std::vector<uint64_t>& frequencies);
+};
+
+#endif
@@ -0,0 +1,23 @@
+#include "UrlHandle.h"
+#include <cstring>
+#include <new>
+
+UrlHandle::UrlHandle(std::string_view url) {
+    if (url.empty()) return;
+    std::memcpy(allocate(url.size()), url.data(), url.size());
+}
+
+char* UrlHandle::allocate(size_t size) {
+    void* mem = ::operator new(sizeof(Rep) + size);
+    rep = new (mem) Rep{{1}, (uint32_t)size};
+    return static_cast<char*>(mem) + sizeof(Rep);
+}
+
+// The last owner frees the block; acq_rel orders every other owner's reads
+// of the text before the free
+void UrlHandle::release() {
+    if (rep && rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ::operator delete(rep);   // Rep is trivially destructible
+    }
+    rep = nullptr;
+}
@@ -0,0 +1,66 @@
+#ifndef URL_HANDLE_H
+#define URL_HANDLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Immutable, reference-counted long URL. Copying a handle bumps a count
+// instead of copying the text, so the cache can hand a URL to a caller
+// without allocating, and the text stays valid for as long as any handle
+// holds it, even after its cache entry is replaced or evicted.
+//
+// The count and the text share one allocation. An empty URL is stored as
+// an empty handle, which is what lookups return for "not found".
+class UrlHandle {
+public:
+    UrlHandle() = default;
+    explicit UrlHandle(std::string_view url);
+
+    // Handle of `size` bytes written in place by fill(char* text), e.g. a
+    // decoder, with no intermediate string; empty if fill returns false
+    template <class Fill>
+    static UrlHandle build(size_t size, Fill&& fill) {
+        UrlHandle handle;
+        if (size == 0) return handle;
+        if (!fill(handle.allocate(size))) handle.release();
+        return handle;
+    }
+
+    UrlHandle(const UrlHandle& other) noexcept : rep(other.rep) { retain(); }
+    UrlHandle(UrlHandle&& other) noexcept : rep(other.rep) { other.rep = nullptr; }
+    UrlHandle& operator=(UrlHandle other) noexcept {
+        std::swap(rep, other.rep);
+        return *this;
+    }
+    ~UrlHandle() { release(); }
+
+    bool empty() const { return rep == nullptr; }
+    size_t size() const { return rep ? rep->size : 0; }
+
+    // Valid while this handle (or a copy) is alive
+    std::string_view view() const {
+        return rep ? std::string_view(rep->text(), rep->size) : std::string_view();
+    }
+    std::string str() const { return std::string(view()); }
+
+private:
+    struct Rep {
+        std::atomic<uint32_t> refs;
+        uint32_t size;
+        // The text follows the header in the same allocation
+        const char* text() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+    Rep* rep = nullptr;
+
+    void retain() const {
+        if (rep) rep->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release();
+    char* allocate(size_t size);   // rep with refs = 1; returns its text
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "WriteAheadLog.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// On-disk record: RecordHeader, then key bytes, then URL bytes.
+// `checksum` is FNV-1a over everything after it.
+namespace {
+
+struct RecordHeader {
+    uint32_t checksum;
+    uint32_t keyLen;
+    uint32_t urlLen;
+    uint8_t  op;
+    uint8_t  flags;             // FLAG_* (0 in logs written before flags existed)
+    uint8_t  reserved[2];
+    int64_t  expiresAt;
+};
+static_assert(sizeof(RecordHeader) == 24, "WAL record header must stay 24 bytes");
+
+constexpr uint8_t FLAG_GENERATED_KEY = 1;
+
+uint32_t fnv1a(uint32_t h, const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t recordChecksum(const RecordHeader& h, std::string_view key, std::string_view url) {
+    uint32_t c = fnv1a(2166136261u,
+                       reinterpret_cast<const char*>(&h) + sizeof(h.checksum),
+                       sizeof(h) - sizeof(h.checksum));
+    c = fnv1a(c, key.data(), key.size());
+    return fnv1a(c, url.data(), url.size());
+}
+
+}
+
+WriteAheadLog::WriteAheadLog(int commitMs, size_t commitBytes)
+    : groupCommitMs(commitMs > 0 ? commitMs : 1),
+      groupCommitBytes(commitBytes) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+#ifndef _WIN32
+
+bool WriteAheadLog::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (fd >= 0) return false;
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    stopping = false;
+    flusher = std::thread(&WriteAheadLog::flushLoop, this);
+    return true;
+}
+
+int WriteAheadLog::writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return n < 0 ? errno : EIO;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+void WriteAheadLog::flushPending(std::unique_lock<std::mutex>& lock) {
+    // Another thread (flusher or rotate) is already doing IO; let it finish
+    durableCv.wait(lock, [this] { return !flushing && retiringFd < 0; });
+    if (pending.empty() || fd < 0 || failedErrno) return;
+
+    std::string batch;
+    batch.swap(pending);
+    uint64_t batchLsn = appendedLsn;
+    int batchFd = fd;
+    flushing = true;
+    lock.unlock();
+
+    int err = writeAll(batchFd, batch.data(), batch.size());
+    if (err == 0 && ::fdatasync(batchFd) != 0) err = errno;
+
+    lock.lock();
+    flushing = false;
+    if (err == 0) durableLsn = batchLsn;
+    else failedErrno = err;   // the file may now end in a torn record: never append past it
+    durableCv.notify_all();
+}
+
+void WriteAheadLog::flushLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopping) {
+        flushCv.wait_for(lock, std::chrono::milliseconds(groupCommitMs), [this] {
+            return stopping
+                || (!pending.empty() && (waiters > 0 || pending.size() >= groupCommitBytes));
+        });
+        flushPending(lock);
+    }
+}
+
+bool WriteAheadLog::prepareRotate(const std::string& newPath) {
+    int next = ::open(newPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (next < 0) return false;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (fd < 0 || nextFd >= 0 || failedErrno) {
+        ::close(next);
+        return false;
+    }
+    nextFd = next;
+    return true;
+}
+
+bool WriteAheadLog::switchToPrepared() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (nextFd < 0 || retiringFd >= 0) return false;
+    if (failedErrno) {
+        ::close(nextFd);
+        nextFd = -1;
+        return false;
+    }
+    // An in-flight flush still targets the old fd and finishes on its own;
+    // whatever it has not taken goes to the old file in finishRotate()
+    retiringFd = fd;
+    retiring.swap(pending);
+    retiringLsn = appendedLsn;
+    fd = nextFd;
+    nextFd = -1;
+    return true;
+}
+
+bool WriteAheadLog::finishRotate() {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (retiringFd < 0) return false;
+    durableCv.wait(lock, [this] { return !flushing; });
+
+    std::string batch;
+    batch.swap(retiring);
+    int oldFd = retiringFd;
+    bool failed = failedErrno != 0;
+    flushing = true;
+    lock.unlock();
+
+    int err = failed ? 0 : writeAll(oldFd, batch.data(), batch.size());
+    if (!failed && err == 0 && ::fsync(oldFd) != 0) err = errno;
+    ::close(oldFd);
+
+    lock.lock();
+    flushing = false;
+    retiringFd = -1;
+    if (err == 0 && !failed) durableLsn = std::max(durableLsn, retiringLsn);
+    else if (err != 0) failedErrno = err;
+    durableCv.notify_all();
+    flushCv.notify_one();   // records for the new file may be waiting
+    return !failed && err == 0;
+}
+
+void WriteAheadLog::close() {
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (fd < 0) return;
+        stopping = true;
+        flushCv.notify_all();
+    }
+    if (flusher.joinable()) flusher.join();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    flushPending(lock);
+    ::fsync(fd);
+    ::close(fd);
+    fd = -1;
+    if (nextFd >= 0) ::close(nextFd);
+    nextFd = -1;
+}
+
+#else
+
+bool WriteAheadLog::open(const std::string&) { return false; }
+void WriteAheadLog::flushPending(std::unique_lock<std::mutex>&) {}
+void WriteAheadLog::flushLoop() {}
+bool WriteAheadLog::prepareRotate(const std::string&) { return false; }
+bool WriteAheadLog::switchToPrepared() { return false; }
+bool WriteAheadLog::finishRotate() { return false; }
+void WriteAheadLog::close() {}
+
+#endif
+
+uint64_t WriteAheadLog::append(Op op, std::string_view key, std::string_view url,
+                               int64_t expiresAt, bool generatedKey) {
+    RecordHeader h{};
+    h.keyLen = (uint32_t)key.size();
+    h.urlLen = (uint32_t)url.size();
+    h.op = (uint8_t)op;
+    h.flags = generatedKey ? FLAG_GENERATED_KEY : 0;
+    h.expiresAt = expiresAt;
+    h.checksum = recordChecksum(h, key, url);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (failedErrno) return 0;
+    pending.append(reinterpret_cast<const char*>(&h), sizeof(h));
+    pending.append(key.data(), key.size());
+    pending.append(url.data(), url.size());
+    if (pending.size() >= groupCommitBytes) flushCv.notify_one();
+    return ++appendedLsn;
+}
+
+bool WriteAheadLog::waitDurable(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (durableLsn >= lsn) return true;
+    if (fd < 0 || failedErrno) return false;
+    waiters++;
+    flushCv.notify_one();
+    durableCv.wait(lock, [&] { return durableLsn >= lsn || fd < 0 || failedErrno; });
+    waiters--;
+    return durableLsn >= lsn;
+}
+
+int WriteAheadLog::error() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return failedErrno;
+}
+
+size_t WriteAheadLog::replay(const std::string& path,
+                             const std::function<void(const Record&)>& apply) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+
+    size_t pos = 0, replayed = 0;
+    while (pos + sizeof(RecordHeader) <= data.size()) {
+        RecordHeader h;
+        std::memcpy(&h, data.data() + pos, sizeof(h));
+        size_t payload = (size_t)h.keyLen + h.urlLen;
+        if (payload > data.size() - pos - sizeof(h)) break;            // torn tail
+
+        const char* body = data.data() + pos + sizeof(h);
+        std::string_view key(body, h.keyLen);
+        std::string_view url(body + h.keyLen, h.urlLen);
+        if (recordChecksum(h, key, url) != h.checksum) break;          // corrupt
+        if (h.op != (uint8_t)Op::Save && h.op != (uint8_t)Op::Remove) break;
+
+        apply(Record{(Op)h.op, key, url, h.expiresAt, (h.flags & FLAG_GENERATED_KEY) != 0});
+        pos += sizeof(h) + payload;
+        replayed++;
+    }
+    return replayed;
+}
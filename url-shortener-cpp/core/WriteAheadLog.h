@@ -0,0 +1,100 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Append-only log of repository mutations with group commit.
+//
+// append() only copies the record into an in-memory buffer; a background
+// flusher writes the buffer and fdatasyncs it every groupCommitMs (or as
+// soon as groupCommitBytes are pending), so many writers share one sync.
+// Callers that need durability wait on the LSN append() returned.
+//
+// A failed write or sync is sticky: nothing after it counts as durable,
+// waitDurable() returns false and append() drops new records (returns 0).
+class WriteAheadLog {
+public:
+    enum class Op : uint8_t { Save = 1, Remove = 2 };
+
+    struct Record {
+        Op op;
+        std::string_view key;
+        std::string_view url;
+        int64_t expiresAt;
+        bool generatedKey;   // Save of a code generated from an ID (not an alias)
+    };
+
+    WriteAheadLog(int groupCommitMs = 5, size_t groupCommitBytes = 1 << 20);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Open (append to) a log file and start the flusher
+    bool open(const std::string& path);
+
+    // Continue in a new file, in three steps so a caller's own lock need
+    // only cover the cut-over:
+    // open the next file (IO; call without the caller's lock)
+    bool prepareRotate(const std::string& newPath);
+    // send every later append to the prepared file (no IO)
+    bool switchToPrepared();
+    // write, sync and close the previous file; records appended before
+    // the switch are durable once this returns true
+    bool finishRotate();
+
+    // Flush, sync and stop the flusher
+    void close();
+
+    // Buffer one record; returns its log sequence number, 0 if the log has failed
+    uint64_t append(Op op, std::string_view key, std::string_view url, int64_t expiresAt,
+                    bool generatedKey = false);
+
+    // Block until every record up to lsn is on stable storage; false if
+    // the log failed first
+    bool waitDurable(uint64_t lsn);
+
+    // errno of the write or sync that failed the log, 0 while healthy
+    int error() const;
+
+    // Replay every intact record of a log file in order. Stops at the first
+    // torn or corrupt record (a crash mid-write). Returns records replayed.
+    static size_t replay(const std::string& path,
+                         const std::function<void(const Record&)>& apply);
+
+private:
+    int groupCommitMs;
+    size_t groupCommitBytes;
+
+    mutable std::mutex mtx;
+    std::condition_variable flushCv;     // wakes the flusher early
+    std::condition_variable durableCv;   // wakes waitDurable()
+    std::string pending;                 // records not yet written
+    uint64_t appendedLsn = 0;            // LSN of the last buffered record
+    uint64_t durableLsn = 0;             // LSN of the last synced record
+    int failedErrno = 0;                 // sticky: set by the first failed write/sync
+    int waiters = 0;
+    bool flushing = false;
+    bool stopping = false;
+    int fd = -1;
+    int nextFd = -1;                     // opened by prepareRotate()
+    int retiringFd = -1;                 // previous file, until finishRotate()
+    std::string retiring;                // its records not yet written
+    uint64_t retiringLsn = 0;            // LSN of its last record
+    std::thread flusher;
+
+    void flushLoop();
+    // Write + sync `pending`; called with the lock held, releases it while doing IO.
+    // Waits for a retiring file first, so durableLsn only ever moves in order
+    void flushPending(std::unique_lock<std::mutex>& lock);
+    // Write all of [data, data + len) to fd; errno, or 0 on success
+    static int writeAll(int fd, const char* data, size_t len);
+};
+
+#endif
@@ -1,28 +1,135 @@
 #include "consistenthashing.h"
-#include <functional>
+#include "HashUtil.h"
+#include <algorithm>
 
-ConsistentHashRing::ConsistentHashRing(int vNodes)
-    : virtualNodes(vNodes) {}
+namespace {
 
-size_t ConsistentHashRing::hash(const std::string& key) const {
-    return std::hash<std::string>{}(key);
+// Finalizer from MurmurHash3: scrambles a key/node hash pair for Rendezvous
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Lamping & Veach, "A Fast, Minimal Memory, Consistent Hash Algorithm"
+int32_t jumpHash(uint64_t key, int32_t buckets) {
+    int64_t b = -1, j = 0;
+    while (j < buckets) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (int64_t)((b + 1) * (double(1LL << 31) / double((key >> 33) + 1)));
+    }
+    return (int32_t)b;
+}
+
+} // namespace
+
+ConsistentHashRing::ConsistentHashRing(int vNodes, HashAlgorithm algo, uint64_t hashSeed)
+    : virtualNodes(std::max(vNodes, 1)), algorithm(algo), seed(hashSeed) {}
+
+uint64_t ConsistentHashRing::hashKey(std::string_view key) const {
+    return hashString(key, seed);
 }
 
 void ConsistentHashRing::addNode(int nodeId) {
-    for (int i = 0; i < virtualNodes; i++) {
-        std::string vnodeKey = "NODE_" + std::to_string(nodeId) + "_" + std::to_string(i);
-        ring[hash(vnodeKey)] = nodeId;
+    if (std::find(nodes.begin(), nodes.end(), nodeId) != nodes.end()) return;
+    std::string name = "NODE_" + std::to_string(nodeId);
+    nodes.push_back(nodeId);
+    nodeHashes.push_back(hashString(name, seed));
+
+    switch (algorithm) {
+        case HashAlgorithm::Ring:
+            for (int i = 0; i < virtualNodes; i++) {
+                std::string vnodeKey = name + "_" + std::to_string(i);
+                points.push_back({hashString(vnodeKey, seed), nodeId});
+            }
+            std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+                return a.hash != b.hash ? a.hash < b.hash : a.nodeId < b.nodeId;
+            });
+            rebuildSlots();
+            break;
+        case HashAlgorithm::Maglev:
+            rebuildMaglev();
+            break;
+        case HashAlgorithm::Jump:
+        case HashAlgorithm::Rendezvous:
+            break;
     }
 }
 
-int ConsistentHashRing::getNode(const std::string& key) const {
-    if (ring.empty()) return -1;
+// About two slots per point, so a lookup scans well under one point past
+// its slot on average
+void ConsistentHashRing::rebuildSlots() {
+    slotBits = 1;
+    while (slotBits < 20 && ((size_t)1 << slotBits) < points.size() * 2) slotBits++;
+    size_t slots = (size_t)1 << slotBits;
+    slotStart.assign(slots + 1, (uint32_t)points.size());
+    size_t p = 0;
+    for (size_t s = 0; s < slots; s++) {
+        uint64_t start = (uint64_t)s << (64 - slotBits);
+        while (p < points.size() && points[p].hash < start) p++;
+        slotStart[s] = (uint32_t)p;
+    }
+}
+
+// Each node walks its own permutation of the table (offset + j * skip)
+// and claims the next free entry, round-robin, until the table is full
+void ConsistentHashRing::rebuildMaglev() {
+    const uint32_t m = MAGLEV_TABLE_SIZE;
+    size_t n = nodes.size();
+    std::vector<uint32_t> offset(n), skip(n), next(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t h = nodeHashes[i];
+        offset[i] = (uint32_t)(h % m);
+        skip[i] = (uint32_t)(mix64(h) % (m - 1)) + 1;
+    }
+
+    maglevTable.assign(m, -1);
+    uint32_t filled = 0;
+    while (filled < m) {
+        for (size_t i = 0; i < n && filled < m; i++) {
+            uint32_t slot;
+            do {
+                slot = (uint32_t)((offset[i] + (uint64_t)next[i]++ * skip[i]) % m);
+            } while (maglevTable[slot] >= 0);
+            maglevTable[slot] = nodes[i];
+            filled++;
+        }
+    }
+}
+
+int ConsistentHashRing::getNode(std::string_view key) const {
+    return getNodeForHash(hashKey(key));
+}
 
-    size_t h = hash(key);
-    auto it = ring.lower_bound(h);
+int ConsistentHashRing::getNodeForHash(uint64_t h) const {
+    if (nodes.empty()) return -1;
 
-    if (it == ring.end()) {
-        return ring.begin()->second;
+    switch (algorithm) {
+        case HashAlgorithm::Ring: {
+            size_t i = slotStart[h >> (64 - slotBits)];
+            while (i < points.size() && points[i].hash < h) i++;
+            return i == points.size() ? points.front().nodeId : points[i].nodeId;
+        }
+        case HashAlgorithm::Jump:
+            return nodes[jumpHash(h, (int32_t)nodes.size())];
+        case HashAlgorithm::Maglev:
+            return maglevTable[h % MAGLEV_TABLE_SIZE];
+        case HashAlgorithm::Rendezvous: {
+            size_t best = 0;
+            uint64_t bestScore = 0;
+            for (size_t i = 0; i < nodes.size(); i++) {
+                uint64_t score = mix64(h ^ nodeHashes[i]);
+                if (score >= bestScore) {
+                    bestScore = score;
+                    best = i;
+                }
+            }
+            return nodes[best];
+        }
     }
-    return it->second;
+    return -1;
 }
@@ -1,19 +1,59 @@
 #pragma once
 #include <string>
-#include <map>
+#include <string_view>
 #include <vector>
+#include <cstdint>
 
+// How ConsistentHashRing maps a key's hash to a node
+enum class HashAlgorithm {
+    Ring,           // virtual nodes on a sorted ring, O(1) slot table + short scan
+    Jump,           // jump consistent hash: no table, nodes only ever appended
+    Maglev,         // Maglev permutation table, one array read per lookup
+    Rendezvous      // highest random weight, O(nodes) per lookup
+};
+
+// Keys and node names are hashed with the seeded MurmurHash64A from
+// HashUtil.h, so assignments are identical across builds and processes
+// (std::hash is implementation-defined).
 class ConsistentHashRing {
 public:
-    ConsistentHashRing(int virtualNodes = 3);
+    static constexpr int DEFAULT_VIRTUAL_NODES = 160;
+    static constexpr uint32_t MAGLEV_TABLE_SIZE = 65537;   // prime, >> node count
+
+    // virtualNodes only applies to HashAlgorithm::Ring
+    ConsistentHashRing(int virtualNodes = DEFAULT_VIRTUAL_NODES,
+                       HashAlgorithm algorithm = HashAlgorithm::Ring, uint64_t seed = 0);
 
     void addNode(int nodeId);
-    int getNode(const std::string& key) const;
+    int getNode(std::string_view key) const;   // -1 when there are no nodes
+
+    // Same as getNode for a key whose hashKey() is already known
+    int getNodeForHash(uint64_t keyHash) const;
+    uint64_t hashKey(std::string_view key) const;
+
+    const std::vector<int>& getNodes() const { return nodes; }
+    HashAlgorithm getAlgorithm() const { return algorithm; }
 
 private:
+    struct Point {
+        uint64_t hash;
+        int nodeId;
+    };
+
     int virtualNodes;
-    std::map<size_t, int> ring; // hash -> nodeId
+    HashAlgorithm algorithm;
+    uint64_t seed;
+    std::vector<int> nodes;             // in the order they were added
+    std::vector<uint64_t> nodeHashes;   // per node, for Rendezvous
 
-    size_t hash(const std::string& key) const;
-};
+    // Ring: points sorted by hash; slotStart[s] is the first point at or
+    // after slot s's range (top slotBits bits of the hash)
+    std::vector<Point> points;
+    std::vector<uint32_t> slotStart;
+    int slotBits = 0;
 
+    std::vector<int> maglevTable;       // MAGLEV_TABLE_SIZE node ids
+
+    void rebuildSlots();
+    void rebuildMaglev();
+};
@@ -1,42 +1,894 @@
 #include "urlrespository.h"
+#include "Base62Encoder.h"
+#include "HashUtil.h"
+#include "UrlCodec.h"
+#include <algorithm>
+#include <filesystem>
+#include <vector>
 
-void UrlRepository::save(const std::string& shortCode,
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t TOUCH_SEED        = 0x70c4ULL;
+constexpr size_t   MIN_TOUCH_BITS    = 1 << 16;
+constexpr size_t   DEMOTE_SCAN_SLOTS = 4096;   // slots visited per shared lock hold
+
+// Decode a stored URL straight into the caller's string or handle
+void assignUrl(std::string& out, std::string_view stored) {
+    out.resize(UrlCodec::decodedSize(stored));
+    if (!UrlCodec::standard().decode(stored, out.data())) out.clear();
+}
+void assignUrl(UrlHandle& out, std::string_view stored) {
+    out = UrlHandle::build(UrlCodec::decodedSize(stored),
+                           [&](char* text) { return UrlCodec::standard().decode(stored, text); });
+}
+
+// Plain URLs (from logs written before the codec) are encoded on replay
+std::string_view storedForm(std::string_view url, std::string& scratch) {
+    if (url.empty() || (uint8_t)url[0] >= 0x80) return url;
+    UrlCodec::standard().encode(url, scratch);
+    return scratch;
+}
+
+} // namespace
+
+UrlRepository::UrlRepository(int64_t expiryTickMs, bool lookupFilter)
+    : wheel(expiryTickMs, nowMs()), useFilter(lookupFilter) {}
+
+UrlRepository::~UrlRepository() {
+    {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        stopSnapshots = true;
+    }
+    snapshotCv.notify_all();
+    if (snapshotThread.joinable()) snapshotThread.join();
+    if (wal) wal->close();
+}
+
+int64_t UrlRepository::nowMs() {
+    // Wall clock, so expiry times stay meaningful across restarts
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void UrlRepository::putEntry(std::string_view shortCode, std::string_view longUrl,
+                             int64_t expiresAt) {
+    int64_t previous;
+    if (coldTombstones > 0 && store.expiryOf(shortCode, previous) && previous == COLD_TOMBSTONE) {
+        coldTombstones--;
+    }
+    bool added = store.put(shortCode, longUrl, expiresAt);
+    if (expiresAt == COLD_TOMBSTONE) coldTombstones++;   // replayed from the log
+    if (added && useFilter && !filter.insert(shortCode)) rebuildFilter();
+    if (expiresAt > 0) wheel.schedule(shortCode, expiresAt);
+    touch(shortCode);
+}
+
+bool UrlRepository::eraseEntry(std::string_view shortCode, bool* tombstoned) {
+    int64_t expiresAt;
+    bool hot = store.expiryOf(shortCode, expiresAt);
+    bool wasTombstone = hot && expiresAt == COLD_TOMBSTONE;
+    if (cold) {
+        if (wasTombstone) return false;   // already removed
+        std::string_view url;
+        if (findCold(*cold, shortCode, url, expiresAt)) {
+            // Hide the cold copy; the code stays in the filter for it
+            store.put(shortCode, "", COLD_TOMBSTONE);
+            coldTombstones++;
+            if (tombstoned) *tombstoned = true;
+            return true;
+        }
+    }
+    if (!hot) return false;
+    store.erase(shortCode);
+    if (wasTombstone) coldTombstones--;   // replaying a merge's purge
+    if (useFilter) filter.remove(shortCode);
+    return true;
+}
+
+// A tombstone is logged as the save it is, so replay restores it
+uint64_t UrlRepository::logErase(std::string_view shortCode, bool tombstoned) {
+    noteMutation();
+    return tombstoned ? wal->append(WriteAheadLog::Op::Save, shortCode, "", COLD_TOMBSTONE)
+                      : wal->append(WriteAheadLog::Op::Remove, shortCode, "", 0);
+}
+
+// Filter full (or reloaded from disk): rebuild it with room to double.
+// Cold codes stay in it, so it answers for both tiers.
+void UrlRepository::rebuildFilter() {
+    size_t keys = store.size();
+    if (cold) {
+        for (const auto& table : *cold) keys += table->size();
+    }
+    filter.rebuild(keys * 2, [this](auto&& add) {
+        store.forEach([&](std::string_view key, int64_t expiresAt) {
+            if (expiresAt != COLD_TOMBSTONE) add(key);
+        });
+        if (!cold) return;
+        for (const auto& table : *cold) {
+            table->forEach([&](std::string_view key, std::string_view, int64_t) { add(key); });
+        }
+    });
+}
+
+bool UrlRepository::save(const std::string& shortCode,
                          const std::string& longUrl,
-                         int ttlSeconds) {
-    std::lock_guard<std::mutex> lock(mtx);
-    UrlEntry entry;
-    entry.longUrl = longUrl;
-    entry.hasExpiry = (ttlSeconds > 0);
-    if (entry.hasExpiry) {
-        entry.expiresAt = std::chrono::steady_clock::now()
-                        + std::chrono::seconds(ttlSeconds);
+                         int ttlSeconds,
+                         int64_t generatedId) {
+    int64_t expiresAt = ttlSeconds > 0 ? nowMs() + ttlSeconds * 1000LL : 0;
+    thread_local std::string stored;
+    UrlCodec::standard().encode(longUrl, stored);   // outside the lock
+    uint64_t lsn = 0;
+    bool logged = true;
+    {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        if (expiredSeen.load(std::memory_order_relaxed)) reapDue(nullptr);
+        putEntry(shortCode, stored, expiresAt);
+        highestId = std::max(highestId, generatedId);
+        if (wal) {
+            lsn = wal->append(WriteAheadLog::Op::Save, shortCode, stored, expiresAt, generatedId > 0);
+            logged = lsn != 0;
+            noteMutation();
+        }
     }
-    store[shortCode] = entry;
+    if (lsn && persistence.waitForDurable) logged = wal->waitDurable(lsn);
+    return logged;
 }
 
-std::string UrlRepository::find(const std::string& shortCode) {
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = store.find(shortCode);
-    if (it == store.end()) return "";
+size_t UrlRepository::saveBatch(std::vector<RepositoryWrite>& writes) {
+    int64_t now = nowMs();
+    std::string stored;
+    std::vector<size_t> ends;   // encoded URLs back to back, outside the lock
+    ends.reserve(writes.size());
+    std::string scratch;
+    for (const RepositoryWrite& w : writes) {
+        UrlCodec::standard().encode(w.longUrl, scratch);
+        stored += scratch;
+        ends.push_back(stored.size());
+    }
 
-    const UrlEntry& entry = it->second;
-    if (entry.hasExpiry) {
-        auto now = std::chrono::steady_clock::now();
-        if (now > entry.expiresAt) {
-            // URL has expired — remove it
-            store.erase(it);
-            return "";
+    uint64_t lsn = 0;
+    size_t saved = 0;
+    bool logged = true;
+    {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        if (expiredSeen.load(std::memory_order_relaxed)) reapDue(nullptr);
+        for (size_t i = 0; i < writes.size(); i++) {
+            RepositoryWrite& w = writes[i];
+            w.saved = !(w.onlyIfAbsent && containsLocked(w.shortCode));
+            if (!w.saved) continue;
+            int64_t expiresAt = w.expiresAt != 0 ? w.expiresAt
+                              : w.ttlSeconds > 0 ? now + w.ttlSeconds * 1000LL : 0;
+            size_t begin = i == 0 ? 0 : ends[i - 1];
+            std::string_view longUrl(stored.data() + begin, ends[i] - begin);
+            putEntry(w.shortCode, longUrl, expiresAt);
+            highestId = std::max(highestId, w.generatedId);
+            if (wal) {
+                uint64_t recordLsn = wal->append(WriteAheadLog::Op::Save, w.shortCode, longUrl, expiresAt,
+                                                 w.generatedId > 0);
+                logged = logged && recordLsn != 0;
+                lsn = std::max(lsn, recordLsn);
+                noteMutation();
+            }
+            saved++;
         }
     }
-    return entry.longUrl;
+    // One durability wait covers the whole batch
+    if (lsn && persistence.waitForDurable) logged = wal->waitDurable(lsn) && logged;
+    for (RepositoryWrite& w : writes) w.persisted = w.saved && logged;
+    return saved;
 }
 
-bool UrlRepository::exists(const std::string& shortCode) {
-    std::lock_guard<std::mutex> lock(mtx);
-    return store.find(shortCode) != store.end();
+std::string UrlRepository::find(std::string_view shortCode) {
+    int64_t expiresAt;
+    return find(shortCode, expiresAt);
 }
 
-void UrlRepository::remove(const std::string& shortCode) {
-    std::lock_guard<std::mutex> lock(mtx);
-    store.erase(shortCode);
+std::string UrlRepository::find(std::string_view shortCode, int64_t& expiresAt) {
+    std::string longUrl;
+    if (!lookup(shortCode, longUrl, expiresAt)) return "";
+    return longUrl;
+}
+
+UrlHandle UrlRepository::findHandle(std::string_view shortCode, int64_t& expiresAt) {
+    UrlHandle longUrl;
+    if (!lookup(shortCode, longUrl, expiresAt)) return UrlHandle();
+    return longUrl;
+}
+
+template <typename Out>
+bool UrlRepository::lookup(std::string_view shortCode, Out& longUrl, int64_t& expiresAt) {
+    if (useFilter && !filter.mayContain(shortCode)) return false;   // definitely absent
+    std::shared_ptr<const ColdSet> tables;
+    {
+        std::shared_lock<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        std::string_view url;
+        if (store.view(shortCode, url, expiresAt)) {
+            if (expiresAt == COLD_TOMBSTONE) return false;
+            assignUrl(longUrl, url);
+            touch(shortCode);
+        } else if (cold) {
+            tables = cold;
+        } else {
+            return false;
+        }
+    }
+
+    if (tables) return lookupCold(shortCode, longUrl, expiresAt, tables);
+
+    if (expiresAt != 0 && nowMs() > expiresAt) {
+        // Expired: hidden now, erased by the reaper or the next write
+        expiredSeen.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// Tables are immutable: search them (maybe faulting pages in) unlocked
+template <typename Out>
+bool UrlRepository::lookupCold(std::string_view shortCode, Out& longUrl, int64_t& expiresAt,
+                               const std::shared_ptr<const ColdSet>& tables) {
+    std::string_view url;
+    if (!findCold(*tables, shortCode, url, expiresAt)) return false;
+    if (expiresAt != 0 && nowMs() > expiresAt) return false;   // dropped by the next merge
+    assignUrl(longUrl, url);
+    promote(shortCode, url, expiresAt, tables);
+    return true;
+}
+
+void UrlRepository::findMany(const std::vector<std::string_view>& codes, std::vector<UrlHandle>& out,
+                             std::vector<int64_t>& expiresAt) {
+    enum : uint8_t { ABSENT, HOT, COLD };   // where to look for each code next
+    size_t n = codes.size();
+    out.assign(n, UrlHandle());
+    expiresAt.assign(n, 0);
+    thread_local std::vector<size_t> hashes;
+    thread_local std::vector<std::string_view> urls;
+    thread_local std::vector<uint8_t> where;
+    hashes.resize(n);
+    urls.assign(n, std::string_view());
+    where.assign(n, HOT);
+
+    if (useFilter) {
+        for (std::string_view code : codes) filter.prefetch(code);
+    }
+    for (size_t i = 0; i < n; i++) hashes[i] = FlatUrlStore::hashOf(codes[i]);
+    if (useFilter) {
+        for (size_t i = 0; i < n; i++) {
+            if (!filter.mayContain(codes[i])) where[i] = ABSENT;   // definitely absent
+        }
+    }
+
+    std::shared_ptr<const ColdSet> tables;
+    {
+        std::shared_lock<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        for (size_t i = 0; i < n; i++) {
+            if (where[i] == HOT) store.prefetch(hashes[i]);
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (where[i] != HOT) continue;
+            if (!store.view(codes[i], hashes[i], urls[i], expiresAt[i])) {
+                where[i] = cold ? COLD : ABSENT;
+            } else if (expiresAt[i] == COLD_TOMBSTONE) {
+                where[i] = ABSENT;
+            } else if (!urls[i].empty()) {
+                prefetchRead(urls[i].data());
+            }
+        }
+        int64_t now = nowMs();
+        for (size_t i = 0; i < n; i++) {
+            if (where[i] != HOT) continue;
+            if (expiresAt[i] != 0 && now > expiresAt[i]) {
+                expiredSeen.store(true, std::memory_order_relaxed);   // as in lookup()
+                continue;
+            }
+            assignUrl(out[i], urls[i]);
+            touch(codes[i]);
+        }
+        if (std::find(where.begin(), where.end(), (uint8_t)COLD) != where.end()) tables = cold;
+    }
+
+    for (size_t i = 0; tables && i < n; i++) {
+        if (where[i] == COLD) lookupCold(codes[i], out[i], expiresAt[i], tables);
+    }
+}
+
+void UrlRepository::findBatch(const std::vector<std::string>& codes,
+                              std::vector<RepositoryEntry>& out) {
+    int64_t now = nowMs();
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+    RepositoryEntry entry;
+    for (const std::string& code : codes) {
+        std::string_view url;
+        if (store.view(code, url, entry.expiresAt)) {
+            if (entry.expiresAt == COLD_TOMBSTONE) continue;
+        } else if (!cold || !findCold(*cold, code, url, entry.expiresAt)) {
+            continue;
+        }
+        if (entry.expiresAt != 0 && now > entry.expiresAt) continue;   // left to the reaper
+        entry.shortCode = code;
+        assignUrl(entry.longUrl, url);
+        out.push_back(std::move(entry));
+    }
+}
+
+size_t UrlRepository::reapExpired(std::vector<std::string>& removed) {
+    std::lock_guard<ReadMostlyLock> lock(mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+    return reapDue(&removed);
+}
+
+// Not logged: replay re-derives expiry
+size_t UrlRepository::reapDue(std::vector<std::string>* removed) {
+    expiredSeen.store(false, std::memory_order_relaxed);
+    std::vector<ExpiryWheel::Entry> due;
+    wheel.advance(nowMs(), due);
+
+    size_t reaped = 0;
+    for (ExpiryWheel::Entry& e : due) {
+        // Skip stale wheel entries: removed, or re-saved with another TTL
+        int64_t current;
+        if (!store.expiryOf(e.key, current) || current != e.expiresAt) continue;
+        eraseEntry(e.key);
+        if (removed) removed->push_back(std::move(e.key));
+        reaped++;
+    }
+    expiredRemoved += reaped;
+    return reaped;
+}
+
+bool UrlRepository::exists(std::string_view shortCode) {
+    if (useFilter && !filter.mayContain(shortCode)) return false;
+    std::shared_ptr<const ColdSet> tables;
+    {
+        std::shared_lock<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        int64_t expiresAt;
+        if (store.expiryOf(shortCode, expiresAt)) return expiresAt != COLD_TOMBSTONE;
+        if (!cold) return false;
+        tables = cold;
+    }
+    std::string_view url;
+    int64_t expiresAt;
+    return findCold(*tables, shortCode, url, expiresAt);
+}
+
+bool UrlRepository::containsLocked(std::string_view shortCode) const {
+    int64_t expiresAt;
+    if (store.expiryOf(shortCode, expiresAt)) return expiresAt != COLD_TOMBSTONE;
+    std::string_view url;
+    return cold && findCold(*cold, shortCode, url, expiresAt);
+}
+
+void UrlRepository::remove(std::string_view shortCode) {
+    uint64_t lsn = 0;
+    {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        bool tombstoned = false;
+        if (eraseEntry(shortCode, &tombstoned) && wal) lsn = logErase(shortCode, tombstoned);
+    }
+    if (lsn && persistence.waitForDurable) wal->waitDurable(lsn);
+}
+
+void UrlRepository::removeBatch(const std::vector<std::string>& codes) {
+    uint64_t lsn = 0;
+    {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        for (const std::string& code : codes) {
+            bool tombstoned = false;
+            if (eraseEntry(code, &tombstoned) && wal) lsn = logErase(code, tombstoned);
+        }
+    }
+    if (lsn && persistence.waitForDurable) wal->waitDurable(lsn);
+}
+
+size_t UrlRepository::size() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    return store.size() - coldTombstones;
+}
+
+size_t UrlRepository::pendingExpiries() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    return wheel.pending();
+}
+
+size_t UrlRepository::expiredCount() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    return expiredRemoved;
+}
+
+int UrlRepository::persistenceError() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    return wal ? wal->error() : 0;
+}
+
+int64_t UrlRepository::highestGeneratedId() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    return highestId;
+}
+
+size_t UrlRepository::memoryBytes() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    size_t bytes = store.memoryBytes() + filter.memoryBytes() + touchWords * 2 * sizeof(uint64_t);
+    if (cold) {
+        for (const auto& table : *cold) bytes += table->indexBytes();
+    }
+    return bytes;
+}
+
+size_t UrlRepository::filterBytes() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    return filter.memoryBytes();
+}
+
+// ─────────────────────────────────────────────
+// Persistence
+// ─────────────────────────────────────────────
+
+std::string UrlRepository::walPath(uint64_t gen) const {
+    return (fs::path(persistence.dataDir) / ("wal-" + std::to_string(gen) + ".log")).string();
+}
+
+std::string UrlRepository::snapshotPath(uint64_t gen) const {
+    return (fs::path(persistence.dataDir) / ("snapshot-" + std::to_string(gen) + ".snap")).string();
+}
+
+// Parse "<prefix><gen><suffix>" file names
+static bool parseGeneration(const std::string& name, const std::string& prefix,
+                            const std::string& suffix, uint64_t& gen) {
+    if (name.size() <= prefix.size() + suffix.size()) return false;
+    if (name.compare(0, prefix.size(), prefix) != 0) return false;
+    if (name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) return false;
+    std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    if (digits.empty() || !std::all_of(digits.begin(), digits.end(), ::isdigit)) return false;
+    gen = std::stoull(digits);
+    return true;
+}
+
+static void syncDirectory(const std::string& dir) {
+#ifndef _WIN32
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)dir;
+#endif
+}
+
+bool UrlRepository::enablePersistence(const PersistenceOptions& options) {
+    std::lock_guard<ReadMostlyLock> lock(mtx);
+    if (wal || options.dataDir.empty()) return false;
+
+    std::error_code ec;
+    fs::create_directories(options.dataDir, ec);
+    if (ec) return false;
+    persistence = options;
+
+    std::vector<uint64_t> snapshots, logs;
+    for (const auto& entry : fs::directory_iterator(options.dataDir, ec)) {
+        std::string name = entry.path().filename().string();
+        uint64_t gen;
+        if (parseGeneration(name, "snapshot-", ".snap", gen)) snapshots.push_back(gen);
+        else if (parseGeneration(name, "wal-", ".log", gen)) logs.push_back(gen);
+    }
+    std::sort(snapshots.rbegin(), snapshots.rend());
+    std::sort(logs.begin(), logs.end());
+
+    // Newest snapshot that loads cleanly; older ones are fallbacks
+    uint64_t baseGen = 0;
+    store = FlatUrlStore();
+    highestId = 0;
+    for (uint64_t gen : snapshots) {
+        if (store.loadSnapshot(snapshotPath(gen), &highestId)) {
+            baseGen = gen;
+            break;
+        }
+    }
+    coldTombstones = 0;
+    store.forEach([this](std::string_view key, int64_t expiresAt) {
+        if (expiresAt > 0) wheel.schedule(key, expiresAt);
+        else if (expiresAt == COLD_TOMBSTONE) coldTombstones++;
+    });
+    if (useFilter) rebuildFilter();
+
+    // Replay only the log tail written after that snapshot
+    for (uint64_t gen : logs) {
+        if (gen < baseGen) continue;
+        std::string scratch;
+        WriteAheadLog::replay(walPath(gen), [&](const WriteAheadLog::Record& r) {
+            if (r.op == WriteAheadLog::Op::Save) putEntry(r.key, storedForm(r.url, scratch), r.expiresAt);
+            else eraseEntry(r.key);
+            long long id = 0;
+            if (r.generatedKey && Base62Encoder::decode(r.key, id)) highestId = std::max<int64_t>(highestId, id);
+        });
+    }
+
+    // Always start a fresh log, so a torn tail is never appended to
+    uint64_t maxGen = baseGen;
+    if (!logs.empty()) maxGen = std::max(maxGen, logs.back());
+    walGeneration = maxGen + 1;
+
+    wal = std::make_unique<WriteAheadLog>(options.groupCommitMs, options.groupCommitBytes);
+    if (!wal->open(walPath(walGeneration))) {
+        wal.reset();
+        return false;
+    }
+    syncDirectory(options.dataDir);
+    opsSinceSnapshot = 0;
+
+    if (options.snapshotEveryOps > 0) {
+        stopSnapshots = false;
+        snapshotThread = std::thread(&UrlRepository::snapshotLoop, this);
+    }
+    return true;
+}
+
+void UrlRepository::noteMutation() {
+    if (persistence.snapshotEveryOps > 0
+        && ++opsSinceSnapshot >= persistence.snapshotEveryOps
+        && !snapshotRequested.exchange(true)) {
+        snapshotCv.notify_one();
+    }
+}
+
+void UrlRepository::snapshotLoop() {
+    std::unique_lock<ReadMostlyLock> lock(mtx);
+    while (!stopSnapshots) {
+        snapshotCv.wait_for(lock, std::chrono::seconds(1), [this] {
+            return stopSnapshots || snapshotRequested.load();
+        });
+        if (stopSnapshots || !snapshotRequested.load()) continue;
+
+        lock.unlock();
+        snapshot();
+        snapshotRequested = false;
+        lock.lock();
+    }
+}
+
+bool UrlRepository::snapshot() {
+    std::lock_guard<std::mutex> snapLock(snapshotMtx);
+
+    // wal is set before the snapshot thread starts, and walGeneration only
+    // changes under snapshotMtx
+    if (!wal) return false;
+    uint64_t gen = walGeneration + 1;
+    if (!wal->prepareRotate(walPath(gen))) return false;
+
+    FlatUrlStore::SnapshotView view;
+    {
+        // Cut over to the new log and copy the slot array; syncing the old
+        // log and writing the snapshot happen after the lock is released
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        if (!wal->switchToPrepared()) return false;
+        walGeneration = gen;
+        view = store.snapshotView();
+        view.highestId = highestId;
+        opsSinceSnapshot = 0;
+    }
+
+    if (!wal->finishRotate()) return false;
+    if (!FlatUrlStore::writeSnapshot(view, snapshotPath(gen))) return false;
+    syncDirectory(persistence.dataDir);
+
+    // snapshot-gen supersedes every older snapshot and log
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(persistence.dataDir, ec)) {
+        std::string name = entry.path().filename().string();
+        uint64_t old;
+        if ((parseGeneration(name, "snapshot-", ".snap", old)
+             || parseGeneration(name, "wal-", ".log", old)) && old < gen) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+    return true;
+}
+
+// ─────────────────────────────────────────────
+// Cold tier
+// ─────────────────────────────────────────────
+
+std::string UrlRepository::coldPath(uint64_t seq) const {
+    return (fs::path(coldOptions.dir) / ("cold-" + std::to_string(seq) + ".sst")).string();
+}
+
+bool UrlRepository::findCold(const ColdSet& tables, std::string_view shortCode,
+                             std::string_view& longUrl, int64_t& expiresAt) {
+    for (const auto& table : tables) {
+        if (table->get(shortCode, longUrl, expiresAt)) return true;
+    }
+    return false;
+}
+
+// Copy a cold hit back into memory, unless the code was written or removed
+// meanwhile or a merge replaced the tables it was found in
+void UrlRepository::promote(std::string_view shortCode, std::string_view longUrl, int64_t expiresAt,
+                            const std::shared_ptr<const ColdSet>& searched) {
+    std::lock_guard<ReadMostlyLock> lock(mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+    if (cold != searched || store.contains(shortCode)) return;
+    store.put(shortCode, longUrl, expiresAt);   // already in the filter
+    if (expiresAt > 0) wheel.schedule(shortCode, expiresAt);
+    touch(shortCode);
+}
+
+void UrlRepository::touch(std::string_view shortCode) {
+    if (touchWords == 0) return;
+    uint64_t bit = hashString(shortCode, TOUCH_SEED) & (touchWords * 64 - 1);
+    std::atomic<uint64_t>& word = touchBits[activeTouch][bit / 64];
+    uint64_t mask = 1ULL << (bit % 64);
+    // Read first: popular codes are already marked, and a plain load keeps
+    // the cache line shared between readers
+    if (!(word.load(std::memory_order_relaxed) & mask)) word.fetch_or(mask, std::memory_order_relaxed);
+}
+
+bool UrlRepository::touched(std::string_view shortCode) const {
+    if (touchWords == 0) return true;
+    uint64_t bit = hashString(shortCode, TOUCH_SEED) & (touchWords * 64 - 1);
+    uint64_t mask = 1ULL << (bit % 64);
+    return ((touchBits[0][bit / 64].load(std::memory_order_relaxed)
+           | touchBits[1][bit / 64].load(std::memory_order_relaxed)) & mask) != 0;
+}
+
+// Keep ~4 bits per entry. The bit of a code in the larger bitmap maps onto
+// its bit in the old one, so tiling the old words keeps every mark.
+void UrlRepository::resizeTouchBits() {
+    size_t bits = MIN_TOUCH_BITS;
+    while (bits < store.size() * 4) bits <<= 1;
+    size_t words = bits / 64;
+    if (words <= touchWords) return;
+    for (auto& bitmap : touchBits) {
+        std::unique_ptr<std::atomic<uint64_t>[]> grown(new std::atomic<uint64_t>[words]);
+        for (size_t i = 0; i < words; i++) {
+            grown[i].store(touchWords ? bitmap[i & (touchWords - 1)].load(std::memory_order_relaxed) : 0,
+                           std::memory_order_relaxed);
+        }
+        bitmap = std::move(grown);
+    }
+    touchWords = words;
+}
+
+bool UrlRepository::enableColdTier(const ColdTierOptions& options) {
+#ifdef _WIN32
+    (void)options;
+    return false;   // ColdTable is mmap-based
+#else
+    std::lock_guard<std::mutex> coldLock(coldMtx);
+    std::lock_guard<ReadMostlyLock> lock(mtx);
+    if (!coldOptions.dir.empty() || options.dir.empty()) return false;
+
+    std::error_code ec;
+    fs::create_directories(options.dir, ec);
+    if (ec) return false;
+    coldOptions = options;
+
+    // Tables only make sense next to the links they were demoted from: keep
+    // them if this repository reloaded its state, otherwise they are stale
+    std::vector<uint64_t> seqs;
+    for (const auto& entry : fs::directory_iterator(options.dir, ec)) {
+        std::string name = entry.path().filename().string();
+        uint64_t seq;
+        if (parseGeneration(name, "cold-", ".sst", seq)) {
+            if (wal) seqs.push_back(seq);
+            else fs::remove(entry.path(), ec);
+        } else if (parseGeneration(name, "cold-", ".sst.tmp", seq)) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+    std::sort(seqs.rbegin(), seqs.rend());
+
+    auto tables = std::make_shared<ColdSet>();
+    for (uint64_t seq : seqs) {
+        if (auto table = ColdTable::open(coldPath(seq))) tables->push_back(std::move(table));
+        nextColdSeq = std::max(nextColdSeq, seq + 1);
+    }
+    cold = std::move(tables);
+    resizeTouchBits();
+    if (useFilter) rebuildFilter();
+    return true;
+#endif
+}
+
+size_t UrlRepository::demoteIdle() {
+    std::lock_guard<std::mutex> coldLock(coldMtx);   // `cold` only changes under coldMtx
+    if (coldOptions.dir.empty()) return 0;
+
+    {
+        // Start a new period; entries touched in the one that ends stay hot
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        resizeTouchBits();
+        activeTouch ^= 1;
+        for (size_t i = 0; i < touchWords; i++) touchBits[activeTouch][i].store(0, std::memory_order_relaxed);
+    }
+
+    struct Idle {
+        size_t offset;        // of key + url in `bytes`
+        uint32_t keyLen, urlLen;
+        int64_t expiresAt;
+    };
+    std::vector<Idle> idle;
+    std::string bytes;
+    auto keyOf = [&](const Idle& e) { return std::string_view(bytes.data() + e.offset, e.keyLen); };
+    auto urlOf = [&](const Idle& e) { return std::string_view(bytes.data() + e.offset + e.keyLen, e.urlLen); };
+
+    size_t demoted = 0;
+    size_t pos = 0;
+    bool scanned = false;
+    while (!scanned) {
+        // Copy idle entries out, a slice of slots per shared lock hold, until
+        // a table's worth is collected
+        idle.clear();
+        bytes.clear();
+        int64_t now = nowMs();
+        while (!scanned && bytes.size() < coldOptions.demoteBatchBytes) {
+            std::shared_lock<ReadMostlyLock> lock(mtx);
+            store.forEachIn(pos, pos + DEMOTE_SCAN_SLOTS,
+                            [&](std::string_view key, std::string_view url, int64_t expiresAt) {
+                if (expiresAt == COLD_TOMBSTONE || (expiresAt > 0 && expiresAt <= now)) return;
+                if (touched(key)) return;
+                idle.push_back({bytes.size(), (uint32_t)key.size(), (uint32_t)url.size(), expiresAt});
+                bytes.append(key).append(url);
+            });
+            pos += DEMOTE_SCAN_SLOTS;
+            scanned = pos >= store.slotCount();
+        }
+        if (idle.empty()) continue;
+
+        // A rehash between slices can show an entry twice
+        std::sort(idle.begin(), idle.end(), [&](const Idle& a, const Idle& b) { return keyOf(a) < keyOf(b); });
+        idle.erase(std::unique(idle.begin(), idle.end(),
+                               [&](const Idle& a, const Idle& b) { return keyOf(a) == keyOf(b); }),
+                   idle.end());
+
+        std::string path = coldPath(nextColdSeq++);
+        ColdTable::Writer writer(path, coldOptions.blockBytes, coldOptions.bloomBitsPerKey);
+        for (const Idle& e : idle) writer.add(keyOf(e), urlOf(e), e.expiresAt);
+        std::shared_ptr<const ColdTable> table;
+        if (writer.finish()) table = ColdTable::open(path);
+        if (!table) {
+            std::remove(path.c_str());
+            break;
+        }
+        syncDirectory(coldOptions.dir);
+
+        // Install the table and drop its entries from memory in one hold, so
+        // a lookup finds every entry in one tier or the other. Not logged:
+        // after a restart the log may bring an entry back, shadowing its
+        // identical cold copy.
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+        auto tables = std::make_shared<ColdSet>();
+        tables->push_back(std::move(table));
+        if (cold) tables->insert(tables->end(), cold->begin(), cold->end());
+        cold = std::move(tables);
+        for (const Idle& e : idle) {
+            std::string_view url;
+            int64_t expiresAt;
+            // Skip entries written or read since they were copied
+            if (!store.view(keyOf(e), url, expiresAt) || url != urlOf(e) || expiresAt != e.expiresAt
+                || touched(keyOf(e))) {
+                continue;
+            }
+            store.erase(keyOf(e));   // stays in the filter: the code is in the table
+            demoted++;
+        }
+    }
+
+    if (demoted > 0) {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        store.shrinkToFit();
+    }
+    if (cold && cold->size() > (size_t)std::max(coldOptions.maxTables, 1)) mergeCold();
+    return demoted;
+}
+
+// Merge every table into one, keeping the newest version of each code and
+// dropping expired and removed ones, then purge the tombstones that only
+// hid codes of the old tables
+size_t UrlRepository::mergeCold() {
+    std::shared_ptr<const ColdSet> tables = cold;
+    std::vector<std::string> removed;
+    {
+        std::shared_lock<ReadMostlyLock> lock(mtx);
+        store.forEach([&](std::string_view key, int64_t expiresAt) {
+            if (expiresAt == COLD_TOMBSTONE) removed.emplace_back(key);
+        });
+    }
+    std::sort(removed.begin(), removed.end());
+
+    int64_t now = nowMs();
+    std::vector<std::string> expired;   // dropped by the merge, still in the filter
+    std::string path = coldPath(nextColdSeq++);
+    ColdTable::Writer writer(path, coldOptions.blockBytes, coldOptions.bloomBitsPerKey);
+    std::vector<ColdTable::Cursor> cursors;
+    for (const auto& table : *tables) cursors.emplace_back(*table);
+    for (;;) {
+        // Smallest code of all cursors; on a tie the newest table wins
+        size_t first = cursors.size();
+        for (size_t i = 0; i < cursors.size(); i++) {
+            if (cursors[i].valid() && (first == cursors.size() || cursors[i].key() < cursors[first].key())) {
+                first = i;
+            }
+        }
+        if (first == cursors.size()) break;
+
+        std::string_view key = cursors[first].key();   // points into the mapping
+        int64_t expiresAt = cursors[first].expiresAt();
+        bool tombstoned = std::binary_search(removed.begin(), removed.end(), key);
+        if (expiresAt > 0 && expiresAt <= now) {
+            if (!tombstoned) expired.emplace_back(key);   // the purge below covers tombstoned codes
+        } else if (!tombstoned) {
+            writer.add(key, cursors[first].url(), expiresAt);
+        }
+        for (ColdTable::Cursor& c : cursors) {
+            if (c.valid() && c.key() == key) c.next();
+        }
+    }
+
+    std::shared_ptr<const ColdTable> merged;
+    if (writer.finish()) merged = ColdTable::open(path);
+    if (!merged) {
+        std::remove(path.c_str());
+        return 0;
+    }
+    syncDirectory(coldOptions.dir);
+    {
+        std::lock_guard<ReadMostlyLock> lock(mtx);
+        cold = std::make_shared<ColdSet>(ColdSet{merged});
+    }
+
+    // Old tables go before their tombstones do, so a restart never sees a
+    // removed code again. Lookups in flight keep their mappings alive.
+    std::error_code ec;
+    for (const auto& table : *tables) fs::remove(table->filePath(), ec);
+    syncDirectory(coldOptions.dir);
+
+    std::lock_guard<ReadMostlyLock> lock(mtx);
+    METRIC_TIME_SCOPE(metrics, MetricTimer::RepositoryLock);
+    for (const std::string& key : removed) {
+        int64_t expiresAt;
+        if (!store.expiryOf(key, expiresAt) || expiresAt != COLD_TOMBSTONE) continue;
+        store.erase(key);
+        coldTombstones--;
+        if (useFilter) filter.remove(key);
+        if (wal) logErase(key, false);
+    }
+    // A hot copy of an expired code holds its own fingerprint
+    if (useFilter) {
+        for (const std::string& key : expired) filter.remove(key);
+    }
+    return merged->size();
+}
+
+size_t UrlRepository::coldEntries() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    size_t entries = 0;
+    if (cold) {
+        for (const auto& table : *cold) entries += table->size();
+    }
+    return entries;
+}
+
+size_t UrlRepository::coldBytes() const {
+    std::shared_lock<ReadMostlyLock> lock(mtx);
+    size_t bytes = 0;
+    if (cold) {
+        for (const auto& table : *cold) bytes += table->fileBytes();
+    }
+    return bytes;
 }
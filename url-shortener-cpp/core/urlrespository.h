@@ -1,37 +1,282 @@
 #ifndef URL_REPOSITORY_H
 #define URL_REPOSITORY_H
 
-#include <unordered_map>
+#include "FlatUrlStore.h"
+#include "WriteAheadLog.h"
+#include "ExpiryWheel.h"
+#include "CuckooFilter.h"
+#include "ReadMostlyLock.h"
+#include "Metrics.h"
+#include "UrlHandle.h"
+#include "ColdTable.h"
 #include <string>
 #include <chrono>
 #include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <vector>
 
-// Stores URL mappings with optional TTL expiry
-struct UrlEntry {
+// Durability settings; persistence is off while dataDir is empty
+struct PersistenceOptions {
+    std::string dataDir;                 // holds wal-<gen>.log and snapshot-<gen>.snap
+    int    groupCommitMs    = 5;         // log flush + fdatasync batching window
+    size_t groupCommitBytes = 1 << 20;   // flush early once this much is buffered
+    bool   waitForDurable   = false;     // save/remove return only once their batch is synced
+    size_t snapshotEveryOps = 1000000;   // background snapshot cadence (0 = manual only)
+};
+
+// Tiered storage settings; the cold tier is off while dir is empty
+struct ColdTierOptions {
+    std::string dir;                     // holds cold-<seq>.sst tables
+    int    demoteEveryMs    = 3600000;   // service: demotion pass cadence (0 = manual only)
+    size_t blockBytes       = 4096;      // table block size (one Bloom filter each)
+    int    bloomBitsPerKey  = 10;        // ~1% false positives per probed block
+    int    maxTables        = 4;         // merge into one table beyond this
+    size_t demoteBatchBytes = 64 << 20;  // links copied out per table written
+};
+
+// One entry of UrlRepository::saveBatch
+struct RepositoryWrite {
+    std::string_view shortCode;
+    std::string_view longUrl;
+    int  ttlSeconds = 0;
+    int64_t expiresAt = 0;       // absolute wall-clock ms; overrides ttlSeconds when set
+    bool onlyIfAbsent = false;   // fail instead of overwriting (custom aliases)
+    int64_t generatedId = 0;     // ID the code was generated from (0 = alias or moved entry)
+    bool saved = false;          // out: false if onlyIfAbsent and the code exists
+    bool persisted = false;      // out: saved and, with persistence on, logged (synced if waitForDurable)
+};
+
+// One live entry, as copied out by UrlRepository::findBatch
+struct RepositoryEntry {
+    std::string shortCode;
     std::string longUrl;
-    std::chrono::steady_clock::time_point expiresAt;
-    bool hasExpiry;
+    int64_t expiresAt = 0;       // wall-clock ms, 0 = never
 };
 
+// Stores URL mappings with optional TTL expiry.
+// Entries live in a FlatUrlStore (inline short codes, arena-backed URLs);
+// URLs are kept as UrlCodec::standard() encodings, about half their length
+// (~51% on codec_bench's corpus), which the log, snapshots and cold tables
+// carry as they are;
+// expiry is kept as wall-clock milliseconds, 0 = no expiry. Every entry
+// with a TTL is also filed in an ExpiryWheel, which reapExpired() drains.
+// A CuckooFilter of the stored codes answers most lookups of unknown codes
+// (scanners, typos) without taking the lock.
+//
+// Lookups take the lock shared and never block each other; only writes and
+// reaping take it exclusively. A lookup that meets an expired entry just
+// reports it missing and leaves the delete to the reaper, or to the next
+// write when no reaper runs.
+//
+// With persistence enabled every save/remove is also appended to a
+// write-ahead log, and compacted snapshots are written periodically.
+// Generation g consists of snapshot-g (state when wal-g was started) plus
+// wal-g, wal-g+1, ...; startup mmaps the newest snapshot and replays only
+// the logs from its generation on.
+//
+// With the cold tier enabled, demoteIdle() moves entries nobody has read
+// or written for a whole demotion period out of the table into immutable
+// on-disk ColdTables, searched newest first (and without the lock) when a
+// lookup misses in memory; a cold hit is promoted back. Deleting a code
+// that a cold table still holds leaves a hot tombstone (empty URL, expiry
+// COLD_TOMBSTONE) that hides it until the tables are merged.
 class UrlRepository {
 private:
-    std::unordered_map<std::string, UrlEntry> store;
-    mutable std::mutex mtx;
+    FlatUrlStore store;
+    ExpiryWheel wheel;
+    CuckooFilter filter;                    // stored codes; written under mtx, read lock-free
+    bool useFilter;
+    size_t expiredRemoved = 0;
+    std::atomic<bool> expiredSeen{false};   // a lookup skipped an expired entry
+    mutable ReadMostlyLock mtx;
+    Metrics* metrics = nullptr;             // lock hold times, if set
+
+    // Persistence
+    PersistenceOptions persistence;
+    std::unique_ptr<WriteAheadLog> wal;
+    uint64_t walGeneration = 0;
+    size_t opsSinceSnapshot = 0;
+    int64_t highestId = 0;                  // highest generatedId saved; logged and snapshotted
+    std::mutex snapshotMtx;                 // one snapshot at a time
+    std::thread snapshotThread;
+    std::condition_variable_any snapshotCv;
+    std::atomic<bool> snapshotRequested{false};
+    bool stopSnapshots = false;
+
+    // Cold tier
+    using ColdSet = std::vector<std::shared_ptr<const ColdTable>>;   // newest first
+    static constexpr int64_t COLD_TOMBSTONE = -1;
+    ColdTierOptions coldOptions;
+    std::shared_ptr<const ColdSet> cold;    // replaced under mtx, searched without it
+    std::mutex coldMtx;                     // one demotion or merge at a time
+    uint64_t nextColdSeq = 1;
+    size_t coldTombstones = 0;              // hot entries that only hide a cold one
+    // Codes read or written since the last demotion pass (touchBits[activeTouch])
+    // and during the pass before it, as bits indexed by a hash of the code
+    std::unique_ptr<std::atomic<uint64_t>[]> touchBits[2];
+    size_t touchWords = 0;                  // power of two
+    int activeTouch = 0;
+
+    static int64_t nowMs();
+
+    // Insert + schedule expiry; called with mtx held
+    void putEntry(std::string_view shortCode, std::string_view longUrl, int64_t expiresAt);
+    // Erase from store and filter, or leave a tombstone (*tombstoned) if a
+    // cold table holds the code; called with mtx held
+    bool eraseEntry(std::string_view shortCode, bool* tombstoned = nullptr);
+    // Log an eraseEntry; called with mtx held
+    uint64_t logErase(std::string_view shortCode, bool tombstoned);
+    void rebuildFilter();
+    // Erase entries whose TTL has passed; called with mtx held
+    size_t reapDue(std::vector<std::string>* removed);
+
+    std::string walPath(uint64_t gen) const;
+    std::string snapshotPath(uint64_t gen) const;
+    // Count a logged mutation; called with mtx held
+    void noteMutation();
+    void snapshotLoop();
+
+    // Hot lookup, then the cold tables; shared by find and findHandle
+    template <typename Out>
+    bool lookup(std::string_view shortCode, Out& longUrl, int64_t& expiresAt);
+    template <typename Out>
+    bool lookupCold(std::string_view shortCode, Out& longUrl, int64_t& expiresAt,
+                    const std::shared_ptr<const ColdSet>& tables);
+    static bool findCold(const ColdSet& tables, std::string_view shortCode,
+                         std::string_view& longUrl, int64_t& expiresAt);
+    // Present in memory (tombstones excluded) or in a cold table; mtx held
+    bool containsLocked(std::string_view shortCode) const;
+    void promote(std::string_view shortCode, std::string_view longUrl, int64_t expiresAt,
+                 const std::shared_ptr<const ColdSet>& searched);
+    void touch(std::string_view shortCode);          // mtx held (shared is enough)
+    bool touched(std::string_view shortCode) const;  // in either bitmap; mtx held
+    void resizeTouchBits();                           // mtx held exclusively
+    std::string coldPath(uint64_t seq) const;
+    size_t mergeCold();                               // coldMtx held
 
 public:
-    // Save URL with optional TTL in seconds (0 = no expiry)
-    void save(const std::string& shortCode,
+    // tickMs = resolution of the expiry wheel; lookupFilter = keep the
+    // negative-lookup filter (off only to measure what it saves)
+    explicit UrlRepository(int64_t expiryTickMs = 100, bool lookupFilter = true);
+    ~UrlRepository();
+
+    UrlRepository(const UrlRepository&) = delete;
+    UrlRepository& operator=(const UrlRepository&) = delete;
+
+    // Load the latest snapshot + log tail from options.dataDir and start
+    // logging. Call once, before the repository is shared between threads.
+    bool enablePersistence(const PersistenceOptions& options);
+
+    // Serve idle entries from on-disk tables in options.dir. Tables left by
+    // a previous run are reused when persistence is enabled (call after
+    // enablePersistence) and deleted otherwise. Call once, before sharing.
+    bool enableColdTier(const ColdTierOptions& options);
+
+    // Move every entry not read or written since the previous call to a new
+    // cold table; merges tables beyond options.maxTables. Returns the number
+    // of entries demoted.
+    size_t demoteIdle();
+
+    // Report lock hold times to `m` (call before sharing the repository)
+    void setMetrics(Metrics* m) { metrics = m; }
+
+    // Write a compacted snapshot now and drop older logs/snapshots
+    bool snapshot();
+
+    // Save URL with optional TTL in seconds (0 = no expiry). generatedId is
+    // the ID an auto-generated code encodes (0 for custom aliases). False if
+    // persistence is on and the write could not be logged (or synced, with
+    // waitForDurable): it is served until a restart but may not survive one.
+    bool save(const std::string& shortCode,
               const std::string& longUrl,
-              int ttlSeconds = 0);
+              int ttlSeconds = 0,
+              int64_t generatedId = 0);
+
+    // Save many entries under a single lock acquisition; sets each
+    // write's `saved` flag and returns how many were saved
+    size_t saveBatch(std::vector<RepositoryWrite>& writes);
 
     // Find URL by short code; returns "" if not found or expired
-    std::string find(const std::string& shortCode);
+    std::string find(std::string_view shortCode);
+
+    // Same, also reporting the entry's expiry (wall-clock ms, 0 = never)
+    std::string find(std::string_view shortCode, int64_t& expiresAt);
+
+    // Same, as a handle built straight from the stored URL (for the cache);
+    // empty if not found or expired
+    UrlHandle findHandle(std::string_view shortCode, int64_t& expiresAt);
+
+    // findHandle for many codes (redirect batches): out[i] / expiresAt[i]
+    // for codes[i], out[i] empty if not found or expired. Staged so the
+    // cache misses of different codes overlap: every code's filter buckets
+    // are prefetched, then its table slot, then its stored URL, each a
+    // pass ahead of its use. The lock is taken once.
+    void findMany(const std::vector<std::string_view>& codes, std::vector<UrlHandle>& out,
+                  std::vector<int64_t>& expiresAt);
+
+    // Append the live (present, unexpired) entries among `codes` to `out`
+    // under a single lock acquisition
+    void findBatch(const std::vector<std::string>& codes, std::vector<RepositoryEntry>& out);
 
     // Check if a short code exists (for custom alias validation)
-    bool exists(const std::string& shortCode);
+    bool exists(std::string_view shortCode);
 
     // Remove a specific entry
-    void remove(const std::string& shortCode);
+    void remove(std::string_view shortCode);
+
+    // Remove many entries under a single lock acquisition
+    void removeBatch(const std::vector<std::string>& codes);
+
+    // Remove every entry whose TTL has passed; O(expired) per call.
+    // Appends the removed codes to `removed` (e.g. to drop them from a cache).
+    size_t reapExpired(std::vector<std::string>& removed);
+
+    // Visit every stored short code: in memory under the repository lock,
+    // then those in cold tables, which may repeat a code or name one that
+    // has since been removed (look codes up before relying on them)
+    template <class Fn>
+    void forEachKey(Fn&& fn) const {
+        std::shared_ptr<const ColdSet> tables;
+        {
+            std::shared_lock<ReadMostlyLock> lock(mtx);
+            store.forEach([&](std::string_view key, int64_t expiresAt) {
+                if (expiresAt != COLD_TOMBSTONE) fn(key);
+            });
+            tables = cold;
+        }
+        if (!tables) return;
+        for (const auto& table : *tables) {
+            table->forEach([&](std::string_view key, std::string_view, int64_t) { fn(key); });
+        }
+    }
+
+    // Number of entries in memory (expired ones included until removed)
+    size_t size() const;
+
+    // Entries in cold tables (including ones shadowed by a newer version)
+    // and the tables' size on disk
+    size_t coldEntries() const;
+    size_t coldBytes() const;
+
+    // errno that failed the write-ahead log (0 = healthy or no persistence).
+    // Sticky: from then on writes are kept in memory only.
+    int persistenceError() const;
+
+    // Highest generatedId ever saved here, kept across restarts (0 if none),
+    // so ID generation can resume after it without guessing from the codes
+    int64_t highestGeneratedId() const;
+
+    // Entries waiting in the expiry wheel, and expired entries removed so far
+    size_t pendingExpiries() const;
+    size_t expiredCount() const;
+
+    // Bytes used by the underlying table, URL arena and lookup filter
+    size_t memoryBytes() const;
+    size_t filterBytes() const;
 };
 
 #endif
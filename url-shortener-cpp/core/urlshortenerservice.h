@@ -3,49 +3,183 @@
 
 #include "LRUCache.h"
 #include "Idgenerator.h"
-#include "urlrespository.h"
+#include "PartitionedRepository.h"
 #include "RateLimiter.h"
 #include "AnalyticsTracker.h"
-#include "consistenthashing.h"
+#include "DedupIndex.h"
+#include "Metrics.h"
 #include <string>
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Construction-time options for the service
+struct ServiceConfig {
+    int         cacheCapacity = 100;               // total cached redirects
+    int         cacheShards   = 0;                 // 0 = pick from core count
+    CachePolicy cachePolicy   = CachePolicy::LRU;  // LRU, read-mostly CLOCK or scan-resistant TINYLFU
+    IdMode      idMode        = IdMode::Counter;   // Snowflake for multi-instance deployments
+    int         nodeId        = 0;                 // unique per instance in Snowflake mode
+    PersistenceOptions persistence;                // empty dataDir = in-memory only
+    ColdTierOptions coldTier;                      // empty dir = every link stays in memory
+    int         reaperIntervalMs = 100;            // TTL reaper tick (0 = lazy expiry only)
+    bool        analytics     = true;              // count redirect hits per code
+    AnalyticsMode analyticsMode = AnalyticsMode::Exact;  // HeavyHitters = bounded memory, approximate
+    HashAlgorithm ringAlgorithm = HashAlgorithm::Ring;   // code → storage node mapping
+    int         virtualNodes  = ConsistentHashRing::DEFAULT_VIRTUAL_NODES;  // per node, Ring only
+    bool        dedup         = false;             // re-shortening a stored URL returns its code
+};
+
+// One item of UrlShortenerService::shortenBatch
+struct ShortenRequest {
+    std::string longUrl;
+    int ttlSeconds = 0;          // 0 = no expiry
+    std::string customAlias;     // "" = auto-generate short code
+};
+
+enum class ShortenStatus {
+    Ok,
+    AliasTaken,                  // custom alias already exists (or repeats in the batch)
+    InvalidAlias,                // custom alias is not 1..64 Base62 chars
+    InvalidUrl,                  // long URL contains control characters
+    RateLimited,                 // the batch was rejected by the rate limiter
+    StorageFailed                // could not be written to the data directory's log
+};
+
+struct ShortenResult {
+    ShortenStatus status = ShortenStatus::Ok;
+    std::string shortCode;       // empty unless status == Ok
+};
 
 // Main orchestrator — coordinates all components
 class UrlShortenerService {
 private:
+    Metrics         metrics;       // first: the components below report into it
     Idgenerator     idgenerator;   // Unique ID generation
-    LRUCache        cache;         // In-memory LRU cache
-    UrlRepository   repository;    // Persistent storage (with TTL)
+    LRUCache        cache;         // In-memory cache (LRU or CLOCK)
+    PartitionedRepository repository;   // Storage (with TTL), split across hash-ring nodes
     RateLimiter     rateLimiter;   // Token bucket per IP
     AnalyticsTracker analytics;    // Click tracking
-    ConsistentHashRing hashRing;   // Distributed sharding
+    bool            persistent = false;   // links are reloaded from a data directory
+    void resumeIds();
+
+    // Long URL fingerprint → ID of its permanent auto-generated link.
+    // Filled as links are created (not rebuilt from a data directory).
+    DedupIndex      dedup;
+    bool            dedupEnabled;
+    bool findDuplicate(const std::string& longUrl, uint64_t fingerprint, std::string& shortCode);
+
+    // Background TTL reaper: drops expired links from repository and cache,
+    // and runs the cold tier's demotion passes
+    int reaperIntervalMs;
+    int demoteEveryMs = 0;
+    std::thread reaperThread;
+    std::mutex reaperMtx;
+    std::condition_variable reaperCv;
+    bool stopReaper = false;
+
+    void reaperLoop();
+    std::vector<MetricGauge> metricGauges() const;
 
 public:
-    // cache size = 100, rate limit = 5 req burst / 2 per sec
-    UrlShortenerService();
+    // cache per config (default 100 entries, LRU), rate limit = 5 req burst / 2 per sec
+    explicit UrlShortenerService(const ServiceConfig& config = ServiceConfig());
+    ~UrlShortenerService();
+
+    UrlShortenerService(const UrlShortenerService&) = delete;
+    UrlShortenerService& operator=(const UrlShortenerService&) = delete;
 
     // Shorten a URL
     // ttlSeconds = 0 means no expiry
     // ip = "" means no rate limiting
     // customAlias = "" means auto-generate short code
+    // With config.dedup, a permanent auto-generated request for a URL that
+    // already has such a link returns that link's code. Links with a TTL
+    // or a custom alias are always new and never returned for others.
     std::string shortenUrl(const std::string& longUrl,
                            int ttlSeconds = 0,
                            const std::string& ip = "",
                            const std::string& customAlias = "");
 
+    // False if the URL holds a control character (a CR/LF would split the
+    // Location header it is redirected with); such URLs are never stored
+    static bool isRedirectSafe(std::string_view longUrl);
+
+    // Shorten many URLs at once: one ID-range reservation for all
+    // auto-generated codes and one repository lock for the whole batch.
+    // ip = "" means no rate limiting (a batch costs one token).
+    // Results are in request order.
+    std::vector<ShortenResult> shortenBatch(const std::vector<ShortenRequest>& requests,
+                                            const std::string& ip = "");
+
     // Redirect short code → long URL (with cache + analytics)
     // ip = "" means no rate limiting
-    std::string redirect(const std::string& shortCode,
-                         const std::string& ip = "");
+    std::string redirect(std::string_view shortCode,
+                         std::string_view ip = {});
+
+    // Same, returning a handle that shares the cached URL instead of a
+    // copy: a cache hit allocates nothing. Empty if not found, expired or
+    // rate limited.
+    UrlHandle resolve(std::string_view shortCode,
+                      std::string_view ip = {});
+
+    // resolve() for a batch of codes, results in request order. Each cache
+    // shard and repository partition is locked once per batch, and the
+    // repository lookups overlap their cache misses (see
+    // UrlRepository::findMany). Each code spends one rate-limit token.
+    std::vector<UrlHandle> redirectMany(const std::vector<std::string_view>& codes,
+                                        std::string_view ip = {});
+
+    // Spend one rate-limit token for ip (false = over the limit). For
+    // front-ends that must tell "rate limited" from "not found" and then
+    // call shortenBatch/redirect with ip = "".
+    bool allowRequest(std::string_view ip);
 
     // Print analytics report
     void printAnalytics(int topN = 10);
 
+    // The k most clicked links, most clicked first
+    std::vector<HitCount> topLinks(int k = 10);
+
+    // Clicks per bucket over the last `buckets` minutes/hours/days, oldest first
+    std::vector<uint32_t> clickSeries(const std::string& shortCode, SeriesResolution res, int buckets);
+
+    // Columnar binary export of many codes' series (all codes if `codes`
+    // is empty); layout documented on AnalyticsTracker::exportSeries
+    std::string exportClicks(const std::vector<std::string>& codes, SeriesResolution res, int buckets);
+
     // Print which hash-ring node a short code maps to
     void printNodeAssignment(const std::string& shortCode);
 
-    // Add a storage node to the consistent hash ring
+    // Add a storage node to the consistent hash ring. The first node takes
+    // over the local data; later ones receive their share of the links in
+    // the background while redirects keep being served.
     void addNode(int nodeId);
+
+    // Block until links moved by addNode have reached their new node
+    void waitForRebalance();
+
+    // Move links idle for a whole demotion period to the cold tier (also
+    // run every coldTier.demoteEveryMs); returns how many moved
+    size_t demoteIdle();
+
+    // Number of links in memory (expired ones included until reaped)
+    size_t urlCount() const;
+
+    // Links in the cold tier's on-disk tables
+    size_t coldCount() const;
+
+    // Redirect lookups served from the cache vs. sent to the repository
+    CacheStats cacheStats() const;
+
+    // Counters, sampled latency / lock-hold histograms and component gauges
+    // (links, cache, rate limiter), in Prometheus text format or as JSON
+    std::string metricsText() const;
+    std::string metricsJson() const;
+
+    // Bytes held by the link table (all nodes) and the dedup index
+    size_t storageBytes() const;
 };
 
 #endif
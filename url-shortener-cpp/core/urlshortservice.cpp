@@ -1,55 +1,294 @@
 #include "urlshortenerservice.h"
 #include "Base62Encoder.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <unordered_map>
 
-UrlShortenerService::UrlShortenerService()
-    : cache(100),
+UrlShortenerService::UrlShortenerService(const ServiceConfig& config)
+    : idgenerator(config.idMode, config.nodeId),
+      cache(config.cacheCapacity, config.cacheShards, config.cachePolicy),
+      repository(config.virtualNodes, config.ringAlgorithm),
       rateLimiter(5.0, 2.0),
-      hashRing(3)
-{}
+      analytics(config.analyticsMode),
+      dedupEnabled(config.dedup),
+      reaperIntervalMs(config.reaperIntervalMs)
+{
+    analytics.setEnabled(config.analytics);
+    cache.setMetrics(&metrics);
+    repository.setMetrics(&metrics);
+    rateLimiter.setMetrics(&metrics);
+
+    if (!config.persistence.dataDir.empty()) {
+        persistent = true;
+        if (!repository.enablePersistence(config.persistence)) {
+            std::cout << "  ⚠️  Could not open data directory '"
+                      << config.persistence.dataDir << "', running in-memory.\n";
+        }
+    }
+    if (!config.coldTier.dir.empty()) {
+        if (repository.enableColdTier(config.coldTier)) {
+            demoteEveryMs = config.coldTier.demoteEveryMs;
+        } else {
+            std::cout << "  ⚠️  Could not open cold tier directory '"
+                      << config.coldTier.dir << "', keeping every link in memory.\n";
+        }
+    }
+    if (persistent) resumeIds();
+
+    if (reaperIntervalMs > 0) {
+        reaperThread = std::thread(&UrlShortenerService::reaperLoop, this);
+    }
+}
+
+UrlShortenerService::~UrlShortenerService() {
+    {
+        std::lock_guard<std::mutex> lock(reaperMtx);
+        stopReaper = true;
+    }
+    reaperCv.notify_all();
+    if (reaperThread.joinable()) reaperThread.join();
+}
+
+void UrlShortenerService::reaperLoop() {
+    std::vector<std::string> removed;
+    auto lastDemotion = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(reaperMtx);
+    while (!stopReaper) {
+        reaperCv.wait_for(lock, std::chrono::milliseconds(reaperIntervalMs),
+                          [this] { return stopReaper; });
+        if (stopReaper) break;
+        lock.unlock();
+
+        removed.clear();
+        repository.reapExpired(removed);
+        for (const std::string& code : removed) cache.remove(code);
+
+        auto now = std::chrono::steady_clock::now();
+        if (demoteEveryMs > 0 && now - lastDemotion >= std::chrono::milliseconds(demoteEveryMs)) {
+            repository.demoteIdle();
+            lastDemotion = now;
+        }
+
+        lock.lock();
+    }
+}
 
 std::string UrlShortenerService::shortenUrl(const std::string& longUrl,
                                              int ttlSeconds,
                                              const std::string& ip,
                                              const std::string& customAlias) {
+    METRIC_TIME_SCOPE(&metrics, MetricTimer::Shorten);
     // Rate limiting check
     if (!ip.empty() && !rateLimiter.allowRequest(ip)) {
         std::cout << "  ⛔ Rate limit exceeded for IP: " << ip << "\n";
+        METRIC_COUNT(&metrics, MetricCounter::RateLimited);
+        METRIC_COUNT(&metrics, MetricCounter::ShortenFailures);
+        return "";
+    }
+
+    if (!isRedirectSafe(longUrl)) {
+        std::cout << "  ⚠️  URL contains control characters; not shortened.\n";
+        METRIC_COUNT(&metrics, MetricCounter::ShortenFailures);
         return "";
     }
 
     std::string shortCode;
+    uint64_t fingerprint = 0;
+    long long generatedId = 0;   // 0 = custom alias
 
     if (!customAlias.empty()) {
-        // Custom alias: check it's not already taken
+        // Custom alias: must be Base62 and free
+        if (!Base62Encoder::isValid(customAlias)) {
+            std::cout << "  ⚠️  Alias '" << customAlias << "' is not a valid short code.\n";
+            METRIC_COUNT(&metrics, MetricCounter::ShortenFailures);
+            return "";
+        }
         if (repository.exists(customAlias)) {
             std::cout << "  ⚠️  Alias '" << customAlias << "' already in use.\n";
+            METRIC_COUNT(&metrics, MetricCounter::ShortenFailures);
             return "";
         }
         shortCode = customAlias;
+        METRIC_COUNT(&metrics, MetricCounter::Shortens);
     } else {
+        METRIC_COUNT(&metrics, MetricCounter::Shortens);
+        if (dedupEnabled && ttlSeconds == 0) {
+            fingerprint = DedupIndex::fingerprint(longUrl);
+            if (findDuplicate(longUrl, fingerprint, shortCode)) return shortCode;
+        }
         // Auto-generate: ID → Base62
-        long long id = idgenerator.getNextId();
-        shortCode = Base62Encoder::encode(id);
+        generatedId = idgenerator.getNextId();
+        char buf[Base62Encoder::MAX_LEN];
+        shortCode.assign(buf, Base62Encoder::encode(generatedId, buf));
     }
 
-    // Save to repository (with optional TTL)
-    repository.save(shortCode, longUrl, ttlSeconds);
+    // Save to repository (with optional TTL); an auto-generated code's ID is
+    // recorded so ID generation can resume after it
+    if (!repository.save(shortCode, longUrl, ttlSeconds, generatedId)) {
+        std::cout << "  ⚠️  Could not write '" << shortCode << "' to the data directory.\n";
+        METRIC_COUNT(&metrics, MetricCounter::ShortenFailures);
+        return "";
+    }
+    if (fingerprint != 0) dedup.put(fingerprint, generatedId);
 
     return shortCode;
 }
 
-std::string UrlShortenerService::redirect(const std::string& shortCode,
-                                           const std::string& ip) {
+// The index only suggests a code; it counts if that code still maps to
+// exactly this URL (guards against fingerprint collisions and removals).
+// Two concurrent first requests for a URL can both miss and create a link
+// each; the index then keeps the later one.
+bool UrlShortenerService::findDuplicate(const std::string& longUrl, uint64_t fingerprint,
+                                        std::string& shortCode) {
+    int64_t id = 0;
+    if (!dedup.find(fingerprint, id)) return false;
+    char buf[Base62Encoder::MAX_LEN];
+    shortCode.assign(buf, Base62Encoder::encode(id, buf));
+    int64_t expiresAt = 0;
+    return repository.find(shortCode, expiresAt) == longUrl && expiresAt == 0;
+}
+
+std::vector<ShortenResult> UrlShortenerService::shortenBatch(
+        const std::vector<ShortenRequest>& requests, const std::string& ip) {
+    METRIC_TIME_SCOPE(&metrics, MetricTimer::Shorten);
+    std::vector<ShortenResult> results(requests.size());
+
+    if (!ip.empty() && !rateLimiter.allowRequest(ip)) {
+        for (ShortenResult& r : results) r.status = ShortenStatus::RateLimited;
+        METRIC_COUNT(&metrics, MetricCounter::RateLimited);
+        METRIC_ADD(&metrics, MetricCounter::ShortenFailures, results.size());
+        return results;
+    }
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (!isRedirectSafe(requests[i].longUrl)) results[i].status = ShortenStatus::InvalidUrl;
+    }
+
+    // 0. With dedup, permanent auto-generated requests for a known URL (or
+    // one repeated earlier in the batch) take the existing code
+    const size_t NEW = SIZE_MAX;
+    std::vector<size_t> reuse(requests.size(), NEW);   // request whose code to return
+    std::vector<uint64_t> fingerprints;                // 0 = not indexed
+    if (dedupEnabled) {
+        fingerprints.assign(requests.size(), 0);
+        std::unordered_map<uint64_t, size_t> firstInBatch;
+        for (size_t i = 0; i < requests.size(); i++) {
+            const ShortenRequest& req = requests[i];
+            if (!req.customAlias.empty() || req.ttlSeconds != 0 || results[i].status != ShortenStatus::Ok) continue;
+            uint64_t fp = DedupIndex::fingerprint(req.longUrl);
+            auto [it, first] = firstInBatch.emplace(fp, i);
+            if (!first && requests[it->second].longUrl == req.longUrl) {
+                reuse[i] = it->second;
+            } else if (findDuplicate(req.longUrl, fp, results[i].shortCode)) {
+                reuse[i] = i;
+            } else {
+                fingerprints[i] = fp;
+            }
+        }
+    }
+
+    // 1. One atomic reservation covers every auto-generated code
+    int autoCount = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (requests[i].customAlias.empty() && reuse[i] == NEW && results[i].status == ShortenStatus::Ok) autoCount++;
+    }
+    std::vector<long long> ids;
+    ids.reserve(autoCount);
+    while ((int)ids.size() < autoCount) {
+        long long first = 0;
+        int got = idgenerator.reserveRange(autoCount - (int)ids.size(), first);
+        for (int k = 0; k < got; k++) ids.push_back(first + k);
+    }
+
+    // 2. Encode codes in one pass
+    std::vector<Base62Encoder::Code> codes(ids.size());
+    Base62Encoder::encodeBatch(ids.data(), ids.size(), codes.data());
+
+    std::vector<RepositoryWrite> writes;
+    writes.reserve(requests.size());
+    std::vector<std::pair<uint64_t, long long>> toIndex;
+    size_t nextCode = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        const ShortenRequest& req = requests[i];
+        long long generatedId = 0;
+        if (results[i].status != ShortenStatus::Ok) continue;
+        if (req.customAlias.empty()) {
+            if (reuse[i] != NEW) continue;
+            generatedId = ids[nextCode];
+            results[i].shortCode.assign(codes[nextCode].view());
+            if (!fingerprints.empty() && fingerprints[i] != 0) toIndex.emplace_back(fingerprints[i], ids[nextCode]);
+            nextCode++;
+        } else if (!Base62Encoder::isValid(req.customAlias)) {
+            results[i].status = ShortenStatus::InvalidAlias;
+            continue;
+        } else {
+            results[i].shortCode = req.customAlias;
+        }
+        RepositoryWrite w;
+        w.shortCode = results[i].shortCode;
+        w.longUrl = req.longUrl;
+        w.ttlSeconds = req.ttlSeconds;
+        w.onlyIfAbsent = !req.customAlias.empty();
+        w.generatedId = generatedId;
+        writes.push_back(w);
+    }
+
+    // 3. Insert the whole batch under one repository lock
+    repository.saveBatch(writes);
+    for (const auto& [fp, id] : toIndex) dedup.put(fp, id);
+    size_t w = 0, failed = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (results[i].status != ShortenStatus::Ok) {
+            failed++;
+            continue;
+        }
+        if (reuse[i] != NEW) {
+            results[i].shortCode = results[reuse[i]].shortCode;
+            continue;
+        }
+        const RepositoryWrite& written = writes[w++];
+        if (!written.saved || !written.persisted) {
+            results[i].status = written.saved ? ShortenStatus::StorageFailed : ShortenStatus::AliasTaken;
+            results[i].shortCode.clear();
+            failed++;
+        }
+    }
+    METRIC_ADD(&metrics, MetricCounter::Shortens, requests.size() - failed);
+    METRIC_ADD(&metrics, MetricCounter::ShortenFailures, failed);
+    return results;
+}
+
+bool UrlShortenerService::isRedirectSafe(std::string_view longUrl) {
+    for (char c : longUrl) {
+        if ((unsigned char)c < 0x20 || c == 0x7F) return false;
+    }
+    return true;
+}
+
+std::string UrlShortenerService::redirect(std::string_view shortCode, std::string_view ip) {
+    return resolve(shortCode, ip).str();
+}
+
+UrlHandle UrlShortenerService::resolve(std::string_view shortCode, std::string_view ip) {
+    METRIC_TIME_SCOPE(&metrics, MetricTimer::Redirect);
+    METRIC_COUNT(&metrics, MetricCounter::Redirects);
     // Rate limiting check
     if (!ip.empty() && !rateLimiter.allowRequest(ip)) {
         std::cout << "  ⛔ Rate limit exceeded for IP: " << ip << "\n";
-        return "";
+        METRIC_COUNT(&metrics, MetricCounter::RateLimited);
+        return UrlHandle();
     }
 
-    std::string longUrl;
+    // Malformed codes can never exist; skip the cache and repository
+    if (!Base62Encoder::isLookupValid(shortCode)) {
+        METRIC_COUNT(&metrics, MetricCounter::RedirectsNotFound);
+        return UrlHandle();
+    }
 
-    // 1. Check LRU cache first
+    UrlHandle longUrl;
+
+    // 1. Check cache first
     if (cache.get(shortCode, longUrl)) {
         // Cache hit
         analytics.recordHit(shortCode);
@@ -57,14 +296,16 @@ std::string UrlShortenerService::redirect(const std::string& shortCode,
     }
 
     // 2. Cache miss — fetch from repository
-    longUrl = repository.find(shortCode);
+    int64_t expiresAt = 0;
+    longUrl = repository.findHandle(shortCode, expiresAt);
 
     if (longUrl.empty()) {
-        return ""; // Not found or expired
+        METRIC_COUNT(&metrics, MetricCounter::RedirectsNotFound);
+        return UrlHandle(); // Not found or expired
     }
 
-    // 3. Warm the cache
-    cache.put(shortCode, longUrl);
+    // 3. Warm the cache (the entry stops being served at the link's expiry)
+    cache.put(shortCode, longUrl, expiresAt);
 
     // 4. Record analytics
     analytics.recordHit(shortCode);
@@ -72,15 +313,180 @@ std::string UrlShortenerService::redirect(const std::string& shortCode,
     return longUrl;
 }
 
+std::vector<UrlHandle> UrlShortenerService::redirectMany(const std::vector<std::string_view>& codes,
+                                                         std::string_view ip) {
+    METRIC_TIME_SCOPE(&metrics, MetricTimer::Redirect);
+    METRIC_ADD(&metrics, MetricCounter::Redirects, codes.size());
+    std::vector<UrlHandle> results(codes.size());
+
+    // Codes that pass the rate limiter and can exist, in request order
+    thread_local std::vector<std::string_view> wanted;
+    thread_local std::vector<uint32_t> wantedAt;
+    wanted.clear();
+    wantedAt.clear();
+    size_t limited = 0;
+    for (size_t i = 0; i < codes.size(); i++) {
+        if (!ip.empty() && !rateLimiter.allowRequest(ip)) {
+            limited++;
+            continue;
+        }
+        if (!Base62Encoder::isLookupValid(codes[i])) {
+            METRIC_COUNT(&metrics, MetricCounter::RedirectsNotFound);
+            continue;
+        }
+        wanted.push_back(codes[i]);
+        wantedAt.push_back((uint32_t)i);
+    }
+    if (limited > 0) {
+        // One line per batch, however many of its codes were refused
+        std::cout << "  ⛔ Rate limit exceeded for IP: " << ip << " (" << limited << " of "
+                  << codes.size() << " codes)\n";
+        METRIC_ADD(&metrics, MetricCounter::RateLimited, limited);
+    }
+
+    // 1. One pass over the cache, each shard locked once
+    thread_local std::vector<UrlHandle> cached;
+    cache.getMany(wanted, cached);
+
+    // 2. The misses in one batched repository lookup
+    thread_local std::vector<std::string_view> missed;
+    thread_local std::vector<uint32_t> missedAt;
+    thread_local std::vector<UrlHandle> found;
+    thread_local std::vector<int64_t> expiresAt;
+    missed.clear();
+    missedAt.clear();
+    for (size_t k = 0; k < wanted.size(); k++) {
+        if (!cached[k].empty()) {
+            results[wantedAt[k]] = std::move(cached[k]);
+        } else {
+            missed.push_back(wanted[k]);
+            missedAt.push_back(wantedAt[k]);
+        }
+    }
+    if (!missed.empty()) {
+        repository.findMany(missed, found, expiresAt);
+
+        // 3. Warm the cache with what the repository had, then hand the
+        // handles over to the results
+        cache.putMany(missed, found, expiresAt);
+        size_t notFound = 0;
+        for (size_t k = 0; k < missed.size(); k++) {
+            if (found[k].empty()) notFound++;
+            else results[missedAt[k]] = std::move(found[k]);
+        }
+        METRIC_ADD(&metrics, MetricCounter::RedirectsNotFound, notFound);
+    }
+
+    // 4. Record analytics
+    for (size_t k = 0; k < wanted.size(); k++) {
+        if (!results[wantedAt[k]].empty()) analytics.recordHit(wanted[k]);
+    }
+    cached.clear();   // the scratch vectors must not keep URLs alive
+    found.clear();
+    return results;
+}
+
+bool UrlShortenerService::allowRequest(std::string_view ip) {
+    if (rateLimiter.allowRequest(ip)) return true;
+    METRIC_COUNT(&metrics, MetricCounter::RateLimited);
+    return false;
+}
+
 void UrlShortenerService::printAnalytics(int topN) {
     analytics.printReport(topN);
 }
 
+std::vector<HitCount> UrlShortenerService::topLinks(int k) {
+    return analytics.topK(k);
+}
+
+std::vector<uint32_t> UrlShortenerService::clickSeries(const std::string& shortCode,
+                                                       SeriesResolution res, int buckets) {
+    return analytics.clickSeries(shortCode, res, buckets);
+}
+
+std::string UrlShortenerService::exportClicks(const std::vector<std::string>& codes,
+                                              SeriesResolution res, int buckets) {
+    return analytics.exportSeries(codes, res, buckets);
+}
+
 void UrlShortenerService::printNodeAssignment(const std::string& shortCode) {
-    int node = hashRing.getNode(shortCode);
+    int node = repository.nodeFor(shortCode);
     std::cout << "  🔗 '" << shortCode << "' → Node " << node << "\n";
 }
 
 void UrlShortenerService::addNode(int nodeId) {
-    hashRing.addNode(nodeId);
-}
\ No newline at end of file
+    if (!repository.addNode(nodeId) || !persistent) return;
+    resumeIds();   // the node may have reloaded links from its own data directory
+}
+
+// Resume ID generation after the highest ID the repository has recorded
+// for a generated code. Data saved before IDs were recorded has none; in
+// Counter mode its codes are then read as IDs, skipping full-width ones (a
+// counter never gets that far, so they can only be aliases). Snowflake IDs
+// move on with the clock and need no scan.
+void UrlShortenerService::resumeIds() {
+    long long highest = repository.highestGeneratedId();
+    if (highest == 0 && idgenerator.getMode() == IdMode::Counter) {
+        repository.forEachKey([&highest](std::string_view code) {
+            long long id = 0;
+            if (code.size() < Base62Encoder::MAX_LEN && Base62Encoder::decode(code, id)) {
+                highest = std::max(highest, id);
+            }
+        });
+    }
+    if (highest > 0 && !idgenerator.advancePast(highest)) {
+        std::cout << "  ⚠️  IDs are exhausted (highest stored: " << highest << ").\n";
+    }
+}
+
+void UrlShortenerService::waitForRebalance() {
+    repository.waitForMigration();
+}
+
+size_t UrlShortenerService::demoteIdle() {
+    return repository.demoteIdle();
+}
+
+size_t UrlShortenerService::urlCount() const {
+    return repository.size();
+}
+
+size_t UrlShortenerService::coldCount() const {
+    return repository.coldEntries();
+}
+
+CacheStats UrlShortenerService::cacheStats() const {
+    return cache.stats();
+}
+
+size_t UrlShortenerService::storageBytes() const {
+    return repository.memoryBytes() + dedup.memoryBytes();
+}
+std::vector<MetricGauge> UrlShortenerService::metricGauges() const {
+    CacheStats cs = cache.stats();
+    return {
+        {"links_stored", "Links in memory (expired ones until reaped)", (double)repository.size(), false},
+        {"links_cold", "Links in cold tier tables (older versions included)", (double)repository.coldEntries(), false},
+        {"cold_tier_bytes", "Size of the cold tier tables on disk", (double)repository.coldBytes(), false},
+        {"links_expired_total", "Expired links removed from storage", (double)repository.expiredCount(), true},
+        {"storage_bytes", "Bytes held by the link table and dedup index", (double)storageBytes(), false},
+        {"cache_entries", "Redirects held in the cache", (double)cache.size(), false},
+        {"cache_hits_total", "Redirect lookups served from the cache", (double)cs.hits, true},
+        {"cache_misses_total", "Redirect lookups sent to the repository", (double)cs.misses, true},
+        {"cache_evictions_total", "Cache entries evicted to make room", (double)cs.evictions, true},
+        {"cache_rejections_total", "Cache misses not admitted (TINYLFU)", (double)cs.rejections, true},
+        {"rate_limiter_buckets", "Per-IP token buckets held", (double)rateLimiter.bucketCount(), false},
+        {"rate_limiter_evictions_total", "Idle token buckets evicted", (double)rateLimiter.evictedCount(), true},
+        {"dedup_entries", "Long URLs in the dedup index", (double)dedup.size(), false},
+        {"persistence_error", "errno that stopped the write-ahead log (0 = healthy)", (double)repository.persistenceError(), false},
+    };
+}
+
+std::string UrlShortenerService::metricsText() const {
+    return metrics.prometheusText(metricGauges());
+}
+
+std::string UrlShortenerService::metricsJson() const {
+    return metrics.json(metricGauges());
+}
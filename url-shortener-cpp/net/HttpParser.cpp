@@ -0,0 +1,111 @@
+#include "HttpParser.h"
+#include <cstring>
+
+namespace {
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+        if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// Does a comma-separated header value contain `token`?
+bool hasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view item = value.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (equalsIgnoreCase(item, token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+} // namespace
+
+std::string_view HttpRequest::path() const {
+    return target.substr(0, target.find('?'));
+}
+
+ParseStatus parseHttpRequest(const char* data, size_t len, HttpRequest& req) {
+    // Tolerate stray CRLFs between pipelined requests (RFC 9112 §2.2)
+    size_t skip = 0;
+    while (skip + 1 < len && data[skip] == '\r' && data[skip + 1] == '\n') skip += 2;
+
+    std::string_view buf(data + skip, len - skip);
+    size_t headerEnd = buf.find("\r\n\r\n");
+    if (headerEnd == std::string_view::npos) {
+        return buf.size() >= HTTP_MAX_HEADER_BYTES ? ParseStatus::TooLarge : ParseStatus::Incomplete;
+    }
+    if (headerEnd + 4 > HTTP_MAX_HEADER_BYTES) return ParseStatus::TooLarge;
+
+    // Request line: METHOD SP target SP version
+    size_t lineEnd = buf.find("\r\n");
+    std::string_view line = buf.substr(0, lineEnd);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp1 == 0 || sp2 == std::string_view::npos || sp2 == sp1 + 1) return ParseStatus::Invalid;
+    req.method  = line.substr(0, sp1);
+    req.target  = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    req.version = line.substr(sp2 + 1);
+    if (req.target.front() != '/' || req.version.substr(0, 7) != "HTTP/1.") return ParseStatus::Invalid;
+
+    req.host = std::string_view();
+    req.contentType = std::string_view();
+    req.body = std::string_view();
+    req.keepAlive = req.version == "HTTP/1.1";
+
+    // Headers
+    size_t contentLength = 0;
+    bool sawLength = false;
+    size_t pos = lineEnd + 2;
+    while (pos < headerEnd + 2) {
+        size_t end = buf.find("\r\n", pos);
+        std::string_view header = buf.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = header.find(':');
+        if (colon == std::string_view::npos || colon == 0) return ParseStatus::Invalid;
+        std::string_view name = header.substr(0, colon);
+        std::string_view value = trim(header.substr(colon + 1));
+
+        if (equalsIgnoreCase(name, "content-length")) {
+            if (value.empty() || sawLength) return ParseStatus::Invalid;
+            contentLength = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') return ParseStatus::Invalid;
+                contentLength = contentLength * 10 + (c - '0');
+                if (contentLength > HTTP_MAX_BODY_BYTES) return ParseStatus::TooLarge;
+            }
+            sawLength = true;
+        } else if (equalsIgnoreCase(name, "connection")) {
+            if (hasToken(value, "close")) req.keepAlive = false;
+            else if (hasToken(value, "keep-alive")) req.keepAlive = true;
+        } else if (equalsIgnoreCase(name, "host")) {
+            req.host = value;
+        } else if (equalsIgnoreCase(name, "content-type")) {
+            req.contentType = value;
+        } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+            return ParseStatus::Invalid;
+        }
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    if (buf.size() - bodyStart < contentLength) return ParseStatus::Incomplete;
+    req.body = buf.substr(bodyStart, contentLength);
+    req.length = skip + bodyStart + contentLength;
+    return ParseStatus::Complete;
+}
@@ -0,0 +1,40 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Zero-copy HTTP/1.1 request parsing.
+//
+// Every field is a view into the caller's receive buffer, so a request is
+// only valid until that buffer is compacted or grown. Chunked request
+// bodies are not supported (no route needs them); they parse as Invalid.
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;        // path + optional "?query"
+    std::string_view version;       // "HTTP/1.1" or "HTTP/1.0"
+    std::string_view host;
+    std::string_view contentType;
+    std::string_view body;
+    bool   keepAlive = true;
+    size_t length = 0;              // bytes consumed: headers + body
+
+    // target without the query string
+    std::string_view path() const;
+};
+
+enum class ParseStatus {
+    Complete,                       // req filled, `length` bytes consumed
+    Incomplete,                     // need more bytes
+    Invalid,                        // malformed; answer 400 and close
+    TooLarge                        // headers or body over the limits; 413/431 and close
+};
+
+constexpr size_t HTTP_MAX_HEADER_BYTES = 8 * 1024;
+constexpr size_t HTTP_MAX_BODY_BYTES   = 64 * 1024;
+
+// Parse one request from the front of [data, data + len)
+ParseStatus parseHttpRequest(const char* data, size_t len, HttpRequest& req);
+
+#endif
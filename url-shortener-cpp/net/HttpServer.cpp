@@ -0,0 +1,786 @@
+#include "HttpServer.h"
+#include "../core/Base62Encoder.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t READ_CHUNK = 16 * 1024;
+constexpr size_t MAX_PENDING_OUTPUT = 256 * 1024;   // stop parsing while this much is unsent
+constexpr size_t MAX_BATCH = 32;                     // pipelined requests answered together
+constexpr size_t MAX_LONG_URL = 2048;
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 503: return "Service Unavailable";
+        default:  return "Internal Server Error";
+    }
+}
+
+// Status line, headers and body straight into the connection's output
+// buffer. `headerName`/`headerValue` add one extra header (Location, Allow).
+void appendResponse(std::string& out, int status, bool keepAlive,
+                    std::string_view contentType, std::string_view body,
+                    std::string_view headerName = {}, std::string_view headerValue = {},
+                    bool headOnly = false) {
+    out += "HTTP/1.1 ";
+    out += std::to_string(status);
+    out += ' ';
+    out += reasonPhrase(status);
+    out += "\r\n";
+    if (!headerName.empty()) {
+        out += headerName;
+        out += ": ";
+        out += headerValue;
+        out += "\r\n";
+    }
+    if (!contentType.empty()) {
+        out += "Content-Type: ";
+        out += contentType;
+        out += "\r\n";
+    }
+    out += "Content-Length: ";
+    out += std::to_string(body.size());
+    out += keepAlive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    if (!headOnly) out += body;
+}
+
+void appendJsonString(std::string& out, std::string_view s) {
+    static const char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            out += "\\u00";
+            out += HEX[(c >> 4) & 0xF];
+            out += HEX[c & 0xF];
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+std::string jsonError(std::string_view message) {
+    std::string body = "{\"error\":";
+    appendJsonString(body, message);
+    body += '}';
+    return body;
+}
+
+// GET/HEAD /{code}: answered by handleRedirect, every other route by handle
+bool isRedirect(const HttpRequest& req) {
+    if (req.method != "GET" && req.method != "HEAD") return false;
+    std::string_view path = req.path();
+    return path != "/shorten" && path != "/api/shorten" && path != "/api/clicks"
+        && path != "/metrics" && path != "/api/metrics";
+}
+
+// Value of `name` in the target's query string ("" if absent). No percent
+// decoding: the parameters GET /api/clicks takes are plain ASCII.
+std::string_view queryParam(std::string_view target, std::string_view name) {
+    size_t q = target.find('?');
+    if (q == std::string_view::npos) return {};
+    std::string_view query = target.substr(q + 1);
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return {};
+}
+
+// ── Minimal reader for the flat JSON object POST /shorten accepts ──
+
+void skipSpace(std::string_view s, size_t& i) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool readJsonString(std::string_view s, size_t& i, std::string& out) {
+    if (i >= s.size() || s[i] != '"') return false;
+    i++;
+    out.clear();
+    while (i < s.size()) {
+        char c = s[i++];
+        if (c == '"') return true;
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (i >= s.size()) return false;
+        char e = s[i++];
+        switch (e) {
+            case '"': case '\\': case '/': out += e; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if (i + 4 > s.size()) return false;
+                int cp = 0;
+                for (int k = 0; k < 4; k++) {
+                    int d = hexDigit(s[i++]);
+                    if (d < 0) return false;
+                    cp = cp * 16 + d;
+                }
+                if (cp >= 0xD800 && cp <= 0xDFFF) return false;   // no surrogate pairs
+                if (cp < 0x80) {
+                    out += (char)cp;
+                } else if (cp < 0x800) {
+                    out += (char)(0xC0 | (cp >> 6));
+                    out += (char)(0x80 | (cp & 0x3F));
+                } else {
+                    out += (char)(0xE0 | (cp >> 12));
+                    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                    out += (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: return false;
+        }
+    }
+    return false;
+}
+
+bool parseTtl(std::string_view digits, int& ttl) {
+    if (digits.empty() || digits.size() > 9) return false;
+    ttl = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+        ttl = ttl * 10 + (c - '0');
+    }
+    return true;
+}
+
+// {"longUrl": "...", "customAlias": "...", "ttlSeconds": n}. Unknown keys
+// with scalar values are skipped; nested objects and arrays are rejected.
+bool parseShortenJson(std::string_view s, ShortenRequest& req) {
+    size_t i = 0;
+    skipSpace(s, i);
+    if (i >= s.size() || s[i++] != '{') return false;
+    skipSpace(s, i);
+    if (i < s.size() && s[i] == '}') return true;
+
+    std::string key, value;
+    for (;;) {
+        skipSpace(s, i);
+        if (!readJsonString(s, i, key)) return false;
+        skipSpace(s, i);
+        if (i >= s.size() || s[i++] != ':') return false;
+        skipSpace(s, i);
+        if (i >= s.size()) return false;
+
+        if (s[i] == '"') {
+            if (!readJsonString(s, i, value)) return false;
+            if (key == "longUrl" || key == "url") req.longUrl = value;
+            else if (key == "customAlias") req.customAlias = value;
+            else if (key == "ttlSeconds" && !value.empty() && !parseTtl(value, req.ttlSeconds)) return false;
+        } else {
+            size_t start = i;
+            while (i < s.size() && s[i] != ',' && s[i] != '}' && s[i] != ' ' && s[i] != '\t'
+                   && s[i] != '\r' && s[i] != '\n') i++;
+            std::string_view literal = s.substr(start, i - start);
+            if (key == "ttlSeconds" && literal != "null") {
+                if (!parseTtl(literal, req.ttlSeconds)) return false;
+            } else if (literal != "null" && literal != "true" && literal != "false"
+                       && literal.find_first_not_of("-+.eE0123456789") != std::string_view::npos) {
+                return false;
+            }
+        }
+
+        skipSpace(s, i);
+        if (i >= s.size()) return false;
+        if (s[i] == ',') { i++; continue; }
+        if (s[i] != '}') return false;
+        i++;
+        skipSpace(s, i);
+        return i == s.size();
+    }
+}
+
+// Absolute http(s) URL of printable ASCII: it goes verbatim into Location
+bool validLongUrl(std::string_view url) {
+    if (url.size() > MAX_LONG_URL) return false;
+    size_t scheme = url.substr(0, 8) == "https://" ? 8 : url.substr(0, 7) == "http://" ? 7 : 0;
+    if (scheme == 0 || url.size() == scheme) return false;
+    for (char c : url) {
+        if (c <= 0x20 || c >= 0x7F) return false;
+    }
+    return true;
+}
+
+bool isJson(std::string_view contentType) {
+    return contentType.find("json") != std::string_view::npos;
+}
+
+} // namespace
+
+// ── Connection and worker state ──
+
+struct HttpServer::Connection {
+    int fd = -1;
+    std::string ip;
+    std::string in;             // received, not yet parsed
+    std::string out;            // responses not yet written
+    size_t outSent = 0;
+    uint32_t events = 0;        // current epoll interest
+    bool closing = false;       // close once `out` drains; ignore further input
+};
+
+struct HttpServer::Worker {
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::unordered_map<int, std::unique_ptr<Connection>> conns;
+};
+
+HttpServer::HttpServer(UrlShortenerService& service, const HttpServerConfig& config)
+    : service(service), config(config) {}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+// ── Request handling (platform independent) ──
+
+void HttpServer::process(Connection& conn) {
+    thread_local std::vector<HttpRequest> batch;
+    size_t pos = 0;
+    while (!conn.closing && conn.out.size() - conn.outSent < MAX_PENDING_OUTPUT) {
+        // Up to MAX_BATCH complete requests, ending at one that closes
+        batch.clear();
+        ParseStatus status = ParseStatus::Complete;
+        while (batch.size() < MAX_BATCH && (batch.empty() || batch.back().keepAlive)) {
+            HttpRequest req;
+            status = parseHttpRequest(conn.in.data() + pos, conn.in.size() - pos, req);
+            if (status != ParseStatus::Complete) break;
+            pos += req.length;
+            batch.push_back(req);
+        }
+        answer(batch, conn);
+        if (!batch.empty() && !batch.back().keepAlive) conn.closing = true;
+
+        if (status == ParseStatus::Incomplete) break;
+        if (status != ParseStatus::Complete && !conn.closing) {
+            int code = status == ParseStatus::TooLarge ? 413 : 400;
+            appendResponse(conn.out, code, false, "application/json",
+                           jsonError(code == 413 ? "Request too large" : "Malformed request"));
+            conn.closing = true;
+        }
+    }
+    if (conn.closing) conn.in.clear();
+    else if (pos > 0) conn.in.erase(0, pos);
+}
+
+// Responses to a batch of pipelined requests, in order. The redirects
+// among them are resolved together first, with one redirectMany call.
+void HttpServer::answer(const std::vector<HttpRequest>& batch, Connection& conn) {
+    thread_local std::vector<std::string_view> codes;
+    thread_local std::vector<uint8_t> rateLimited;
+    codes.clear();
+    rateLimited.assign(batch.size(), 0);
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (!isRedirect(batch[i])) continue;
+        std::string_view code = batch[i].path().substr(1);
+        if (!Base62Encoder::isLookupValid(code)) continue;
+        if (config.rateLimit && !service.allowRequest(conn.ip)) rateLimited[i] = 1;
+        else codes.push_back(code);
+    }
+
+    // Looked up straight from the request buffer; the handles keep the
+    // URLs alive while they are copied into the responses
+    std::vector<UrlHandle> resolved;
+    if (!codes.empty()) resolved = service.redirectMany(codes);
+
+    size_t next = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        const HttpRequest& req = batch[i];
+        if (!isRedirect(req)) {
+            handle(req, conn);
+        } else if (rateLimited[i] || !Base62Encoder::isLookupValid(req.path().substr(1))) {
+            handleRedirect(req, conn, rateLimited[i] != 0, UrlHandle());
+        } else {
+            handleRedirect(req, conn, false, resolved[next++]);
+        }
+    }
+}
+
+void HttpServer::handle(const HttpRequest& req, Connection& conn) {
+    std::string_view path = req.path();
+    if (path == "/shorten" || path == "/api/shorten") {
+        if (req.method == "POST") handleShorten(req, conn);
+        else appendResponse(conn.out, 405, req.keepAlive, "application/json",
+                            jsonError("Use POST"), "Allow", "POST");
+    } else if (path == "/api/clicks") {
+        if (req.method == "GET" || req.method == "HEAD") handleClicks(req, conn, req.method == "HEAD");
+        else appendResponse(conn.out, 405, req.keepAlive, "application/json",
+                            jsonError("Use GET"), "Allow", "GET, HEAD");
+    } else if (path == "/metrics" || path == "/api/metrics") {
+        if (req.method == "GET" || req.method == "HEAD") handleMetrics(req, conn, req.method == "HEAD");
+        else appendResponse(conn.out, 405, req.keepAlive, "application/json",
+                            jsonError("Use GET"), "Allow", "GET, HEAD");
+    } else {
+        appendResponse(conn.out, 405, req.keepAlive, "application/json",
+                       jsonError("Method not allowed"), "Allow", "GET, HEAD");
+    }
+}
+
+void HttpServer::handleRedirect(const HttpRequest& req, Connection& conn, bool rateLimited,
+                                const UrlHandle& longUrl) {
+    bool headOnly = req.method == "HEAD";
+    if (rateLimited) {
+        appendResponse(conn.out, 429, req.keepAlive, "text/plain", "Rate limit exceeded\n",
+                       {}, {}, headOnly);
+        return;
+    }
+    if (longUrl.empty()) {
+        appendResponse(conn.out, 404, req.keepAlive, "text/plain", "Link not found or expired\n",
+                       {}, {}, headOnly);
+        return;
+    }
+    // Links stored before URLs were checked (or restored from old data)
+    // must not write raw control characters into the header
+    if (!UrlShortenerService::isRedirectSafe(longUrl.view())) {
+        appendResponse(conn.out, 500, req.keepAlive, "text/plain", "Stored link is not a valid URL\n",
+                       {}, {}, headOnly);
+        return;
+    }
+    appendResponse(conn.out, config.permanentRedirects ? 301 : 302, req.keepAlive,
+                   {}, {}, "Location", longUrl.view(), headOnly);
+}
+
+void HttpServer::handleShorten(const HttpRequest& req, Connection& conn) {
+    ShortenRequest item;
+    if (isJson(req.contentType)) {
+        if (!parseShortenJson(req.body, item)) {
+            appendResponse(conn.out, 400, req.keepAlive, "application/json", jsonError("Malformed JSON body"));
+            return;
+        }
+    } else {
+        // Bare URL body (curl --data-binary https://...)
+        std::string_view body = req.body;
+        while (!body.empty() && (body.back() == '\n' || body.back() == '\r' || body.back() == ' ')) body.remove_suffix(1);
+        item.longUrl.assign(body);
+    }
+
+    if (!validLongUrl(item.longUrl)) {
+        appendResponse(conn.out, 400, req.keepAlive, "application/json",
+                       jsonError("longUrl must be an absolute http(s) URL"));
+        return;
+    }
+    if (config.rateLimit && !service.allowRequest(conn.ip)) {
+        appendResponse(conn.out, 429, req.keepAlive, "application/json",
+                       jsonError("Rate limit exceeded. Try again shortly."));
+        return;
+    }
+
+    std::vector<ShortenResult> results = service.shortenBatch({item});
+    const ShortenResult& result = results.front();
+    switch (result.status) {
+        case ShortenStatus::Ok:
+            break;
+        case ShortenStatus::AliasTaken:
+            appendResponse(conn.out, 409, req.keepAlive, "application/json",
+                           jsonError("Alias \"" + item.customAlias + "\" is already taken"));
+            return;
+        case ShortenStatus::InvalidAlias:
+            appendResponse(conn.out, 400, req.keepAlive, "application/json",
+                           jsonError("Alias must be 1-64 letters or digits"));
+            return;
+        case ShortenStatus::InvalidUrl:
+            appendResponse(conn.out, 400, req.keepAlive, "application/json",
+                           jsonError("URL must not contain control characters"));
+            return;
+        case ShortenStatus::RateLimited:
+            appendResponse(conn.out, 429, req.keepAlive, "application/json",
+                           jsonError("Rate limit exceeded. Try again shortly."));
+            return;
+        case ShortenStatus::StorageFailed:
+            appendResponse(conn.out, 503, req.keepAlive, "application/json",
+                           jsonError("Link could not be stored"));
+            return;
+    }
+
+    std::string shortUrl;
+    if (!req.host.empty()) {
+        shortUrl = "http://";
+        shortUrl += req.host;
+    }
+    shortUrl += '/';
+    shortUrl += result.shortCode;
+
+    std::string body = "{\"shortCode\":";
+    appendJsonString(body, result.shortCode);
+    body += ",\"shortUrl\":";
+    appendJsonString(body, shortUrl);
+    body += ",\"longUrl\":";
+    appendJsonString(body, item.longUrl);
+    body += ",\"ttlSeconds\":";
+    body += std::to_string(item.ttlSeconds);
+    body += ",\"expiresAt\":";
+    if (item.ttlSeconds > 0) {
+        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        body += std::to_string(now + item.ttlSeconds * 1000LL);
+    } else {
+        body += "null";
+    }
+    body += '}';
+    appendResponse(conn.out, 201, req.keepAlive, "application/json", body,
+                   "Location", "/" + result.shortCode);
+}
+
+// GET /api/clicks?res=minute|hour|day&n=60&codes=a,b,c
+// Click series in AnalyticsTracker's columnar export format; no `codes`
+// exports every tracked code.
+void HttpServer::handleClicks(const HttpRequest& req, Connection& conn, bool headOnly) {
+    std::string_view resName = queryParam(req.target, "res");
+    SeriesResolution res = SeriesResolution::Minute;
+    if (resName == "hour") res = SeriesResolution::Hour;
+    else if (resName == "day") res = SeriesResolution::Day;
+    else if (!resName.empty() && resName != "minute") {
+        appendResponse(conn.out, 400, req.keepAlive, "application/json",
+                       jsonError("res must be minute, hour or day"), {}, {}, headOnly);
+        return;
+    }
+
+    int buckets = ClickSeries::ringSize(res);
+    std::string_view n = queryParam(req.target, "n");
+    if (!n.empty()) {
+        int value = 0;
+        for (char c : n) {
+            if (c < '0' || c > '9' || value > buckets) {
+                value = -1;
+                break;
+            }
+            value = value * 10 + (c - '0');
+        }
+        if (value < 1 || value > buckets) {
+            appendResponse(conn.out, 400, req.keepAlive, "application/json",
+                           jsonError("n must be 1-" + std::to_string(buckets)), {}, {}, headOnly);
+            return;
+        }
+        buckets = value;
+    }
+
+    std::vector<std::string> codes;
+    std::string_view list = queryParam(req.target, "codes");
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view code = list.substr(0, comma);
+        if (!Base62Encoder::isLookupValid(code)) {
+            appendResponse(conn.out, 400, req.keepAlive, "application/json",
+                           jsonError("codes must be comma-separated short codes"), {}, {}, headOnly);
+            return;
+        }
+        codes.emplace_back(code);
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+
+    if (config.rateLimit && !service.allowRequest(conn.ip)) {
+        appendResponse(conn.out, 429, req.keepAlive, "application/json",
+                       jsonError("Rate limit exceeded. Try again shortly."), {}, {}, headOnly);
+        return;
+    }
+    appendResponse(conn.out, 200, req.keepAlive, "application/octet-stream",
+                   service.exportClicks(codes, res, buckets), {}, {}, headOnly);
+}
+
+// GET /metrics (Prometheus text format) or /api/metrics (JSON). Not rate
+// limited, so a scraper behind the same address as clients keeps working.
+void HttpServer::handleMetrics(const HttpRequest& req, Connection& conn, bool headOnly) {
+    if (req.path() == "/metrics") {
+        appendResponse(conn.out, 200, req.keepAlive, "text/plain; version=0.0.4",
+                       service.metricsText(), {}, {}, headOnly);
+    } else {
+        appendResponse(conn.out, 200, req.keepAlive, "application/json",
+                       service.metricsJson(), {}, {}, headOnly);
+    }
+}
+
+#ifdef __linux__
+
+// ── epoll event loop ──
+
+bool HttpServer::start() {
+    if (running) return true;
+
+    int count = config.threads > 0 ? config.threads : (int)std::thread::hardware_concurrency();
+    if (count <= 0) count = 1;
+
+    sockaddr_storage addr{};
+    socklen_t addrLen = 0;
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&addr);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&addr);
+    if (inet_pton(AF_INET, config.bindAddress.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        addrLen = sizeof(sockaddr_in);
+    } else if (inet_pton(AF_INET6, config.bindAddress.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        addrLen = sizeof(sockaddr_in6);
+    } else {
+        std::cout << "  ⚠️  Invalid bind address '" << config.bindAddress << "'.\n";
+        return false;
+    }
+
+    // One SO_REUSEPORT listener per worker; with port 0 the first bind
+    // picks the port and the rest join it
+    boundPort = config.port;
+    for (int i = 0; i < count; i++) {
+        auto worker = std::make_unique<Worker>();
+        if (addr.ss_family == AF_INET) v4->sin_port = htons((uint16_t)boundPort);
+        else v6->sin6_port = htons((uint16_t)boundPort);
+
+        worker->listenFd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        bool ok = worker->listenFd >= 0
+               && setsockopt(worker->listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0
+               && setsockopt(worker->listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0
+               && bind(worker->listenFd, reinterpret_cast<sockaddr*>(&addr), addrLen) == 0
+               && listen(worker->listenFd, SOMAXCONN) == 0;
+        if (ok && boundPort == 0) {
+            sockaddr_storage bound{};
+            socklen_t len = sizeof(bound);
+            ok = getsockname(worker->listenFd, reinterpret_cast<sockaddr*>(&bound), &len) == 0;
+            boundPort = ntohs(bound.ss_family == AF_INET
+                              ? reinterpret_cast<sockaddr_in*>(&bound)->sin_port
+                              : reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port);
+        }
+        if (ok) {
+            worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+            worker->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            ok = worker->epollFd >= 0 && worker->wakeFd >= 0;
+        }
+        if (ok) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = worker->listenFd;
+            ok = epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->listenFd, &ev) == 0;
+            ev.data.fd = worker->wakeFd;
+            ok = ok && epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeFd, &ev) == 0;
+        }
+        if (!ok) {
+            std::cout << "  ⚠️  Could not listen on " << config.bindAddress << ":" << boundPort
+                      << " (" << std::strerror(errno) << ").\n";
+            for (int fd : {worker->listenFd, worker->epollFd, worker->wakeFd}) {
+                if (fd >= 0) close(fd);
+            }
+            for (auto& w : workers) {
+                close(w->listenFd);
+                close(w->epollFd);
+                close(w->wakeFd);
+            }
+            workers.clear();
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    running = true;
+    for (auto& worker : workers) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w] { run(*w); });
+    }
+    return true;
+}
+
+void HttpServer::stop() {
+    if (!running.exchange(false)) return;
+    for (auto& worker : workers) {
+        uint64_t one = 1;
+        ssize_t ignored = write(worker->wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+        for (auto& entry : worker->conns) close(entry.first);
+        worker->conns.clear();
+        close(worker->listenFd);
+        close(worker->epollFd);
+        close(worker->wakeFd);
+    }
+    workers.clear();
+}
+
+void HttpServer::run(Worker& worker) {
+    epoll_event events[256];
+    while (running) {
+        int n = epoll_wait(worker.epollFd, events, 256, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == worker.wakeFd) continue;   // stop(): loop re-checks `running`
+
+            if (fd == worker.listenFd) {
+                for (;;) {
+                    sockaddr_storage peer{};
+                    socklen_t len = sizeof(peer);
+                    int cfd = accept4(worker.listenFd, reinterpret_cast<sockaddr*>(&peer), &len,
+                                      SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (cfd < 0) {
+                        if (errno == EINTR || errno == ECONNABORTED) continue;
+                        break;   // EAGAIN, or out of fds until some close
+                    }
+                    int one = 1;
+                    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+                    auto conn = std::make_unique<Connection>();
+                    conn->fd = cfd;
+                    char ip[INET6_ADDRSTRLEN] = "";
+                    if (peer.ss_family == AF_INET) {
+                        inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(&peer)->sin_addr, ip, sizeof(ip));
+                    } else if (peer.ss_family == AF_INET6) {
+                        inet_ntop(AF_INET6, &reinterpret_cast<sockaddr_in6*>(&peer)->sin6_addr, ip, sizeof(ip));
+                    }
+                    conn->ip = ip;
+
+                    epoll_event ev{};
+                    ev.events = conn->events = EPOLLIN;
+                    ev.data.fd = cfd;
+                    if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, cfd, &ev) != 0) {
+                        close(cfd);
+                        continue;
+                    }
+                    worker.conns[cfd] = std::move(conn);
+                }
+                continue;
+            }
+
+            auto it = worker.conns.find(fd);
+            if (it == worker.conns.end()) continue;
+            Connection& conn = *it->second;
+            uint32_t ev = events[i].events;
+
+            if ((ev & (EPOLLERR | EPOLLHUP)) && !(ev & EPOLLIN)) {
+                closeConnection(worker, fd);
+                continue;
+            }
+            if (ev & EPOLLOUT) {
+                if (!flush(worker, conn)) continue;
+                process(conn);   // pipelined requests held back by a full output buffer
+            }
+            if (ev & EPOLLIN) onReadable(worker, conn);
+            if (worker.conns.count(fd)) flush(worker, conn);
+        }
+    }
+}
+
+void HttpServer::onReadable(Worker& worker, Connection& conn) {
+    while (!conn.closing && conn.out.size() - conn.outSent < MAX_PENDING_OUTPUT) {
+        size_t old = conn.in.size();
+        conn.in.resize(old + READ_CHUNK);
+        ssize_t n = read(conn.fd, &conn.in[old], READ_CHUNK);
+        conn.in.resize(old + (n > 0 ? (size_t)n : 0));
+        if (n > 0) {
+            process(conn);
+            continue;
+        }
+        if (n == 0) {
+            conn.closing = true;   // peer done sending; answer what was parsed, then close
+            conn.in.clear();
+            return;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) closeConnection(worker, conn.fd);
+        return;
+    }
+}
+
+// Write pending output and update the epoll interest; false if the
+// connection was closed
+bool HttpServer::flush(Worker& worker, Connection& conn) {
+    while (conn.outSent < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.outSent, conn.out.size() - conn.outSent,
+                         MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.outSent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeConnection(worker, conn.fd);
+        return false;
+    }
+    if (conn.outSent == conn.out.size()) {
+        conn.out.clear();
+        conn.outSent = 0;
+        if (conn.closing) {
+            closeConnection(worker, conn.fd);
+            return false;
+        }
+    }
+
+    size_t backlog = conn.out.size() - conn.outSent;
+    uint32_t wanted = (backlog > 0 ? EPOLLOUT : 0u)
+                    | (!conn.closing && backlog < MAX_PENDING_OUTPUT ? EPOLLIN : 0u);
+    if (wanted != conn.events) {
+        epoll_event ev{};
+        ev.events = wanted;
+        ev.data.fd = conn.fd;
+        epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.events = wanted;
+    }
+    return true;
+}
+
+void HttpServer::closeConnection(Worker& worker, int fd) {
+    epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    worker.conns.erase(fd);
+}
+
+#else
+
+bool HttpServer::start() {
+    std::cout << "  ⚠️  The native HTTP server needs Linux (epoll).\n";
+    return false;
+}
+
+void HttpServer::stop() {}
+void HttpServer::run(Worker&) {}
+void HttpServer::onReadable(Worker&, Connection&) {}
+bool HttpServer::flush(Worker&, Connection&) { return false; }
+void HttpServer::closeConnection(Worker&, int) {}
+
+#endif
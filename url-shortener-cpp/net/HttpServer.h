@@ -0,0 +1,77 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include "HttpParser.h"
+#include "../core/urlshortenerservice.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Construction-time options for the HTTP front-end
+struct HttpServerConfig {
+    std::string bindAddress = "0.0.0.0";
+    int  port = 8080;                  // 0 = pick a free port (see HttpServer::port)
+    int  threads = 0;                  // 0 = one worker per core
+    bool permanentRedirects = false;   // 301 instead of 302 (browsers then skip analytics)
+    bool rateLimit = true;             // per client IP, through the service's token buckets
+};
+
+// Native HTTP/1.1 front-end for UrlShortenerService (Linux, epoll).
+//
+// Every worker owns an SO_REUSEPORT listener and an epoll loop, so the
+// kernel spreads connections across workers and a connection never changes
+// thread. Connections are keep-alive by default and pipelined: all complete
+// requests in a read are answered in order with a single write, and the
+// redirects among up to 32 of them are resolved in one batch
+// (UrlShortenerService::redirectMany).
+//
+//   GET  /{code}                 → 302 (or 301) Location: <long URL>, 404 if unknown
+//   POST /shorten, /api/shorten  → 201 {"shortCode", "shortUrl", ...}
+//        body: JSON {"longUrl", "customAlias", "ttlSeconds"} or the bare URL
+class HttpServer {
+public:
+    explicit HttpServer(UrlShortenerService& service,
+                        const HttpServerConfig& config = HttpServerConfig());
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Bind the listeners and start the workers; false if the port can't be bound
+    bool start();
+
+    // Stop accepting, close every connection and join the workers
+    void stop();
+
+    int port() const { return boundPort; }
+    int threadCount() const { return (int)workers.size(); }
+
+private:
+    struct Connection;
+    struct Worker;
+
+    UrlShortenerService& service;
+    HttpServerConfig config;
+    int boundPort = 0;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running{false};
+
+    void run(Worker& worker);
+    void onReadable(Worker& worker, Connection& conn);
+    void process(Connection& conn);
+    bool flush(Worker& worker, Connection& conn);
+    void closeConnection(Worker& worker, int fd);
+
+    void answer(const std::vector<HttpRequest>& batch, Connection& conn);
+    void handle(const HttpRequest& req, Connection& conn);
+    // Response to GET/HEAD /{code} once process() has resolved it
+    void handleRedirect(const HttpRequest& req, Connection& conn, bool rateLimited,
+                        const UrlHandle& longUrl);
+    void handleShorten(const HttpRequest& req, Connection& conn);
+    void handleClicks(const HttpRequest& req, Connection& conn, bool headOnly);
+    void handleMetrics(const HttpRequest& req, Connection& conn, bool headOnly);
+};
+
+#endif
@@ -0,0 +1,76 @@
+// Native HTTP front-end for the URL shortener
+//   g++ -std=c++17 -O2 -pthread server_main.cpp net/*.cpp core/*.cpp -o server
+//   ./server [--port 8080] [--bind 0.0.0.0] [--threads N] [--data-dir DIR]
+//            [--cold-dir DIR] [--cache N] [--cache-policy lru|clock|tinylfu]
+//            [--dedup] [--permanent] [--no-rate-limit]
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "core/urlshortenerservice.h"
+#include "net/HttpServer.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <pthread.h>
+#endif
+
+static void usage() {
+    std::cout << "usage: server [--port N] [--bind ADDR] [--threads N] [--data-dir DIR]\n"
+                 "              [--cold-dir DIR] [--cache N] [--cache-policy lru|clock|tinylfu]\n"
+                 "              [--dedup] [--permanent] [--no-rate-limit]\n";
+}
+
+int main(int argc, char** argv) {
+    ServiceConfig serviceConfig;
+    serviceConfig.cacheCapacity = 100000;
+    HttpServerConfig serverConfig;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--port" && hasValue) serverConfig.port = std::atoi(argv[++i]);
+        else if (arg == "--bind" && hasValue) serverConfig.bindAddress = argv[++i];
+        else if (arg == "--threads" && hasValue) serverConfig.threads = std::atoi(argv[++i]);
+        else if (arg == "--data-dir" && hasValue) serviceConfig.persistence.dataDir = argv[++i];
+        else if (arg == "--cold-dir" && hasValue) serviceConfig.coldTier.dir = argv[++i];
+        else if (arg == "--cache" && hasValue) serviceConfig.cacheCapacity = std::atoi(argv[++i]);
+        else if (arg == "--cache-policy" && hasValue) {
+            std::string v = argv[++i];
+            serviceConfig.cachePolicy = v == "clock"   ? CachePolicy::CLOCK
+                                      : v == "tinylfu" ? CachePolicy::TINYLFU : CachePolicy::LRU;
+        }
+        else if (arg == "--dedup") serviceConfig.dedup = true;
+        else if (arg == "--permanent") serverConfig.permanentRedirects = true;
+        else if (arg == "--no-rate-limit") serverConfig.rateLimit = false;
+        else {
+            usage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+#ifndef _WIN32
+    // Block SIGINT/SIGTERM before any thread starts so only sigwait sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+#endif
+
+    UrlShortenerService service(serviceConfig);
+    HttpServer server(service, serverConfig);
+    if (!server.start()) return 1;
+
+    std::cout << "\n🚀 AK URL Shortener (native) on http://" << serverConfig.bindAddress
+              << ":" << server.port() << " — " << server.threadCount() << " worker(s)\n";
+    std::cout << "   Shorten   → POST /shorten   (or /api/shorten)\n";
+    std::cout << "   Redirect  → GET  /{code}\n\n";
+
+#ifndef _WIN32
+    int sig = 0;
+    sigwait(&signals, &sig);
+    std::cout << "\n  Shutting down (" << (sig == SIGINT ? "SIGINT" : "SIGTERM") << ")...\n";
+#endif
+    server.stop();
+    return 0;
+}